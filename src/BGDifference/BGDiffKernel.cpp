@@ -0,0 +1,552 @@
+/*=================================================================
+ * Fused Row Kernels of Background Difference Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#include "BGDiffKernel.h"
+
+#if BGDIFF_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// BGR 像素的定点灰度值
+// Fixed-point Gray Value of a BGR pixel
+static inline int BGDiffGray(const unsigned char *p)
+{
+    return (p[0] * BGDIFF_GRAY_B + p[1] * BGDIFF_GRAY_G + p[2] * BGDIFF_GRAY_R
+            + (1 << (BGDIFF_GRAY_SHIFT - 1))) >> BGDIFF_GRAY_SHIFT;
+}
+
+// 一个像素的灰度转换、差分与背景更新，返回 8 位差分值
+// Gray Conversion, Difference and Background Update of one pixel, returns the 8-bit difference
+template<int CN>
+static inline int BGDiffAccumulatePixelF32(const unsigned char *p, float alpha, float alpha_fg, int gate,
+                                           float *bg, unsigned char *bg8)
+{
+    float d = (float)(CN == 1 ? p[0] : BGDiffGray(p)) - *bg;
+    int ad = (int)((d < 0 ? -d : d) + 0.5f);
+    // 差分大于 gate 的前景像素使用 alpha_fg，编译为条件选择而非分支
+    // Foreground pixels whose difference is greater than gate use alpha_fg, compiled as a select instead of a branch
+    float a = ad > gate ? alpha_fg : alpha;
+    float b = *bg + a * d;
+    *bg = b;
+    *bg8 = (unsigned char)(b + 0.5f);
+    return ad;
+}
+
+// 按通道数与是否统计直方图在编译期特化的行循环
+// Row loop specialized at compile time on the channel number and on counting the histogram
+template<int CN, bool HIST>
+static void BGDiffAccumulateRowF32Impl(const unsigned char *src, int width,
+                                       float alpha, float alpha_fg, int gate,
+                                       float *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist)
+{
+    int j = 0;
+    if(HIST)
+    {
+        // 每 4 个相邻像素分别累加到 4 个子直方图
+        // Every 4 adjacent pixels count into the 4 sub-histograms respectively
+        for(; j <= width - BGDIFF_SUB_HISTS; j += BGDIFF_SUB_HISTS)
+        {
+            for(int k = 0; k < BGDIFF_SUB_HISTS; k++)
+            {
+                int d = BGDiffAccumulatePixelF32<CN>(src + (j + k) * CN, alpha, alpha_fg, gate, bg + j + k, bg8 + j + k);
+                diff[j + k] = (unsigned char)d;
+                sub_hist[k * BGDIFF_HIST_SIZE + d]++;
+            }
+        }
+    }
+    for(; j < width; j++)
+    {
+        int d = BGDiffAccumulatePixelF32<CN>(src + j * CN, alpha, alpha_fg, gate, bg + j, bg8 + j);
+        diff[j] = (unsigned char)d;
+        if(HIST)
+            sub_hist[d]++;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffAccumulateRowF32
+ * 说明：对一行像素一次完成灰度转换、差分与背景更新；
+ *    差分使用更新前的背景，与 absdiff 后再 accumulateWeighted 的结果相同；
+ *    背景以浮点保存，不经过 8 位截断，因此很小的更新速度也能收敛；
+ *    sub_hist 不为 NULL 时在同一遍历中统计差分图像的子直方图；
+ *    选择性更新：差分大于 gate 的像素视为前景，使用 alpha_fg 更新（0 表示不更新）；
+ * 参数：
+ *   const unsigned char *src:  当前行像素，灰度或 BGR 交错
+ *   int cn:  通道数，1 或 3
+ *   int width:  像素个数
+ *   float alpha:  背景像素的背景更新速度
+ *   float alpha_fg:  前景像素的背景更新速度
+ *   int gate:  前景判定阈值，255 表示不区分前景
+ *   float *bg:  浮点背景的一行，原地更新
+ *   unsigned char *diff:  输出差分图像的一行
+ *   unsigned char *bg8:  输出 8 位背景图像的一行
+ *   int *sub_hist:  差分图像的子直方图，累加，可为 NULL
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffAccumulateRowF32
+ *
+ * Summary:
+ *   Gray Conversion, Difference and Background Update of one row of pixels in a single pass.
+ *   The difference uses the background before the update, the same result as absdiff
+ * followed by accumulateWeighted. The background stays in float and is never truncated
+ * to 8 bits, so small update speeds still converge.
+ *   When sub_hist isn't NULL, the sub-histograms of the Difference Image are counted in
+ * the same pass.
+ *   Selective Update: pixels whose difference is greater than gate are taken as
+ * foreground and updated with alpha_fg (0 means no update).
+ *
+ * Arguments:
+ *   const unsigned char *src - pixels of current row, gray or interleaved BGR
+ *   int cn - number of channels, 1 or 3
+ *   int width - number of pixels
+ *   float alpha - the Speed of Background Update of background pixels
+ *   float alpha_fg - the Speed of Background Update of foreground pixels
+ *   int gate - foreground threshold, 255 means no foreground distinction
+ *   float *bg - row of the float Background, updated in place
+ *   unsigned char *diff - output row of the Difference Image
+ *   unsigned char *bg8 - output row of the 8-bit Background Image
+ *   int *sub_hist - sub-histograms of the Difference Image, accumulated, may be NULL
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffAccumulateRowF32(const unsigned char *src, int cn, int width,
+                            float alpha, float alpha_fg, int gate,
+                            float *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist)
+{
+    if(cn == 1)
+    {
+        if(sub_hist)
+            BGDiffAccumulateRowF32Impl<1, true>(src, width, alpha, alpha_fg, gate, bg, diff, bg8, sub_hist);
+        else
+            BGDiffAccumulateRowF32Impl<1, false>(src, width, alpha, alpha_fg, gate, bg, diff, bg8, sub_hist);
+    }
+    else
+    {
+        if(sub_hist)
+            BGDiffAccumulateRowF32Impl<3, true>(src, width, alpha, alpha_fg, gate, bg, diff, bg8, sub_hist);
+        else
+            BGDiffAccumulateRowF32Impl<3, false>(src, width, alpha, alpha_fg, gate, bg, diff, bg8, sub_hist);
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffAbsDiffHistRow
+ * 说明：对一行像素计算差分图像 |a - b|，并在同一遍历中统计差分图像的子直方图；
+ *    SSE2 每次计算 16 个像素的差分，之后从刚写入的差分中累加子直方图；
+ * 参数：
+ *   const unsigned char *a:  第一幅图像的一行
+ *   const unsigned char *b:  第二幅图像的一行
+ *   int width:  像素个数
+ *   unsigned char *diff:  输出差分图像的一行
+ *   int *sub_hist:  差分图像的子直方图，累加
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffAbsDiffHistRow
+ *
+ * Summary:
+ *   Compute the Difference Image |a - b| of one row of pixels, and count its
+ * sub-histograms in the same pass.
+ *   SSE2 computes the difference of 16 pixels at a time, and the sub-histograms are
+ * counted from the difference just written.
+ *
+ * Arguments:
+ *   const unsigned char *a - row of the first image
+ *   const unsigned char *b - row of the second image
+ *   int width - number of pixels
+ *   unsigned char *diff - output row of the Difference Image
+ *   int *sub_hist - sub-histograms of the Difference Image, accumulated
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffAbsDiffHistRow(const unsigned char *a, const unsigned char *b, int width,
+                          unsigned char *diff, int *sub_hist)
+{
+    int j = 0;
+
+#if BGDIFF_SIMD_SSE2
+    for(; j <= width - 16; j += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + j));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + j));
+        _mm_storeu_si128((__m128i *)(diff + j), _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)));
+        for(int k = 0; k < 16; k += 4)
+        {
+            sub_hist[diff[j + k]]++;
+            sub_hist[BGDIFF_HIST_SIZE + diff[j + k + 1]]++;
+            sub_hist[2 * BGDIFF_HIST_SIZE + diff[j + k + 2]]++;
+            sub_hist[3 * BGDIFF_HIST_SIZE + diff[j + k + 3]]++;
+        }
+    }
+#endif
+
+    for(; j < width; j++)
+    {
+        int d = a[j] > b[j] ? a[j] - b[j] : b[j] - a[j];
+        diff[j] = (unsigned char)d;
+        sub_hist[(j & 3) * BGDIFF_HIST_SIZE + d]++;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffHistRow
+ * 说明：统计一行像素的子直方图；
+ * 参数：
+ *   const unsigned char *src:  图像的一行
+ *   int width:  像素个数
+ *   int *sub_hist:  子直方图，累加
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffHistRow
+ *
+ * Summary:
+ *   Count the sub-histograms of one row of pixels.
+ *
+ * Arguments:
+ *   const unsigned char *src - row of the image
+ *   int width - number of pixels
+ *   int *sub_hist - sub-histograms, accumulated
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffHistRow(const unsigned char *src, int width, int *sub_hist)
+{
+    int j = 0;
+    for(; j <= width - 4; j += 4)
+    {
+        sub_hist[src[j]]++;
+        sub_hist[BGDIFF_HIST_SIZE + src[j + 1]]++;
+        sub_hist[2 * BGDIFF_HIST_SIZE + src[j + 2]]++;
+        sub_hist[3 * BGDIFF_HIST_SIZE + src[j + 3]]++;
+    }
+    for(; j < width; j++)
+        sub_hist[src[j]]++;
+}
+
+/*===================================================================
+ * 函数名：BGDiffMergeHist
+ * 说明：将子直方图合并为一个直方图；
+ * 参数：
+ *   const int *sub_hist:  BGDIFF_SUB_HISTS 个子直方图
+ *   int *hist:  输出 BGDIFF_HIST_SIZE 级的直方图
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffMergeHist
+ *
+ * Summary:
+ *   Merge the sub-histograms into one histogram.
+ *
+ * Arguments:
+ *   const int *sub_hist - BGDIFF_SUB_HISTS sub-histograms
+ *   int *hist - output histogram of BGDIFF_HIST_SIZE levels
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffMergeHist(const int *sub_hist, int *hist)
+{
+    for(int v = 0; v < BGDIFF_HIST_SIZE; v++)
+    {
+        int n = 0;
+        for(int k = 0; k < BGDIFF_SUB_HISTS; k++)
+            n += sub_hist[k * BGDIFF_HIST_SIZE + v];
+        hist[v] = n;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffInitRowF32
+ * 说明：对一行像素进行灰度转换，并初始化浮点背景与 8 位背景；
+ * 参数：
+ *   const unsigned char *src:  当前行像素，灰度或 BGR 交错
+ *   int cn:  通道数，1 或 3
+ *   int width:  像素个数
+ *   float *bg:  输出浮点背景的一行
+ *   unsigned char *bg8:  输出 8 位背景图像的一行
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffInitRowF32
+ *
+ * Summary:
+ *   Gray Conversion of one row of pixels, and init the float Background and the 8-bit Background.
+ *
+ * Arguments:
+ *   const unsigned char *src - pixels of current row, gray or interleaved BGR
+ *   int cn - number of channels, 1 or 3
+ *   int width - number of pixels
+ *   float *bg - output row of the float Background
+ *   unsigned char *bg8 - output row of the 8-bit Background Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffInitRowF32(const unsigned char *src, int cn, int width, float *bg, unsigned char *bg8)
+{
+    for(int j = 0; j < width; j++, src += cn)
+    {
+        int g = cn == 1 ? src[0] : BGDiffGray(src);
+        bg[j] = (float)g;
+        bg8[j] = (unsigned char)g;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffAccumulateRowQ8Scalar
+ * 说明：对一行灰度像素完成与 Q8.8 定点背景的差分以及背景更新（标量版本）；
+ *    差分使用更新前的背景；更新量按 alpha_q / 65536 向上取整，只要 pos（neg）与 alpha_q 不为 0
+ *    背景就会移动，因此没有停滞区，背景最终等于 gray * 256；alpha_q <= 65535 时更新量不超过 pos（neg），不会越过当前帧；
+ *    选择性更新：差分大于 gate 的像素视为前景，使用 alpha_fg_q 更新（0 表示不更新）；
+ * 参数：
+ *   const unsigned char *gray:  当前行灰度像素
+ *   int width:  像素个数
+ *   unsigned short alpha_q:  背景像素的背景更新速度，alpha * 65536
+ *   unsigned short alpha_fg_q:  前景像素的背景更新速度，alpha_fg * 65536
+ *   int gate:  前景判定阈值，255 表示不区分前景
+ *   unsigned short *bg:  Q8.8 定点背景的一行，原地更新
+ *   unsigned char *diff:  输出差分图像的一行
+ *   unsigned char *bg8:  输出 8 位背景图像的一行
+ *   int *sub_hist:  差分图像的子直方图，累加，可为 NULL
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffAccumulateRowQ8Scalar
+ *
+ * Summary:
+ *   Difference against the Q8.8 fixed-point Background and the Background Update of one
+ * row of gray pixels (Scalar Version).
+ *   The difference uses the background before the update. The update step is rounded up
+ * at alpha_q / 65536, so the background moves whenever pos (neg) and alpha_q are non-zero:
+ * there is no dead zone and the background finally settles on gray * 256. With alpha_q <= 65535
+ * the step is not larger than pos (neg), so it never overshoots the frame.
+ *   Selective Update: pixels whose difference is greater than gate are taken as
+ * foreground and updated with alpha_fg_q (0 means no update).
+ *
+ * Arguments:
+ *   const unsigned char *gray - gray pixels of current row
+ *   int width - number of pixels
+ *   unsigned short alpha_q - the Speed of Background Update of background pixels, alpha * 65536
+ *   unsigned short alpha_fg_q - the Speed of Background Update of foreground pixels, alpha_fg * 65536
+ *   int gate - foreground threshold, 255 means no foreground distinction
+ *   unsigned short *bg - row of the Q8.8 fixed-point Background, updated in place
+ *   unsigned char *diff - output row of the Difference Image
+ *   unsigned char *bg8 - output row of the 8-bit Background Image
+ *   int *sub_hist - sub-histograms of the Difference Image, accumulated, may be NULL
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffAccumulateRowQ8Scalar(const unsigned char *gray, int width, unsigned short alpha_q,
+                                 unsigned short alpha_fg_q, int gate,
+                                 unsigned short *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist)
+{
+    const unsigned ceil_add = (1u << BGDIFF_ALPHA_SHIFT) - 1;
+    for(int j = 0; j < width; j++)
+    {
+        unsigned g = (unsigned)gray[j] << BGDIFF_Q8_SHIFT;
+        unsigned b = bg[j];
+        unsigned pos = g > b ? g - b : 0;
+        unsigned neg = b > g ? b - g : 0;
+        unsigned d = (pos + neg + (1u << (BGDIFF_Q8_SHIFT - 1))) >> BGDIFF_Q8_SHIFT;
+        unsigned a = (int)d > gate ? alpha_fg_q : alpha_q;
+        b = b + ((pos * a + ceil_add) >> BGDIFF_ALPHA_SHIFT) - ((neg * a + ceil_add) >> BGDIFF_ALPHA_SHIFT);
+        bg[j] = (unsigned short)b;
+        bg8[j] = (unsigned char)((b + (1u << (BGDIFF_Q8_SHIFT - 1))) >> BGDIFF_Q8_SHIFT);
+        diff[j] = (unsigned char)d;
+        if(sub_hist)
+            sub_hist[(j & 3) * BGDIFF_HIST_SIZE + d]++;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffAccumulateRowQ8
+ * 说明：向量化完成一行灰度像素与 Q8.8 定点背景的差分以及背景更新；
+ *    SSE2 每次处理 16 个像素（两组 8 个 16 位通道），剩余像素使用标量版本；
+ *    pos 与 neg 由饱和减法得到，其中至多一个不为 0，因此背景更新无分支；
+ *    每个像素的更新速度由刚计算的差分与 gate 比较得到的掩码选择，同样无分支；
+ *    ceil(x * alpha_q / 65536) 为乘法高 16 位，低 16 位不为 0 时再加 1（mulhi + 1 + (mullo == 0 ? -1 : 0)），
+ *    与标量版本逐位一致；
+ *    8 位背景与差分在同一遍历中压缩输出，直方图从刚写入的差分中累加；
+ * 参数：
+ *   参数与 BGDiffAccumulateRowQ8Scalar 相同
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffAccumulateRowQ8
+ *
+ * Summary:
+ *   Difference against the Q8.8 fixed-point Background and the Background Update of one
+ * row of gray pixels with SIMD instructions.
+ *   SSE2 handles 16 pixels (two groups of 8 16-bit lanes) at a time, the remaining
+ * pixels are handled by the scalar version.
+ *   pos and neg come from saturated subtractions and at most one of them is non-zero,
+ * so the update has no branches. The update speed of every pixel is selected by the mask
+ * of its just-computed difference against gate, also without branches.
+ *   ceil(x * alpha_q / 65536) is the high half of the product, plus 1 when its low half is
+ * non-zero (mulhi + 1 + (mullo == 0 ? -1 : 0)), bit-exact with the scalar version.
+ *   The 8-bit background and the difference are packed in the same pass, and the
+ * histogram is counted from the difference just written.
+ *
+ * Arguments:
+ *   the same as BGDiffAccumulateRowQ8Scalar
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+#if BGDIFF_SIMD_SSE2
+// 8 个 16 位通道的差分与背景更新，输出 16 位的差分与 8 位背景；
+// 每个通道的更新速度由差分与 gate 的比较结果无分支地选择
+// Difference and Background Update of 8 16-bit lanes, output the 16-bit difference and 8-bit background.
+// The update speed of every lane is selected without branches by comparing its difference with gate.
+static inline void BGDiffAccumulateQ8x8(__m128i g, __m128i &b, __m128i alpha_bg, __m128i alpha_fg, __m128i gate,
+                                        __m128i &d, __m128i &b8)
+{
+    const __m128i half = _mm_set1_epi16(1 << (BGDIFF_Q8_SHIFT - 1));
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pos = _mm_subs_epu16(g, b);
+    __m128i neg = _mm_subs_epu16(b, g);
+    d = _mm_srli_epi16(_mm_adds_epu16(_mm_or_si128(pos, neg), half), BGDIFF_Q8_SHIFT);
+    __m128i fg = _mm_cmpgt_epi16(d, gate);
+    __m128i alpha = _mm_or_si128(_mm_and_si128(fg, alpha_fg), _mm_andnot_si128(fg, alpha_bg));
+    __m128i up = _mm_add_epi16(_mm_add_epi16(_mm_mulhi_epu16(pos, alpha), one),
+                               _mm_cmpeq_epi16(_mm_mullo_epi16(pos, alpha), zero));
+    __m128i dn = _mm_add_epi16(_mm_add_epi16(_mm_mulhi_epu16(neg, alpha), one),
+                               _mm_cmpeq_epi16(_mm_mullo_epi16(neg, alpha), zero));
+    b = _mm_sub_epi16(_mm_add_epi16(b, up), dn);
+    b8 = _mm_srli_epi16(_mm_adds_epu16(b, half), BGDIFF_Q8_SHIFT);
+}
+#endif
+
+void BGDiffAccumulateRowQ8(const unsigned char *gray, int width, unsigned short alpha_q,
+                           unsigned short alpha_fg_q, int gate,
+                           unsigned short *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist)
+{
+    int j = 0;
+
+#if BGDIFF_SIMD_SSE2
+    const __m128i alpha = _mm_set1_epi16((short)alpha_q);
+    const __m128i alpha_fg = _mm_set1_epi16((short)alpha_fg_q);
+    const __m128i vgate = _mm_set1_epi16((short)gate);
+    const __m128i zero = _mm_setzero_si128();
+    for(; j <= width - 16; j += 16)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(gray + j));
+        __m128i g0 = _mm_slli_epi16(_mm_unpacklo_epi8(p, zero), BGDIFF_Q8_SHIFT);
+        __m128i g1 = _mm_slli_epi16(_mm_unpackhi_epi8(p, zero), BGDIFF_Q8_SHIFT);
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(bg + j));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(bg + j + 8));
+        __m128i d0, d1, o0, o1;
+        BGDiffAccumulateQ8x8(g0, b0, alpha, alpha_fg, vgate, d0, o0);
+        BGDiffAccumulateQ8x8(g1, b1, alpha, alpha_fg, vgate, d1, o1);
+        _mm_storeu_si128((__m128i *)(bg + j), b0);
+        _mm_storeu_si128((__m128i *)(bg + j + 8), b1);
+        _mm_storeu_si128((__m128i *)(diff + j), _mm_packus_epi16(d0, d1));
+        _mm_storeu_si128((__m128i *)(bg8 + j), _mm_packus_epi16(o0, o1));
+        if(sub_hist)
+        {
+            for(int k = 0; k < 16; k += 4)
+            {
+                sub_hist[diff[j + k]]++;
+                sub_hist[BGDIFF_HIST_SIZE + diff[j + k + 1]]++;
+                sub_hist[2 * BGDIFF_HIST_SIZE + diff[j + k + 2]]++;
+                sub_hist[3 * BGDIFF_HIST_SIZE + diff[j + k + 3]]++;
+            }
+        }
+    }
+#endif
+
+    BGDiffAccumulateRowQ8Scalar(gray + j, width - j, alpha_q, alpha_fg_q, gate, bg + j, diff + j, bg8 + j, sub_hist);
+}
+
+/*===================================================================
+ * 函数名：BGDiffInitRowQ8
+ * 说明：对一行像素进行灰度转换，并初始化 Q8.8 定点背景与 8 位背景；
+ * 参数：
+ *   const unsigned char *src:  当前行像素，灰度或 BGR 交错
+ *   int cn:  通道数，1 或 3
+ *   int width:  像素个数
+ *   unsigned short *bg:  输出 Q8.8 定点背景的一行
+ *   unsigned char *bg8:  输出 8 位背景图像的一行
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffInitRowQ8
+ *
+ * Summary:
+ *   Gray Conversion of one row of pixels, and init the Q8.8 fixed-point Background and
+ * the 8-bit Background.
+ *
+ * Arguments:
+ *   const unsigned char *src - pixels of current row, gray or interleaved BGR
+ *   int cn - number of channels, 1 or 3
+ *   int width - number of pixels
+ *   unsigned short *bg - output row of the Q8.8 fixed-point Background
+ *   unsigned char *bg8 - output row of the 8-bit Background Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffInitRowQ8(const unsigned char *src, int cn, int width, unsigned short *bg, unsigned char *bg8)
+{
+    for(int j = 0; j < width; j++, src += cn)
+    {
+        int g = cn == 1 ? src[0] : BGDiffGray(src);
+        bg[j] = (unsigned short)(g << BGDIFF_Q8_SHIFT);
+        bg8[j] = (unsigned char)g;
+    }
+}
+
+/*===================================================================
+ * 函数名：BGDiffGrayRow
+ * 说明：一行 BGR 像素的灰度转换，与 OpenCV 的 CV_BGR2GRAY 相同；
+ * 参数：
+ *   const unsigned char *bgr:  当前行 BGR 交错像素
+ *   int width:  像素个数
+ *   unsigned char *gray:  输出灰度像素
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BGDiffGrayRow
+ *
+ * Summary:
+ *   Gray Conversion of one row of BGR pixels, the same as OpenCV's CV_BGR2GRAY.
+ *
+ * Arguments:
+ *   const unsigned char *bgr - interleaved BGR pixels of current row
+ *   int width - number of pixels
+ *   unsigned char *gray - output gray pixels
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffGrayRow(const unsigned char *bgr, int width, unsigned char *gray)
+{
+    for(int j = 0; j < width; j++, bgr += 3)
+        gray[j] = (unsigned char)BGDiffGray(bgr);
+}
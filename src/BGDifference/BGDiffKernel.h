@@ -0,0 +1,138 @@
+/*=================================================================
+ * Fused Row Kernels of Background Difference Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#ifndef BGDIFFKERNEL_H
+#define BGDIFFKERNEL_H
+
+#include <cstddef>
+
+// 向量化指令集选择：SSE2 每次处理 16 个像素，否则使用标量代码
+// SIMD Instruction Set: SSE2 handles 16 pixels per instruction, otherwise the scalar code is used.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BGDIFF_SIMD_SSE2 1
+#endif
+
+// 直方图的灰度级个数
+// Number of Gray Levels of a Histogram
+#define BGDIFF_HIST_SIZE   256
+
+// 子直方图个数，相邻像素累加到不同的子直方图，避免相同灰度连续累加时的存储转发停顿；核函数按 4 展开
+// Number of Sub-histograms. Adjacent pixels count into different sub-histograms, which
+// avoids store-forwarding stalls on runs of the same gray level. The kernels are unrolled for 4.
+#define BGDIFF_SUB_HISTS   4
+
+// BGR 转灰度的定点系数（与 OpenCV 的 CV_BGR2GRAY 相同，14 位小数）
+// Fixed-point Coefficients of BGR to Gray (the same as OpenCV's CV_BGR2GRAY, 14 fraction bits)
+#define BGDIFF_GRAY_SHIFT  14
+#define BGDIFF_GRAY_B      1868
+#define BGDIFF_GRAY_G      9617
+#define BGDIFF_GRAY_R      4899
+
+// 子直方图的存储：BGDIFF_SUB_HISTS 个连续的 BGDIFF_HIST_SIZE 级直方图，第 j 个像素累加到第 j % BGDIFF_SUB_HISTS 个
+// Layout of the Sub-histograms: BGDIFF_SUB_HISTS consecutive histograms of BGDIFF_HIST_SIZE levels,
+// pixel j counts into sub-histogram j % BGDIFF_SUB_HISTS.
+
+// 对一行像素一次完成灰度转换、与浮点背景的差分以及背景滑动平均更新：
+//     gray = cn == 3 ? BGR2GRAY(src) : src
+//     diff = round(|gray - bg|)
+//     a    = diff > gate ? alpha_fg : alpha
+//     bg   = bg + a * (gray - bg)
+//     bg8  = round(bg)
+//     sub_hist 不为 NULL 时同时统计 diff 的子直方图
+// Gray Conversion, Difference against the float Background and the Background Running
+// Average of one row of pixels in a single pass:
+//     gray = cn == 3 ? BGR2GRAY(src) : src
+//     diff = round(|gray - bg|)
+//     a    = diff > gate ? alpha_fg : alpha
+//     bg   = bg + a * (gray - bg)
+//     bg8  = round(bg)
+//     the sub-histograms of diff are counted as well when sub_hist isn't NULL
+void BGDiffAccumulateRowF32(const unsigned char *src, int cn, int width,
+                            float alpha, float alpha_fg, int gate,
+                            float *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist);
+
+// 对一行像素计算 diff = |a - b|，并统计 diff 的子直方图
+// Compute diff = |a - b| of one row of pixels, and count the sub-histograms of diff
+void BGDiffAbsDiffHistRow(const unsigned char *a, const unsigned char *b, int width,
+                          unsigned char *diff, int *sub_hist);
+
+// 统计一行像素的子直方图
+// Count the sub-histograms of one row of pixels
+void BGDiffHistRow(const unsigned char *src, int width, int *sub_hist);
+
+// 将 BGDIFF_SUB_HISTS 个子直方图合并为一个 BGDIFF_HIST_SIZE 级的直方图
+// Merge BGDIFF_SUB_HISTS sub-histograms into one histogram of BGDIFF_HIST_SIZE levels
+void BGDiffMergeHist(const int *sub_hist, int *hist);
+
+// 对一行像素进行灰度转换，并初始化浮点背景与 8 位背景
+// Gray Conversion of one row of pixels, and init the float Background and the 8-bit Background
+void BGDiffInitRowF32(const unsigned char *src, int cn, int width, float *bg, unsigned char *bg8);
+
+// Q8.8 定点背景的小数位数
+// Fraction Bits of the Q8.8 fixed-point Background
+#define BGDIFF_Q8_SHIFT    8
+
+// Q8.8 定点背景更新速度的小数位数，alpha_q = round(alpha * 65536)
+// Fraction Bits of the Update Speed of the Q8.8 Background, alpha_q = round(alpha * 65536)
+#define BGDIFF_ALPHA_SHIFT 16
+
+// 对一行灰度像素一次完成与 Q8.8 定点背景的差分以及背景滑动平均更新，全部为 16 位整数运算：
+//     pos  = max(gray * 256 - bg, 0),  neg = max(bg - gray * 256, 0)
+//     diff = (pos + neg + 128) >> 8
+//     a    = diff > gate ? alpha_fg_q : alpha_q
+//     bg   = bg + ceil(pos * a / 65536) - ceil(neg * a / 65536)
+//     bg8  = (bg + 128) >> 8
+//     sub_hist 不为 NULL 时同时统计 diff 的子直方图
+//   更新量向上取整：只要 a > 0 背景就向当前帧移动，没有停滞区，背景最终等于 gray * 256；
+//   a <= 65535 时更新量不超过 pos（neg），不会越过当前帧；
+//   a = 0 时背景不更新；最小的非零 a 为 1，即更新速度 1 / 65536
+// Difference against the Q8.8 fixed-point Background and the Background Running Average
+// of one row of gray pixels in a single pass, all in 16-bit integer arithmetic:
+//     pos  = max(gray * 256 - bg, 0),  neg = max(bg - gray * 256, 0)
+//     diff = (pos + neg + 128) >> 8
+//     a    = diff > gate ? alpha_fg_q : alpha_q
+//     bg   = bg + ceil(pos * a / 65536) - ceil(neg * a / 65536)
+//     bg8  = (bg + 128) >> 8
+//     the sub-histograms of diff are counted as well when sub_hist isn't NULL
+//   The step is rounded up, so the background moves toward the frame whenever a > 0, with
+// no dead zone, and finally settles on gray * 256 exactly. With a <= 65535 the step is not
+// larger than pos (neg), so it never overshoots the frame.
+//   a = 0 leaves the background unchanged; the smallest non-zero a is 1, i.e. an update speed of 1 / 65536.
+void BGDiffAccumulateRowQ8(const unsigned char *gray, int width, unsigned short alpha_q,
+                           unsigned short alpha_fg_q, int gate,
+                           unsigned short *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist);
+
+// 标量版本，与向量化版本输出逐位一致
+// Scalar Version, its output is bit-exact with the vectorized version.
+void BGDiffAccumulateRowQ8Scalar(const unsigned char *gray, int width, unsigned short alpha_q,
+                                 unsigned short alpha_fg_q, int gate,
+                           unsigned short *bg, unsigned char *diff, unsigned char *bg8, int *sub_hist);
+
+// 对一行像素进行灰度转换，并初始化 Q8.8 定点背景与 8 位背景
+// Gray Conversion of one row of pixels, and init the Q8.8 fixed-point Background and the 8-bit Background
+void BGDiffInitRowQ8(const unsigned char *src, int cn, int width, unsigned short *bg, unsigned char *bg8);
+
+// 一行 BGR 像素的灰度转换
+// Gray Conversion of one row of BGR pixels
+void BGDiffGrayRow(const unsigned char *bgr, int width, unsigned char *gray);
+
+#endif // BGDIFFKERNEL_H
@@ -64,20 +64,14 @@ void BGDiff::BackgroundDiff(Mat src, Mat &imgForeground, Mat& imgBackground, int
     // Gray Image(float) of Source Image, and will be used to model background
     Mat src_grayf;
 
-    // 前景、背景的浮点图像
-    // Gray Image(float) of Foreground & Background Images
-    Mat imgForegroundf, imgBackgroundf;
+    // 背景的浮点图像
+    // Gray Image(float) of Background Image
+    Mat imgBackgroundf;
 
     // 前景图像缓存
     // temp Image of ForeGround Image
     Mat imgForeground_temp;
 
-    // 初始化浮点图像
-    // Init float Images
-    imgBackgroundf.create(src.size(), CV_32FC1);
-    imgForegroundf.create(src.size(), CV_32FC1);
-    src_grayf.create(src.size(), CV_32FC1);
-
     // 视频流第一帧，前景与背景都初始化为第一帧的灰度图
     // if it is in the first frame of Video stream, Foreground & Background Image will be inited as Gray Image of First Frame
     if(nFrmNum == 1)
@@ -89,53 +83,32 @@ void BGDiff::BackgroundDiff(Mat src, Mat &imgForeground, Mat& imgBackground, int
         // Gray Image of First Frame init as Foreground & Background Image
         cvtColor(src, imgBackground, CV_BGR2GRAY);
         cvtColor(src, imgForeground, CV_BGR2GRAY);
-        imgBackground.convertTo(imgBackgroundf, CV_32FC1);
-        imgForeground.convertTo(imgForegroundf, CV_32FC1);
     }
     // 视频流其余帧，根据当前帧图像更新前景与背景图像
     // if it's not the First Frame of Video stream, it will update Fore & Back ground According to Current Frame Image
     else
     {
-        // 获得当前帧图像灰度图，并转换为浮点数格式
-        // get Gray Image of Source Image and Convert it to float Format.
+        // 获得当前帧图像灰度图
+        // get Gray Image of Source Image
         cvtColor(src, src_gray, CV_BGR2GRAY);
-        src_gray.convertTo(src_grayf, CV_32FC1);
-
-        // 获得背景图像灰度图，并转换为浮点数格式
-        // get Gray Image of Background Image and Convert it to float Format.
-        imgBackground.convertTo(imgBackgroundf, CV_32FC1);
 
-        // 当前帧跟背景图相减
-        // get Gray Image of Foreground. Formula is:
-        //     Foreground = Source - Background
-        absdiff(src_grayf, imgBackgroundf, imgForegroundf);
+        // 当前帧跟背景图相减，同时统计差分图像的直方图，两种OTSU方法共用
+        // get Gray Image of Foreground and its histogram in one pass, shared by both OTSU methods. Formula is:
+        //     Foreground = |Source - Background|
+        int sub_hist[BGDIFF_SUB_HISTS * BGDIFF_HIST_SIZE];
+        memset(sub_hist, 0, sizeof(sub_hist));
+        imgForeground_temp.create(src.size(), CV_8UC1);
+        for(int i = 0; i < src.rows; i++)
+            BGDiffAbsDiffHistRow(src_gray.ptr<uchar>(i), imgBackground.ptr<uchar>(i), src.cols,
+                                 imgForeground_temp.ptr<uchar>(i), sub_hist);
 
-        // 复制前景图像
-        // Copy Foreground Image
-        imgForegroundf.convertTo(imgForeground_temp, CV_32FC1);
+        int hist[BGDIFF_HIST_SIZE];
+        BGDiffMergeHist(sub_hist, hist);
 
-        // 使用OpenCV自带的OTSU方法
-        // Using OpenCV's OTSU method
-        if(threshold_method == CV_THRESH_OTSU)
-        {
-            // 浮点转化为整点
-            // Convert Foreground Image's Format from float to uchar
-            imgForeground_temp.convertTo(imgForeground_temp, CV_8UC1);
-            // 对比自适应阈值化
-            threshold(imgForeground_temp, imgForeground, 0, 255, CV_THRESH_OTSU);
-        }
-        // 使用该类中的OTSU方法
-        // Using this class's OTSU method
-        else
-        {
-            // 二值化前景图
-            int threshold_otsu = 0;
-            Otsu(imgForeground_temp, threshold_otsu);
-            // 浮点转化为整点
-            // Convert Foreground Image's Format from float to uchar
-            imgForeground_temp.convertTo(imgForeground_temp, CV_8UC1);
-            threshold(imgForeground_temp, imgForeground, threshold_otsu, 255, CV_THRESH_BINARY);
-        }
+        // CV_THRESH_OTSU: OpenCV自带OTSU方法的阈值; CV_THRESH_BINARY: 该类中的OTSU方法，阈值不小于 OTSU_MIN_THRESHOLD
+        // CV_THRESH_OTSU: threshold of OpenCV's OTSU method; CV_THRESH_BINARY: this class's OTSU method, at least OTSU_MIN_THRESHOLD
+        int threshold_otsu = OtsuHist(hist, threshold_method);
+        threshold(imgForeground_temp, imgForeground, threshold_otsu, 255, CV_THRESH_BINARY);
 
         /*===================================================================
          * 说明：
@@ -170,6 +143,8 @@ void BGDiff::BackgroundDiff(Mat src, Mat &imgForeground, Mat& imgBackground, int
          *      All of Input Images must be float format, because there will be decimal number during the process of calculating.
         =====================================================================
         */
+        src_gray.convertTo(src_grayf, CV_32FC1);
+        imgBackground.convertTo(imgBackgroundf, CV_32FC1);
         accumulateWeighted(src_grayf, imgBackgroundf, updateSpeed);
 
         // 浮点转化为整点
@@ -204,10 +179,6 @@ void BGDiff::BackgroundDiff(Mat src, Mat &imgForeground, Mat& imgBackground, int
 
 void BGDiff::Otsu(Mat src, int& thresholdValue, bool ToShowValue)
 {
-    // 输入图像是否为灰度图的标志位
-    // the Flag Bit of source image is gray image or not
-    uchar grayflag =1;
-
     // 原图像的灰度图
     // Gray Image of Source Image
     Mat gray;
@@ -215,69 +186,84 @@ void BGDiff::Otsu(Mat src, int& thresholdValue, bool ToShowValue)
     // 检查源图像是否为灰度图像
     // Check Source image that is Gray image or not
     if(src.channels()  != 1)
-    {
-        gray.create(src.size(), CV_8UC1);
         cvtColor(src, gray, CV_BGR2GRAY);
-        grayflag = 0;
-    }
     else
         gray = src;
 
+    //*************
+    // 生成直方图
+    //*************
+    int sub_hist[BGDIFF_SUB_HISTS * BGDIFF_HIST_SIZE];
+    memset(sub_hist, 0, sizeof(sub_hist));
+    for(int j = 0; j < gray.rows; j++)
+        BGDiffHistRow(gray.ptr<uchar>(j), gray.cols, sub_hist);
+
+    int ihist[BGDIFF_HIST_SIZE];
+    BGDiffMergeHist(sub_hist, ihist);
+
+    thresholdValue = OtsuHist(ihist, CV_THRESH_BINARY, ToShowValue);
+}
+
+/*===================================================================
+ * 函数名：OtsuHist
+ * 说明：由直方图计算大津法阈值；
+ *    统计全部 256 个灰度级，灰度值大于阈值的像素为前景；
+ * 参数：
+ *   const int *hist:  256 级直方图
+ *   int threshold_method: 阈值方法
+ *      - CV_THRESH_OTSU:       与OpenCV自带OTUS方法相同，不限制阈值
+ *      - CV_THRESH_BINARY:   该类中的OTSU方法，阈值不小于 OTSU_MIN_THRESHOLD
+ *   bool ToShowValue: 是否在终端输出计算得到的阈值
+ * 返回值：int，阈值
+ *------------------------------------------------------------------
+ * Function: OtsuHist
+ *
+ * Summary:
+ *   OTSU Algorithm on a histogram.
+ *   All 256 gray levels are counted, pixels greater than the threshold are foreground.
+ *
+ * Arguments:
+ *   const int *hist - 256-level histogram
+ *   int threshold_method - the method of getting Threshold Value
+ *      - CV_THRESH_OTSU:       the same as OpenCV's OTSU method, the threshold isn't limited
+ *      - CV_THRESH_BINARY:   this class's OTSU method, the threshold is at least OTSU_MIN_THRESHOLD
+ *   bool ToShowValue - if output threshold value result on terminal or not
+ *
+ * Returns:
+ *   int - threshold value
+=====================================================================
+*/
+int BGDiff::OtsuHist(const int *hist, int threshold_method, bool ToShowValue)
+{
     // 阈值缓存变量
     // threshold Temp Value
     int thresholdValue_temp = 1;
 
-    // 图像直方图,256个点
-    // the Histogram of Image (including 256 points)
-    int ihist[256];
-
-    // 对直方图置零
-    // set all points of histogram as 0
-    memset(ihist, 0, sizeof(ihist));
-
-    // n: 非零像素个数, n1: 前景像素个数, n2: 背景像素个数
-    // n - number of pixels whose value isn't equal to 0
-    // n1 - number of Foreground's pixels
-    // n2 - number of Background's pixels
+    // n: 像素个数, n1: 背景像素个数, n2: 前景像素个数
+    // n - number of pixels
+    // n1 - number of Background's pixels
+    // n2 - number of Foreground's pixels
     int n, n1, n2;
 
-    // m1: 前景灰度均值, m2: 背景灰度均值
-    // m1 - the Average of Foreground Pixels' sum
-    // m2 - the Average of Background Pixels' sum
+    // m1: 背景灰度均值, m2: 前景灰度均值
+    // m1 - the Average of Background Pixels' sum
+    // m2 - the Average of Foreground Pixels' sum
     double m1, m2;
 
-
     double sum, csum, fmax, sb;
 
-    //*************
-    // 生成直方图
-    //*************
-    int nr = src.rows;
-    int nc = src.cols * src.channels();
-
-    for(int j = 0; j < nr; j++)
-    {
-        uchar* ImgData = src.ptr<uchar>(j);
-
-        for(int i = 0; i < nc; i++)
-        {
-            //灰度统计 '&255'防止指针溢出
-            ihist[( (int)(ImgData[i]) ) & 255]++;
-        }
-    }
-
     // set up everything
     sum = csum = 0.0;
     n = 0;
-    for(int i = 0; i < 255; i++)
+    for(int i = 0; i < BGDIFF_HIST_SIZE; i++)
     {
         // x*f(x)质量矩
-        sum += (double)i * (double)ihist[i];
+        sum += (double)i * (double)hist[i];
         // f(x)质量 像素总数
-        n += ihist[i];
+        n += hist[i];
     }
 
-    // n为0，即图像全黑，输出警告
+    // n为0，即图像为空，输出警告
     if (!n)
     {
         fprintf (stderr, "NOT NORMAL thresholdValue=160\n");
@@ -286,13 +272,13 @@ void BGDiff::Otsu(Mat src, int& thresholdValue, bool ToShowValue)
     // OTSU算法
     fmax = -1.0;
     n1 = 0;
-    for (int i = 0; i < 255; i++)
+    for (int i = 0; i < BGDIFF_HIST_SIZE; i++)
     {
-        n1 += ihist[i];
+        n1 += hist[i];
         if (n1 == 0) {continue;}
         n2 = n - n1;
         if (n2 == 0) {break;}
-        csum += (double)i * ihist[i];
+        csum += (double)i * hist[i];
         m1 = csum / n1;
         m2 = (sum - csum) / n2;
 
@@ -311,10 +297,9 @@ void BGDiff::Otsu(Mat src, int& thresholdValue, bool ToShowValue)
 
     // 设定阈值最小值
     // set Minimum of threshold value
-    if(thresholdValue_temp < 20)
-        thresholdValue = 20;
-    else
-        thresholdValue = thresholdValue_temp;
+    int thresholdValue = thresholdValue_temp;
+    if(threshold_method != CV_THRESH_OTSU && thresholdValue < OTSU_MIN_THRESHOLD)
+        thresholdValue = OTSU_MIN_THRESHOLD;
 
     // 是否显示计算得到的阈值
     // Show the threshold value or not
@@ -322,4 +307,550 @@ void BGDiff::Otsu(Mat src, int& thresholdValue, bool ToShowValue)
     {
         cout << "OTSU thresholdValue = " << thresholdValue_temp<<", Returned thresholdValue = " << thresholdValue<<'\n'<<endl;
     }
+
+    return thresholdValue;
+}
+
+/*===================================================================
+ * 构造函数：BGDiffStream
+ * 说明：设置阈值方法与背景更新速度，背景在第一帧时初始化；
+ * 参数：
+ *   int threshold_method: 阈值方法
+ *      - CV_THRESH_OTSU:       使用OpenCV自带OTUS方法
+ *      - CV_THRESH_BINARY:   使用该类中的OTSU方法
+ *   double updateSpeed: 背景更新速度
+ *------------------------------------------------------------------
+ * Constructed Function: BGDiffStream
+ *
+ * Summary:
+ *   Set the method of getting Threshold Value and the Speed of Background Update,
+ * the background is inited on the first frame.
+ *
+ * Arguments:
+ *   int threshold_method - the method of getting Threshold Value
+ *      - CV_THRESH_OTSU:       Using OpenCV's OTSU method
+ *      - CV_THRESH_BINARY:   Using this class's OTSU method
+ *   double updateSpeed - the Speed of Background Update
+=====================================================================
+*/
+BGDiffStream::BGDiffStream(int threshold_method, double updateSpeed)
+{
+    setThresholdMethod(threshold_method);
+    this->updateSpeed = updateSpeed;
+    bg_mode = BGDIFF_BG_FLOAT;
+    selective = false;
+    fgSpeed = 0;
+    last_threshold = 255;
+}
+
+/*===================================================================
+ * 函数名：init
+ * 说明：用一帧图像的灰度图初始化浮点或 Q8.8 定点背景，以及 8 位背景；
+ * 参数：
+ *   Mat src:  源图像，灰度或 BGR
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: init
+ *
+ * Summary:
+ *   Init the float or Q8.8 fixed-point Background, and the 8-bit Background, with the
+ * Gray Image of a frame.
+ *
+ * Arguments:
+ *   Mat src - source image, gray or BGR
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::init(Mat src)
+{
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+
+    imgBackground8.create(src.size(), CV_8UC1);
+    imgDiff.create(src.size(), CV_8UC1);
+    imgDiff = Scalar::all(0);
+    last_threshold = 255;
+
+    if(bg_mode == BGDIFF_BG_Q8_8)
+    {
+        imgBackgroundf.release();
+        imgBackgroundq.create(src.size(), CV_16UC1);
+        gray_row.create(1, src.cols, CV_8UC1);
+        for(int i = 0; i < src.rows; i++)
+            BGDiffInitRowQ8(src.ptr<uchar>(i), src.channels(), src.cols,
+                            imgBackgroundq.ptr<ushort>(i), imgBackground8.ptr<uchar>(i));
+    }
+    else
+    {
+        imgBackgroundq.release();
+        imgBackgroundf.create(src.size(), CV_32FC1);
+        for(int i = 0; i < src.rows; i++)
+            BGDiffInitRowF32(src.ptr<uchar>(i), src.channels(), src.cols,
+                             imgBackgroundf.ptr<float>(i), imgBackground8.ptr<uchar>(i));
+    }
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：流式背景差分算法；
+ *    逐行一次遍历完成灰度转换、与浮点或定点背景的差分以及背景滑动平均更新，
+ *    之后对差分图像阈值化得到前景；
+ *    所有图像缓冲区在初始化时分配，图像尺寸不变时每帧不再分配内存；
+ *    imgBackground 与该对象共享 8 位背景的数据，下一帧会被覆盖；
+ * 参数：
+ *   Mat src:  源图像，灰度或 BGR
+ *   Mat& imgForeground: 前景图像
+ *   Mat& imgBackground: 背景图像
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Streaming Background Difference Algorithm.
+ *   Gray Conversion, Difference against the float or fixed-point background and the
+ * Background Running Average are done row by row in one pass, then the Difference Image
+ * is thresholded into the foreground.
+ *   All image buffers are allocated on init, nothing is allocated per frame while the
+ * image size stays the same. imgBackground shares the data of the 8-bit background with
+ * this object and is overwritten by the next frame.
+ *
+ * Arguments:
+ *   Mat src - source image, gray or BGR
+ *   Mat& imgForeground - Foreground Image
+ *   Mat& imgBackground - Background Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::process(Mat src, Mat &imgForeground, Mat &imgBackground)
+{
+    int hist[BGDIFF_HIST_SIZE];
+    bool need_hist = strategy.method != BGDIFF_THRESH_FIXED;
+
+    threshold_values.resize(1);
+    threshold_values[0] = 0;
+
+    // 视频流第一帧或图像尺寸改变时背景刚初始化，前景为全零
+    // The background has just been inited on the first frame or when the image size changed, the foreground is all zero
+    if(accumulate(src, need_hist, selectiveGate(strategy), hist))
+    {
+        threshold_values[0] = thresholdDiff(strategy, hist, imgForeground);
+        last_threshold = threshold_values[0];
+    }
+    else
+    {
+        imgForeground.create(src.size(), CV_8UC1);
+        imgForeground = Scalar::all(0);
+    }
+
+    imgBackground = imgBackground8;
+}
+
+void BGDiffStream::process(const FrameView &frame, Mat &imgForeground, Mat &imgBackground)
+{
+    // 灰度转换在融合遍历中完成，BGR 帧视图也不需要先转换
+    // Gray conversion is done in the fused pass, so BGR Frame Views need no conversion first
+    process(FrameViewMat(frame), imgForeground, imgBackground);
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：多输出的流式背景差分算法；
+ *    灰度转换、差分与背景更新只进行一次，之后按每种阈值策略对同一差分图像阈值化，
+ *    OTSU 策略共用同一直方图，只有固定阈值时不统计直方图；
+ *    imgForegrounds 的大小调整为策略个数，其中的图像在尺寸不变时复用内存；
+ * 参数：
+ *   Mat src:  源图像，灰度或 BGR
+ *   const vector<BGDiffThreshold> &strategies:  阈值策略列表
+ *   vector<Mat> &imgForegrounds:  每种策略的前景图像
+ *   Mat& imgBackground: 背景图像
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Multi-output Streaming Background Difference Algorithm.
+ *   Gray Conversion, Difference and Background Update run only once, then the same
+ * Difference Image is thresholded by each Threshold Strategy. The OTSU strategies share
+ * one histogram, and no histogram is counted when all thresholds are fixed.
+ *   imgForegrounds is resized to the number of strategies, and its images reuse their
+ * memory while the image size stays the same.
+ *
+ * Arguments:
+ *   Mat src - source image, gray or BGR
+ *   const vector<BGDiffThreshold> &strategies - list of Threshold Strategies
+ *   vector<Mat> &imgForegrounds - Foreground Image of each strategy
+ *   Mat& imgBackground - Background Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::process(Mat src, const vector<BGDiffThreshold> &strategies,
+                           vector<Mat> &imgForegrounds, Mat &imgBackground)
+{
+    int hist[BGDIFF_HIST_SIZE];
+    bool need_hist = false;
+    for(size_t k = 0; k < strategies.size(); k++)
+        need_hist = need_hist || strategies[k].method != BGDIFF_THRESH_FIXED;
+
+    imgForegrounds.resize(strategies.size());
+    threshold_values.assign(strategies.size(), 0);
+
+    // 选择性更新由第一种阈值策略决定前景
+    // The first Threshold Strategy decides the foreground of the selective update
+    int gate = strategies.empty() ? 255 : selectiveGate(strategies[0]);
+    if(accumulate(src, need_hist, gate, hist))
+    {
+        for(size_t k = 0; k < strategies.size(); k++)
+            threshold_values[k] = thresholdDiff(strategies[k], hist, imgForegrounds[k]);
+        if(!strategies.empty())
+            last_threshold = threshold_values[0];
+    }
+    else
+    {
+        for(size_t k = 0; k < strategies.size(); k++)
+        {
+            imgForegrounds[k].create(src.size(), CV_8UC1);
+            imgForegrounds[k] = Scalar::all(0);
+        }
+    }
+
+    imgBackground = imgBackground8;
+}
+
+void BGDiffStream::process(const FrameView &frame, const vector<BGDiffThreshold> &strategies,
+                           vector<Mat> &imgForegrounds, Mat &imgBackground)
+{
+    process(FrameViewMat(frame), strategies, imgForegrounds, imgBackground);
+}
+
+// 更新速度转换为 Q8.8 背景使用的 alpha * 65536，限制在 [1, 65535]，正速度不会变为 0 而使背景停止更新
+// Convert an Update Speed to alpha * 65536 of the Q8.8 background, limited to [1, 65535], so a positive
+// speed never becomes 0 and stops the background
+static inline ushort AlphaQ(double speed)
+{
+    if(speed <= 0)
+        return 0;
+    double alpha_d = speed * (1 << BGDIFF_ALPHA_SHIFT) + 0.5;
+    return (ushort)(alpha_d < 1 ? 1 : alpha_d > 65535 ? 65535 : alpha_d);
+}
+
+/*===================================================================
+ * 函数名：accumulate
+ * 说明：逐行一次遍历完成灰度转换、与浮点或定点背景的差分以及背景滑动平均更新；
+ *    need_hist 为真时在同一遍历中统计差分图像的直方图；
+ *    视频流第一帧或图像尺寸改变时，用当前帧初始化背景并返回 false；
+ * 参数：
+ *   Mat src:  源图像，灰度或 BGR
+ *   bool need_hist:  是否统计差分图像的直方图
+ *   int gate:  选择性更新的前景判定阈值，255 表示所有像素以相同速度更新
+ *   int *hist:  输出 256 级直方图
+ * 返回值：bool，差分图像是否有效
+ *------------------------------------------------------------------
+ * Function: accumulate
+ *
+ * Summary:
+ *   Gray Conversion, Difference against the float or fixed-point background and the
+ * Background Running Average row by row in one pass. When need_hist is true, the
+ * histogram of the Difference Image is counted in the same pass.
+ *   On the first frame of the stream or when the image size changes, the background is
+ * inited with current frame and false is returned.
+ *
+ * Arguments:
+ *   Mat src - source image, gray or BGR
+ *   bool need_hist - count the histogram of the Difference Image or not
+ *   int gate - foreground threshold of the selective update, 255 means every pixel updates at the same speed
+ *   int *hist - output 256-level histogram
+ *
+ * Returns:
+ *   bool - whether the Difference Image is valid
+=====================================================================
+*/
+bool BGDiffStream::accumulate(Mat src, bool need_hist, int gate, int *hist)
+{
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+
+    if(imgBackground8.empty() || imgBackground8.size() != src.size())
+    {
+        init(src);
+        return false;
+    }
+
+    // 灰度转换、差分与背景更新，同时统计差分图像的直方图
+    // Gray Conversion, Difference & Background Update, counting the histogram of the Difference Image as well
+    int sub_hist[BGDIFF_SUB_HISTS * BGDIFF_HIST_SIZE];
+    memset(sub_hist, 0, sizeof(sub_hist));
+    int *hist_ptr = need_hist ? sub_hist : NULL;
+    if(bg_mode == BGDIFF_BG_Q8_8)
+    {
+        ushort alpha_q = AlphaQ(updateSpeed);
+        ushort alpha_fg_q = AlphaQ(selective ? fgSpeed : updateSpeed);
+
+        // BGR 行先转换到灰度行缓冲（仍在缓存中），之后由向量化核函数处理
+        // BGR rows are converted into the gray row buffer first (still in cache), then handled by the vectorized kernel
+        for(int i = 0; i < src.rows; i++)
+        {
+            const uchar *gray = src.ptr<uchar>(i);
+            if(src.channels() == 3)
+            {
+                BGDiffGrayRow(gray, src.cols, gray_row.ptr<uchar>(0));
+                gray = gray_row.ptr<uchar>(0);
+            }
+            BGDiffAccumulateRowQ8(gray, src.cols, alpha_q, alpha_fg_q, gate, imgBackgroundq.ptr<ushort>(i),
+                                  imgDiff.ptr<uchar>(i), imgBackground8.ptr<uchar>(i), hist_ptr);
+        }
+    }
+    else
+    {
+        float alpha = (float)updateSpeed;
+        float alpha_fg = (float)(selective ? fgSpeed : updateSpeed);
+        for(int i = 0; i < src.rows; i++)
+            BGDiffAccumulateRowF32(src.ptr<uchar>(i), src.channels(), src.cols, alpha, alpha_fg, gate,
+                                   imgBackgroundf.ptr<float>(i), imgDiff.ptr<uchar>(i),
+                                   imgBackground8.ptr<uchar>(i), hist_ptr);
+    }
+
+    if(need_hist)
+        BGDiffMergeHist(sub_hist, hist);
+    return true;
+}
+
+/*===================================================================
+ * 函数名：selectiveGate
+ * 说明：选择性更新的前景判定阈值；
+ *    固定阈值策略直接使用其阈值；OTSU 策略的阈值要在整帧直方图统计完成后才能得到，
+ *    而背景更新与差分在同一遍历中进行，因此使用上一帧的阈值；
+ * 参数：
+ *   const BGDiffThreshold &strategy:  决定前景的阈值策略
+ * 返回值：int，差分大于该值的像素视为前景，未开启选择性更新时为 255
+ *------------------------------------------------------------------
+ * Function: selectiveGate
+ *
+ * Summary:
+ *   Foreground Threshold of the Selective Update.
+ *   A fixed strategy uses its own threshold. The threshold of an OTSU strategy is only
+ * known after the histogram of the whole frame is counted, while the background update
+ * runs in the same pass as the difference, so the threshold of the last frame is used.
+ *
+ * Arguments:
+ *   const BGDiffThreshold &strategy - Threshold Strategy deciding the foreground
+ *
+ * Returns:
+ *   int - pixels whose difference is greater than it are foreground, 255 when the
+ *         selective update is off
+=====================================================================
+*/
+int BGDiffStream::selectiveGate(const BGDiffThreshold &strategy)
+{
+    if(!selective)
+        return 255;
+    int gate = strategy.method == BGDIFF_THRESH_FIXED ? strategy.value : last_threshold;
+    return gate < 0 ? 0 : gate > 255 ? 255 : gate;
+}
+
+/*===================================================================
+ * 函数名：thresholdDiff
+ * 说明：按一种阈值策略对差分图像阈值化，差分值大于阈值的像素为前景；
+ * 参数：
+ *   const BGDiffThreshold &strategy:  阈值策略
+ *   const int *hist:  差分图像的 256 级直方图，固定阈值时不使用
+ *   Mat &imgForeground:  输出前景图像
+ * 返回值：int，使用的阈值
+ *------------------------------------------------------------------
+ * Function: thresholdDiff
+ *
+ * Summary:
+ *   Threshold the Difference Image by one Threshold Strategy, pixels whose difference is
+ * greater than the threshold are foreground.
+ *
+ * Arguments:
+ *   const BGDiffThreshold &strategy - Threshold Strategy
+ *   const int *hist - 256-level histogram of the Difference Image, unused for a fixed threshold
+ *   Mat &imgForeground - output Foreground Image
+ *
+ * Returns:
+ *   int - threshold value used
+=====================================================================
+*/
+int BGDiffStream::thresholdDiff(const BGDiffThreshold &strategy, const int *hist, Mat &imgForeground)
+{
+    int value;
+    if(strategy.method == BGDIFF_THRESH_OTSU)
+        value = otsu.OtsuHist(hist, CV_THRESH_OTSU);
+    else if(strategy.method == BGDIFF_THRESH_OTSU_CLAMPED)
+        value = otsu.OtsuHist(hist, CV_THRESH_BINARY);
+    else
+        value = strategy.value;
+
+    threshold(imgDiff, imgForeground, value, 255, CV_THRESH_BINARY);
+    return value;
+}
+
+/*===================================================================
+ * 函数名：reset
+ * 说明：清除背景，下一帧重新初始化；
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: reset
+ *
+ * Summary:
+ *   Clear the Background, the next frame inits it again.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::reset()
+{
+    imgBackgroundf.release();
+    imgBackgroundq.release();
+    imgBackground8.release();
+    imgDiff.release();
+}
+
+/*===================================================================
+ * 函数名：setThresholdMethod / setThreshold / setUpdateSpeed
+ * 说明：设置单输出 process 的阈值方法或阈值策略，以及背景更新速度；
+ * 参数：
+ *   int method:  阈值方法，CV_THRESH_OTSU 或 CV_THRESH_BINARY
+ *   const BGDiffThreshold &strategy:  阈值策略
+ *   double speed:  背景更新速度
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setThresholdMethod / setThreshold / setUpdateSpeed
+ *
+ * Summary:
+ *   Set the method of getting Threshold Value or the Threshold Strategy of the
+ * single-output process, and the Speed of Background Update.
+ *
+ * Arguments:
+ *   int method - the method of getting Threshold Value, CV_THRESH_OTSU or CV_THRESH_BINARY
+ *   const BGDiffThreshold &strategy - Threshold Strategy
+ *   double speed - the Speed of Background Update
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::setThresholdMethod(int method)
+{
+    strategy = MakeBGDiffThreshold(method == CV_THRESH_OTSU ? BGDIFF_THRESH_OTSU : BGDIFF_THRESH_OTSU_CLAMPED);
+}
+
+void BGDiffStream::setThreshold(const BGDiffThreshold &strategy)
+{
+    this->strategy = strategy;
+}
+
+void BGDiffStream::setUpdateSpeed(double speed)
+{
+    updateSpeed = speed;
+}
+
+/*===================================================================
+ * 函数名：setBackgroundMode
+ * 说明：设置背景的存储格式，背景在下一帧重新初始化；
+ *    BGDIFF_BG_Q8_8 以 uint16 保存背景，内存为浮点背景的一半，
+ *    差分与更新全部为 16 位整数向量运算；
+ * 参数：
+ *   int mode:  BGDIFF_BG_FLOAT 或 BGDIFF_BG_Q8_8
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setBackgroundMode
+ *
+ * Summary:
+ *   Set the Storage Format of the Background, the background is inited again on the next frame.
+ *   BGDIFF_BG_Q8_8 keeps the background as uint16, half the memory of the float
+ * background, and the difference and update are all 16-bit integer vector arithmetic.
+ *
+ * Arguments:
+ *   int mode - BGDIFF_BG_FLOAT or BGDIFF_BG_Q8_8
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::setBackgroundMode(int mode)
+{
+    if(mode != bg_mode)
+        reset();
+    bg_mode = mode;
+}
+
+/*===================================================================
+ * 函数名：setSelectiveUpdate
+ * 说明：设置选择性背景更新；
+ *    开启后差分大于前景判定阈值的像素以 fgSpeed 更新背景，其余像素仍以 updateSpeed 更新，
+ *    慢速运动的前景不会很快被吸收进背景；fgSpeed 为 0 时前景像素不更新；
+ *    每个像素的更新速度在融合遍历中由刚计算的差分无分支地选择；
+ * 参数：
+ *   bool enable:  是否开启选择性更新
+ *   double fgSpeed:  前景像素的背景更新速度
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setSelectiveUpdate
+ *
+ * Summary:
+ *   Set the Selective Background Update.
+ *   When it is on, pixels whose difference is greater than the foreground threshold
+ * update the background at fgSpeed and the others still at updateSpeed, so slowly moving
+ * foreground isn't absorbed into the background quickly. With fgSpeed 0 foreground pixels
+ * don't update at all.
+ *   The update speed of every pixel is selected without branches from its just-computed
+ * difference in the fused pass.
+ *
+ * Arguments:
+ *   bool enable - Selective Update on or not
+ *   double fgSpeed - the Speed of Background Update of foreground pixels
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffStream::setSelectiveUpdate(bool enable, double fgSpeed)
+{
+    selective = enable;
+    this->fgSpeed = fgSpeed;
+}
+
+/*===================================================================
+ * 函数名：getDiff
+ * 说明：获取最近一帧的差分图像；
+ * 返回值：Mat
+ *------------------------------------------------------------------
+ * Function: getDiff
+ *
+ * Summary:
+ *   get the Difference Image of the latest frame.
+ *
+ * Returns:
+ *   Mat
+=====================================================================
+*/
+Mat BGDiffStream::getDiff()
+{
+    return imgDiff;
+}
+
+/*===================================================================
+ * 函数名：getThresholdValues
+ * 说明：获取最近一帧每种阈值策略使用的阈值，背景刚初始化时为 0；
+ * 返回值：const vector<int> &
+ *------------------------------------------------------------------
+ * Function: getThresholdValues
+ *
+ * Summary:
+ *   get the Threshold Value used by each Threshold Strategy on the latest frame, 0 when
+ * the background has just been inited.
+ *
+ * Returns:
+ *   const vector<int> &
+=====================================================================
+*/
+const vector<int> &BGDiffStream::getThresholdValues()
+{
+    return threshold_values;
 }
@@ -24,17 +24,57 @@
 #define BGDIFFERENCE_H
 
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
+#include <vector>
 
 #include "cv.h"
 #include "cxcore.h"
 #include "highgui.h"
 #include "cvaux.h"
 #include "cxmisc.h"
+#include "Common/FrameView.h"
+#include "BGDiffKernel.h"
 
 using namespace cv;
 using namespace std;
 
+// 该类中OTSU方法的阈值最小值
+// the Minimum Threshold Value of this class's OTSU method
+#define OTSU_MIN_THRESHOLD 20
+
+// 阈值策略：OpenCV自带OTSU方法、该类中的OTSU方法（阈值不小于 OTSU_MIN_THRESHOLD）、固定阈值
+// Threshold Strategy: OpenCV's OTSU method, this class's OTSU method (at least OTSU_MIN_THRESHOLD), fixed threshold
+#define BGDIFF_THRESH_OTSU          0
+#define BGDIFF_THRESH_OTSU_CLAMPED  1
+#define BGDIFF_THRESH_FIXED         2
+
+// 背景的存储格式：浮点，或 Q8.8 定点（uint16，内存减半）
+// Storage Format of the Background: float, or Q8.8 fixed-point (uint16, half the memory)
+#define BGDIFF_BG_FLOAT  0
+#define BGDIFF_BG_Q8_8   1
+
+// 一种阈值策略，差分值大于阈值的像素为前景
+// One Threshold Strategy, pixels whose difference is greater than the threshold are foreground
+struct BGDiffThreshold
+{
+    // 策略，BGDIFF_THRESH_*
+    // Strategy, BGDIFF_THRESH_*
+    int method;
+
+    // BGDIFF_THRESH_FIXED 的阈值，其他策略忽略
+    // Threshold Value of BGDIFF_THRESH_FIXED, ignored by the other strategies
+    int value;
+};
+
+// 构造阈值策略
+// Construct a Threshold Strategy
+inline BGDiffThreshold MakeBGDiffThreshold(int method, int value = 0)
+{
+    BGDiffThreshold t = {method, value};
+    return t;
+}
+
 class BGDiff
 {
 public:
@@ -46,6 +86,150 @@ public:
     // 大津法
     // OTSU Algorithm
     void Otsu(Mat src, int &thresholdValue, bool ToShowValue = false);
+
+    // 由 256 级直方图计算大津法阈值，CV_THRESH_BINARY（该类中的OTSU方法）时阈值不小于 OTSU_MIN_THRESHOLD
+    // OTSU Algorithm on a 256-level histogram; with CV_THRESH_BINARY (this class's OTSU method) the threshold is at least OTSU_MIN_THRESHOLD
+    int OtsuHist(const int *hist, int threshold_method = CV_THRESH_BINARY, bool ToShowValue = false);
+};
+
+/*===================================================================
+ * 类名：BGDiffStream
+ * 说明：流式背景差分算法，持有跨帧保持的浮点或 Q8.8 定点背景；
+ *    每帧一次遍历完成灰度转换、差分与背景更新，图像尺寸不变时不分配内存；
+ *------------------------------------------------------------------
+ * Class: BGDiffStream
+ *
+ * Summary:
+ *   Streaming Background Difference Algorithm, owns a float or Q8.8 fixed-point
+ * background kept across frames.
+ *   Gray Conversion, Difference and Background Update are done in one pass per frame,
+ * and nothing is allocated while the image size stays the same.
+=====================================================================
+*/
+class BGDiffStream
+{
+public:
+    BGDiffStream(int threshold_method = CV_THRESH_OTSU, double updateSpeed = 0.03);
+
+    // 用一帧图像（灰度或 BGR）初始化背景
+    // Init the Background with a frame (gray or BGR)
+    void init(Mat src);
+
+    // 处理一帧图像，输出前景二值图像与 8 位背景图像；
+    // 第一帧或图像尺寸改变时先初始化背景，此时前景为全零
+    // Process a frame, output the Foreground Binary Image and the 8-bit Background Image.
+    // The background is inited first on the first frame or when the image size changes,
+    // and the foreground is all zero then.
+    void process(Mat src, Mat &imgForeground, Mat &imgBackground);
+
+    // 由调用者持有的帧缓冲区处理一帧，GRAY / NV12 / I420 直接读取亮度平面，不拷贝
+    // Process a frame from a caller-owned frame buffer; GRAY / NV12 / I420 read the luma plane directly without copying.
+    void process(const FrameView &frame, Mat &imgForeground, Mat &imgBackground);
+
+    // 处理一帧图像，差分与背景更新只进行一次，为每种阈值策略输出一幅前景二值图像
+    // Process a frame, run the Difference and the Background Update once, and output one
+    // Foreground Binary Image for each Threshold Strategy.
+    void process(Mat src, const vector<BGDiffThreshold> &strategies,
+                 vector<Mat> &imgForegrounds, Mat &imgBackground);
+    void process(const FrameView &frame, const vector<BGDiffThreshold> &strategies,
+                 vector<Mat> &imgForegrounds, Mat &imgBackground);
+
+    // 获取最近一帧每种阈值策略使用的阈值
+    // get the Threshold Value used by each Threshold Strategy on the latest frame
+    const vector<int> &getThresholdValues();
+
+    // 清除背景，下一帧重新初始化
+    // Clear the Background, the next frame inits it again
+    void reset();
+
+    // 设置阈值方法：CV_THRESH_OTSU 或 CV_THRESH_BINARY（该类中的OTSU方法）
+    // Set the method of getting Threshold Value: CV_THRESH_OTSU or CV_THRESH_BINARY (this class's OTSU method)
+    void setThresholdMethod(int method);
+
+    // 设置单输出 process 的阈值策略
+    // Set the Threshold Strategy of the single-output process
+    void setThreshold(const BGDiffThreshold &strategy);
+
+    // 设置背景更新速度；BGDIFF_BG_Q8_8 的速度精度为 1 / 65536，小于该值的正速度按 1 / 65536 处理
+    // Set the Speed of Background Update; BGDIFF_BG_Q8_8 has a speed resolution of 1 / 65536, smaller positive speeds are taken as 1 / 65536
+    void setUpdateSpeed(double speed);
+
+    // 设置背景的存储格式：BGDIFF_BG_FLOAT 或 BGDIFF_BG_Q8_8，背景在下一帧重新初始化；
+    // Q8.8 的更新量向上取整，任意正速度下背景都会收敛到当前帧，没有停滞区
+    // Set the Storage Format of the Background: BGDIFF_BG_FLOAT or BGDIFF_BG_Q8_8, the background is inited again on the next frame;
+    // the Q8.8 step is rounded up, so the background converges to the frame at any positive speed, with no dead zone
+    void setBackgroundMode(int mode);
+
+    // 设置选择性背景更新：前景像素以 fgSpeed 更新（0 表示不更新），背景像素仍以 updateSpeed 更新
+    // Set the Selective Background Update: foreground pixels update at fgSpeed (0 means no update), background pixels still at updateSpeed
+    void setSelectiveUpdate(bool enable, double fgSpeed = 0);
+
+    // 获取差分图像
+    // get the Difference Image
+    Mat getDiff();
+
+private:
+    // 差分与背景更新，need_hist 为真时输出差分图像的直方图；背景刚初始化时返回 false
+    // Difference & Background Update, output the histogram of the Difference Image when
+    // need_hist is true; returns false when the background has just been inited
+    bool accumulate(Mat src, bool need_hist, int gate, int *hist);
+
+    // 选择性更新的前景判定阈值，未开启选择性更新时为 255
+    // Foreground Threshold of the Selective Update, 255 when the selective update is off
+    int selectiveGate(const BGDiffThreshold &strategy);
+
+    // 按一种阈值策略对差分图像阈值化，返回使用的阈值
+    // Threshold the Difference Image by one Threshold Strategy, returns the threshold value used
+    int thresholdDiff(const BGDiffThreshold &strategy, const int *hist, Mat &imgForeground);
+
+    // 浮点背景，BGDIFF_BG_FLOAT 时跨帧保持
+    // float Background, kept across frames with BGDIFF_BG_FLOAT
+    Mat imgBackgroundf;
+
+    // Q8.8 定点背景（CV_16UC1），BGDIFF_BG_Q8_8 时跨帧保持
+    // Q8.8 fixed-point Background (CV_16UC1), kept across frames with BGDIFF_BG_Q8_8
+    Mat imgBackgroundq;
+
+    // 8 位背景图像，与浮点或定点背景在同一遍历中得到
+    // 8-bit Background Image, written in the same pass as the float or fixed-point background
+    Mat imgBackground8;
+
+    // BGR 输入时一行像素的灰度缓冲，供 Q8.8 向量化核函数使用
+    // Gray Buffer of one row for BGR input, used by the Q8.8 vectorized kernel
+    Mat gray_row;
+
+    // 背景的存储格式
+    // Storage Format of the Background
+    int bg_mode;
+
+    // 差分图像
+    // Difference Image
+    Mat imgDiff;
+
+    // 单输出 process 的阈值策略
+    // Threshold Strategy of the single-output process
+    BGDiffThreshold strategy;
+
+    // 最近一帧每种阈值策略使用的阈值
+    // Threshold Value used by each Threshold Strategy on the latest frame
+    vector<int> threshold_values;
+
+    // 背景更新速度
+    // the Speed of Background Update
+    double updateSpeed;
+
+    // 是否开启选择性更新，以及前景像素的背景更新速度
+    // Selective Update on or not, and the Speed of Background Update of foreground pixels
+    bool selective;
+    double fgSpeed;
+
+    // 上一帧第一种阈值策略使用的阈值，作为 OTSU 策略时选择性更新的前景判定阈值
+    // Threshold Value used by the first Threshold Strategy on the last frame, the foreground threshold of the selective update under OTSU strategies
+    int last_threshold;
+
+    // 该类中的OTSU方法
+    // this class's OTSU method
+    BGDiff otsu;
 };
 
 #endif // BGDIFFERENCE_H
@@ -26,6 +26,7 @@
  * v1.1: 背景差分法封装成类: BGDiff；
  * v1.2: 补充注释；
  * v1.3: 该方法与高斯混合背景模型不同，命名有误，改为背景差分法；
+ * v1.4: 使用流式背景差分 BGDiffStream，一次差分同时输出两种OTSU方法的前景；
 ===================================================
 */
 
@@ -35,13 +36,10 @@ int main( int argc, char** argv )
 {
     // 原图像
     Mat pFrame;
-    // 原始OTSU算法输出图像
-    Mat pFroundImg;
+    // 每种阈值策略的前景图像：[0] 原始OTSU算法, [1] 改进的OTSU算法
+    vector<Mat> pFroundImgs;
     // 背景图像
     Mat pBackgroundImg;
-    // 改进的OTSU算法输出图像
-    Mat pFroundImg_c;
-    Mat pBackgroundImg_c;
 
     //视频控制全局变量,
    // 's' 画面stop
@@ -49,7 +47,12 @@ int main( int argc, char** argv )
    // 'p' 打印OTSU算法中找到的阈值
    char ctrl = NULL;
 
-   BGDiff BGDif;
+   BGDiffStream BGDif;
+
+   // 阈值策略：OpenCV自带OTSU，阈值筛选后的OTSU
+   vector<BGDiffThreshold> strategies;
+   strategies.push_back(MakeBGDiffThreshold(BGDIFF_THRESH_OTSU));
+   strategies.push_back(MakeBGDiffThreshold(BGDIFF_THRESH_OTSU_CLAMPED));
 
    VideoCapture capture;
    capture = VideoCapture("./Video/Camera Road 01.avi");
@@ -74,6 +77,8 @@ int main( int argc, char** argv )
     while(!pFrame.empty())
     {
         capture >> pFrame;
+        if(pFrame.empty())
+            break;
         nFrmNum++;
 
         // 视频控制
@@ -84,16 +89,14 @@ int main( int argc, char** argv )
         else if( ctrl == 'q')
             break;
 
-        // OpenCV自带OTSU
-        BGDif.BackgroundDiff(pFrame, pFroundImg, pBackgroundImg, nFrmNum, CV_THRESH_OTSU);
-        // 阈值筛选后的OTSU
-        BGDif.BackgroundDiff(pFrame, pFroundImg_c, pBackgroundImg_c, nFrmNum, CV_THRESH_BINARY);
+        // 差分与背景更新只进行一次，同时输出两种OTSU方法的前景
+        BGDif.process(pFrame, strategies, pFroundImgs, pBackgroundImg);
 
         // 显示图像
         imshow("Source Video", pFrame);
         imshow("Background", pBackgroundImg);
-        imshow("OTSU ForeGround", pFroundImg);
-        imshow("Advanced OTSU ForeGround", pFroundImg_c);
+        imshow("OTSU ForeGround", pFroundImgs[0]);
+        imshow("Advanced OTSU ForeGround", pFroundImgs[1]);
     }
     return 0;
 }
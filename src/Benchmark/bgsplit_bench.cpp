@@ -0,0 +1,648 @@
+/*=================================================================
+ * Headless End-to-end Benchmark of the Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+/*=================================================
+ * 用法 | Usage:
+ *   bgsplit_bench [--input 视频路径 | --raw 原始文件 --raw-size WxH [--raw-format gray|bgr|nv12|i420] | --synthetic]
+ *                 [--sizes 160x120,640x480,...] [--threads 1,4,...] [--algorithms framediff,bgdiff,vibe,vibe+]
+ *                 [--frames N] [--warmup N] [--output bgsplit_bench.json]
+ *
+ *   不显示任何窗口，每种 算法 x 分辨率 x 线程数 组合单独运行，结果以 JSON 写入 --output；
+ *   只对算法的 process 计时（取 apply 的统计），解码、缩放与前景占比统计不计入；前 warmup 帧（训练帧与缓冲区分配）不计入统计；
+ *   内存分配次数通过替换 glibc 的 malloc 系列函数统计，其他 C 库上为 null；
+ *   峰值常驻内存为本次运行中整个进程的峰值，Linux 上每次运行前重置；
+ *------------------------------------------------
+ *   No window is shown. Every algorithm x resolution x thread count runs on its own and
+ * the results are written as JSON to --output.
+ *   Only the algorithm's process is timed (taken from apply's statistics); decoding, scaling
+ * and the foreground ratio are not. The first warmup frames (training frame and buffer
+ * allocation) are left out of the statistics.
+ *   Allocations are counted by replacing glibc's malloc family, they are null on other C libraries.
+ *   Peak RSS is the whole process's peak during the run, reset before every run on Linux.
+===================================================
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "opencv2/opencv.hpp"
+#include "Pipeline/Subtractors.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+// 输入来源
+// Input Source
+#define BENCH_SOURCE_VIDEO      0
+#define BENCH_SOURCE_RAW        1
+#define BENCH_SOURCE_SYNTHETIC  2
+
+// 合成视频的原始分辨率
+// Native Resolution of the synthetic video
+#define BENCH_SYNTHETIC_WIDTH   640
+#define BENCH_SYNTHETIC_HEIGHT  480
+
+//====================================================
+//   内存分配计数：替换 glibc 的 malloc 系列函数，转发给 __libc_* 实现；
+//   可执行文件中的定义优先于共享库，OpenCV 的 fastMalloc 与 operator new 都会被统计
+//----------------------------------------------------
+//   Allocation Counting: replace glibc's malloc family and forward to the __libc_*
+// implementations. Definitions in the executable take precedence over shared libraries,
+// so OpenCV's fastMalloc and operator new are both counted.
+//====================================================
+static std::atomic<long long> alloc_count(0);
+
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCS 1
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    if(alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = __libc_memalign(alignment, size);
+    if(ptr == NULL)
+        return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+}
+#else
+#define BENCH_COUNT_ALLOCS 0
+#endif
+
+// 重置进程的峰值常驻内存（Linux 4.0 及以上）
+// Reset the peak RSS of the process (Linux 4.0 and later)
+static void ResetPeakRSS()
+{
+#if defined(__linux__)
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if(f != NULL)
+    {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+// 进程的峰值常驻内存（KB），无法获取时为 -1
+// Peak RSS of the process (KB), -1 when unavailable
+static long PeakRSSKB()
+{
+#if defined(__linux__)
+    FILE *f = fopen("/proc/self/status", "r");
+    if(f != NULL)
+    {
+        char line[256];
+        long kb = -1;
+        while(fgets(line, sizeof(line), f) != NULL)
+        {
+            if(strncmp(line, "VmHWM:", 6) == 0)
+            {
+                kb = atol(line + 6);
+                break;
+            }
+        }
+        fclose(f);
+        if(kb >= 0)
+            return kb;
+    }
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+/*===================================================================
+ * 类名：BenchSource
+ * 说明：测试输入：视频文件、原始帧文件或合成视频，每次运行重新打开，从头读取；
+ *    原始帧文件的 NV12 / I420 只读取亮度平面；
+ *------------------------------------------------------------------
+ * Class: BenchSource
+ *
+ * Summary:
+ *   Benchmark Input: a video file, a raw frame file or a synthetic video, reopened and
+ * read from the start for every run.
+ *   Only the luma plane of NV12 / I420 raw frames is read.
+=====================================================================
+*/
+class BenchSource
+{
+public:
+    BenchSource()
+        : kind(BENCH_SOURCE_SYNTHETIC), raw_format(FRAME_FORMAT_GRAY), frame_count(0)
+    {
+    }
+
+    bool open()
+    {
+        frame_count = 0;
+        if(kind == BENCH_SOURCE_VIDEO)
+        {
+            capture.release();
+            return capture.open(path);
+        }
+        if(kind == BENCH_SOURCE_RAW)
+        {
+            raw.close();
+            raw.clear();
+            raw.open(path.c_str(), ios::binary);
+            return raw.is_open() && raw_size.area() > 0;
+        }
+
+        // 合成视频：带纹理的静止背景，加上移动的方块与逐帧噪声
+        // Synthetic video: a textured static background, plus a moving block and per-frame noise
+        RNG rng(12345);
+        synthetic_bg.create(BENCH_SYNTHETIC_HEIGHT, BENCH_SYNTHETIC_WIDTH, CV_8UC3);
+        rng.fill(synthetic_bg, RNG::UNIFORM, Scalar::all(40), Scalar::all(200));
+        GaussianBlur(synthetic_bg, synthetic_bg, Size(9, 9), 0);
+        synthetic_rng = RNG(54321);
+        return true;
+    }
+
+    bool read(Mat &frame)
+    {
+        if(kind == BENCH_SOURCE_VIDEO)
+        {
+            capture >> frame;
+            return !frame.empty();
+        }
+        if(kind == BENCH_SOURCE_RAW)
+            return readRaw(frame);
+
+        synthetic_bg.copyTo(frame);
+        int block = BENCH_SYNTHETIC_HEIGHT / 6;
+        int x = (frame_count * 4) % (BENCH_SYNTHETIC_WIDTH - block);
+        rectangle(frame, Rect(x, BENCH_SYNTHETIC_HEIGHT / 3, block, block), Scalar(30, 220, 250), -1);
+        noise.create(frame.size(), CV_8UC3);
+        synthetic_rng.fill(noise, RNG::UNIFORM, Scalar::all(0), Scalar::all(8));
+        add(frame, noise, frame);
+        frame_count++;
+        return true;
+    }
+
+    const char *kindName() const
+    {
+        return kind == BENCH_SOURCE_VIDEO ? "video" : kind == BENCH_SOURCE_RAW ? "raw" : "synthetic";
+    }
+
+    int kind;
+    string path;
+    Size raw_size;
+    int raw_format;
+
+private:
+    bool readRaw(Mat &frame)
+    {
+        int w = raw_size.width, h = raw_size.height;
+        int type = raw_format == FRAME_FORMAT_BGR ? CV_8UC3 : CV_8UC1;
+        frame.create(h, w, type);
+        if(!raw.read((char *)frame.data, (streamsize)frame.total() * frame.elemSize()))
+            return false;
+
+        // 跳过色度平面
+        // Skip the chroma planes
+        if(raw_format == FRAME_FORMAT_NV12 || raw_format == FRAME_FORMAT_I420)
+            raw.seekg((streamoff)w * h / 2, ios::cur);
+        return true;
+    }
+
+    VideoCapture capture;
+    ifstream raw;
+    Mat synthetic_bg;
+    Mat noise;
+    RNG synthetic_rng;
+    int frame_count;
+};
+
+// 一次运行的结果
+// Result of one run
+struct BenchResult
+{
+    string algorithm;
+    Size size;
+    int threads;
+    int frames;
+    double fps;
+    double mean_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+    long peak_rss_kb;
+    double allocs_per_frame;
+};
+
+// 已排序耗时的 p 百分位数（最近秩法）
+// Percentile p of sorted times (nearest rank)
+static double Percentile(const vector<double> &sorted, double p)
+{
+    if(sorted.empty())
+        return 0;
+    size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/*===================================================================
+ * 函数名：RunBenchmark
+ * 说明：以指定分辨率与线程数运行一种算法，只对 process 计时，前 warmup 帧不计入统计；
+ * 参数：
+ *   BenchSource &source:  测试输入
+ *   const string &algorithm:  算法名称
+ *   Size size:  分辨率，输入帧缩放到该尺寸
+ *   int threads:  OpenCV 线程池的线程个数
+ *   int frames:  计入统计的帧数
+ *   int warmup:  预热帧数
+ *   BenchResult &result:  输出结果
+ * 返回值：bool，算法名称或输入无效时为 false
+ *------------------------------------------------------------------
+ * Function: RunBenchmark
+ *
+ * Summary:
+ *   Run one algorithm at the given resolution & thread count. Only process is timed, and
+ * the first warmup frames are left out of the statistics.
+ *
+ * Arguments:
+ *   BenchSource &source - Benchmark Input
+ *   const string &algorithm - name of the algorithm
+ *   Size size - resolution, input frames are scaled to it
+ *   int threads - number of threads of OpenCV's thread pool
+ *   int frames - frames counted in the statistics
+ *   int warmup - warm-up frames
+ *   BenchResult &result - output result
+ *
+ * Returns:
+ *   bool, false when the algorithm name or the input is invalid
+=====================================================================
+*/
+static bool RunBenchmark(BenchSource &source, const string &algorithm, Size size, int threads,
+                         int frames, int warmup, BenchResult &result)
+{
+    BGSplitSubtractor *subtractor = CreateSubtractor(algorithm);
+    if(subtractor == NULL || !source.open())
+    {
+        delete subtractor;
+        return false;
+    }
+
+    setNumThreads(threads);
+    ResetPeakRSS();
+
+    Mat frame, scaled, mask;
+    vector<double> times;
+    times.reserve(frames);
+    long long allocs = 0;
+
+    for(int n = 0; n < warmup + frames && source.read(frame); n++)
+    {
+        // 缩放到单独的缓冲，frame 保持为输入来源自己的缓冲
+        // Scale into a separate buffer, frame stays the input source's own buffer
+        const Mat *input = &frame;
+        if(frame.size() != size)
+        {
+            resize(frame, scaled, size, 0, 0, INTER_AREA);
+            input = &scaled;
+        }
+        FrameView view = MakeFrameView(*input);
+
+        // 耗时取 apply 只围绕 process 的计时，不含前景占比统计的整帧遍历
+        // apply's own timing around process, without the full-frame pass of the foreground ratio
+        long long alloc_begin = alloc_count.load(std::memory_order_relaxed);
+        subtractor->apply(view, mask);
+        double time = subtractor->stats().last_ms;
+        long long alloc_end = alloc_count.load(std::memory_order_relaxed);
+
+        if(n >= warmup)
+        {
+            times.push_back(time);
+            allocs += alloc_end - alloc_begin;
+        }
+    }
+
+    result.algorithm = algorithm;
+    result.size = size;
+    result.threads = threads;
+    result.frames = (int)times.size();
+    result.peak_rss_kb = PeakRSSKB();
+
+    double total = 0;
+    for(size_t k = 0; k < times.size(); k++)
+        total += times[k];
+    sort(times.begin(), times.end());
+
+    result.fps = total > 0 ? times.size() * 1000.0 / total : 0;
+    result.mean_ms = times.empty() ? 0 : total / times.size();
+    result.p50_ms = Percentile(times, 50);
+    result.p95_ms = Percentile(times, 95);
+    result.p99_ms = Percentile(times, 99);
+    result.max_ms = times.empty() ? 0 : times.back();
+    result.allocs_per_frame = times.empty() ? 0 : (double)allocs / times.size();
+
+    delete subtractor;
+    return true;
+}
+
+// JSON 字符串转义
+// Escape a JSON string
+static string JsonString(const string &s)
+{
+    string out = "\"";
+    for(size_t k = 0; k < s.size(); k++)
+    {
+        char c = s[k];
+        if(c == '"' || c == '\\')
+            out += '\\';
+        if((unsigned char)c < 0x20)
+            continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+// 写出 JSON 结果
+// Write the JSON results
+static bool WriteJson(const string &file, const BenchSource &source, int frames, int warmup,
+                      const vector<BenchResult> &results)
+{
+    FILE *f = fopen(file.c_str(), "w");
+    if(f == NULL)
+        return false;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"benchmark\": \"bgsplit_bench\",\n");
+    fprintf(f, "  \"input\": {\"source\": \"%s\", \"path\": %s},\n", source.kindName(), JsonString(source.path).c_str());
+    fprintf(f, "  \"frames\": %d,\n", frames);
+    fprintf(f, "  \"warmup\": %d,\n", warmup);
+    fprintf(f, "  \"cpus\": %d,\n", getNumberOfCPUs());
+    fprintf(f, "  \"results\": [\n");
+    for(size_t k = 0; k < results.size(); k++)
+    {
+        const BenchResult &r = results[k];
+        fprintf(f, "    {\"algorithm\": %s, \"width\": %d, \"height\": %d, \"threads\": %d, \"frames\": %d, "
+                   "\"fps\": %.3f, \"latency_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}, ",
+                JsonString(r.algorithm).c_str(), r.size.width, r.size.height, r.threads, r.frames,
+                r.fps, r.mean_ms, r.p50_ms, r.p95_ms, r.p99_ms, r.max_ms);
+        if(r.peak_rss_kb >= 0)
+            fprintf(f, "\"peak_rss_kb\": %ld, ", r.peak_rss_kb);
+        else
+            fprintf(f, "\"peak_rss_kb\": null, ");
+        if(BENCH_COUNT_ALLOCS)
+            fprintf(f, "\"allocs_per_frame\": %.3f}", r.allocs_per_frame);
+        else
+            fprintf(f, "\"allocs_per_frame\": null}");
+        fprintf(f, "%s\n", k + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// 解析 "WxH"
+// Parse "WxH"
+static bool ParseSize(const string &s, Size &size)
+{
+    int w = 0, h = 0;
+    if(sscanf(s.c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0)
+        return false;
+    size = Size(w, h);
+    return true;
+}
+
+// 按逗号分割
+// Split by commas
+static vector<string> SplitList(const string &s)
+{
+    vector<string> items;
+    stringstream ss(s);
+    string item;
+    while(getline(ss, item, ','))
+    {
+        if(!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: bgsplit_bench [--input video | --raw file --raw-size WxH [--raw-format gray|bgr|nv12|i420] | --synthetic]" << endl
+         << "                     [--sizes 160x120,...] [--threads 1,4,...] [--algorithms framediff,bgdiff,vibe,vibe+]" << endl
+         << "                     [--frames N] [--warmup N] [--output bgsplit_bench.json]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchSource source;
+    bool source_given = false;
+    string sizes_arg = "160x120,320x240,640x480,1280x720,1920x1080,3840x2160";
+    string threads_arg;
+    string algorithms_arg = "framediff,bgdiff,vibe,vibe+";
+    string output = "bgsplit_bench.json";
+    int frames = 100;
+    int warmup = 10;
+
+    for(int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--synthetic")
+        {
+            source.kind = BENCH_SOURCE_SYNTHETIC;
+            source_given = true;
+        }
+        else if(arg == "--input" && has_value)
+        {
+            source.kind = BENCH_SOURCE_VIDEO;
+            source.path = argv[++i];
+            source_given = true;
+        }
+        else if(arg == "--raw" && has_value)
+        {
+            source.kind = BENCH_SOURCE_RAW;
+            source.path = argv[++i];
+            source_given = true;
+        }
+        else if(arg == "--raw-size" && has_value && ParseSize(argv[i + 1], source.raw_size))
+            i++;
+        else if(arg == "--raw-format" && has_value)
+        {
+            string format = argv[++i];
+            source.raw_format = format == "bgr" ? FRAME_FORMAT_BGR : format == "nv12" ? FRAME_FORMAT_NV12 :
+                                format == "i420" ? FRAME_FORMAT_I420 : FRAME_FORMAT_GRAY;
+        }
+        else if(arg == "--sizes" && has_value)
+            sizes_arg = argv[++i];
+        else if(arg == "--threads" && has_value)
+            threads_arg = argv[++i];
+        else if(arg == "--algorithms" && has_value)
+            algorithms_arg = argv[++i];
+        else if(arg == "--frames" && has_value)
+            frames = max(atoi(argv[++i]), 1);
+        else if(arg == "--warmup" && has_value)
+            warmup = max(atoi(argv[++i]), 0);
+        else if(arg == "--output" && has_value)
+            output = argv[++i];
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // 未指定输入时使用仓库中的测试视频，找不到时使用合成视频
+    // Without an input, use the test video of the repository, or the synthetic video when it can't be found
+    if(!source_given)
+    {
+        const char *paths[] = {"./Video/Camera Road 01.avi", "../Video/Camera Road 01.avi", "../../Video/Camera Road 01.avi"};
+        for(int k = 0; k < 3; k++)
+        {
+            VideoCapture probe(paths[k]);
+            if(probe.isOpened())
+            {
+                source.kind = BENCH_SOURCE_VIDEO;
+                source.path = paths[k];
+                break;
+            }
+        }
+    }
+    if(!source.open())
+    {
+        cout << "ERROR: Can't open the input: " << source.path << endl;
+        return -1;
+    }
+
+    vector<Size> sizes;
+    vector<string> size_items = SplitList(sizes_arg);
+    for(size_t k = 0; k < size_items.size(); k++)
+    {
+        Size size;
+        if(!ParseSize(size_items[k], size))
+        {
+            cout << "ERROR: Bad size: " << size_items[k] << endl;
+            return -1;
+        }
+        sizes.push_back(size);
+    }
+
+    vector<int> threads;
+    if(threads_arg.empty())
+    {
+        threads.push_back(1);
+        if(getNumberOfCPUs() > 1)
+            threads.push_back(getNumberOfCPUs());
+    }
+    else
+    {
+        vector<string> items = SplitList(threads_arg);
+        for(size_t k = 0; k < items.size(); k++)
+            threads.push_back(max(atoi(items[k].c_str()), 1));
+    }
+
+    vector<string> algorithms = SplitList(algorithms_arg);
+    vector<BenchResult> results;
+    for(size_t a = 0; a < algorithms.size(); a++)
+    {
+        for(size_t s = 0; s < sizes.size(); s++)
+        {
+            for(size_t t = 0; t < threads.size(); t++)
+            {
+                BenchResult result;
+                if(!RunBenchmark(source, algorithms[a], sizes[s], threads[t], frames, warmup, result))
+                {
+                    cout << "ERROR: Unknown algorithm or bad input: " << algorithms[a] << endl;
+                    return -1;
+                }
+                results.push_back(result);
+
+                cout << result.algorithm << " " << result.size.width << "x" << result.size.height
+                     << " threads=" << result.threads << ": " << result.fps << " fps, p50 " << result.p50_ms
+                     << "ms, p99 " << result.p99_ms << "ms" << endl;
+            }
+        }
+    }
+
+    if(!WriteJson(output, source, frames, warmup, results))
+    {
+        cout << "ERROR: Can't write " << output << endl;
+        return -1;
+    }
+    cout << "Results written to " << output << endl;
+
+    return 0;
+}
@@ -0,0 +1,726 @@
+/*=================================================================
+ * Microbenchmarks of the Inner Kernels of the Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+/*=================================================
+ * 用法 | Usage:
+ *   bgsplit_microbench [--sizes 160x120,640x480,1920x1080] [--samples 8,16,20,32]
+ *                      [--kernels vibe_match,vibeplus_color,ada_threshold,blink_update,otsu_hist,bgdiff_accumulate,hole_filling]
+ *                      [--reps N] [--output bgsplit_microbench.json]
+ *
+ *   在合成数据上单独测量各核函数，不经过解码与完整的算法流程；单线程运行；
+ *   每个核函数处理一整帧为一次，先预热，再取 reps 次的中位数与最小值；
+ *   样本个数只对 vibe_match、vibeplus_color 与 ada_threshold 有意义；
+ *------------------------------------------------
+ *   Every kernel is measured on its own on synthetic data, without decoding or the whole
+ * algorithm, on one thread.
+ *   One run of a kernel processes a whole frame. After warming up, the median and the
+ * minimum of reps runs are taken.
+ *   The sample count only matters for vibe_match, vibeplus_color and ada_threshold.
+===================================================
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "opencv2/opencv.hpp"
+#include "ViBe/VibeKernel.h"
+#include "ViBe+/ViBePlus.h"
+#include "ViBe+/ViBePlusKernel.h"
+#include "BGDifference/BGDifference.h"
+#include "BGDifference/BGDiffKernel.h"
+#include "Common/ConnectedRegions.h"
+
+using namespace cv;
+using namespace std;
+
+// 预热次数
+// Warm-up Runs
+#define MICROBENCH_WARMUP  3
+
+// ViBe 的匹配半径与 #min 指数（与 ViBe 的默认值相同）
+// Match Radius & Match Number of ViBe (the same as ViBe's defaults)
+#define MICROBENCH_VIBE_RADIUS       20
+#define MICROBENCH_VIBE_MIN_MATCHES  2
+
+// 合成样本与当前像素的最大偏差，使匹配与不匹配都会出现
+// Max Deviation of synthetic samples from the current pixel, so both matches and misses occur
+#define MICROBENCH_SAMPLE_SPREAD  40
+
+// 合成灰度图像：随机纹理
+// Synthetic Gray Image: random texture
+static void SyntheticImage(Mat &img, Size size, int type, RNG &rng)
+{
+    img.create(size, type);
+    for(int i = 0; i < img.rows; i++)
+    {
+        uchar *p = img.ptr<uchar>(i);
+        for(int j = 0; j < img.cols * img.channels(); j++)
+            p[j] = (uchar)rng.uniform(0, 256);
+    }
+}
+
+// 在 v 附近的随机样本
+// Random Sample near v
+static uchar SampleNear(int v, RNG &rng)
+{
+    int s = v + rng.uniform(-MICROBENCH_SAMPLE_SPREAD, MICROBENCH_SAMPLE_SPREAD + 1);
+    return (uchar)(s < 0 ? 0 : s > 255 ? 255 : s);
+}
+
+/*===================================================================
+ * 类名：KernelBench
+ * 说明：一个核函数的测试用例，构造时准备合成数据，run 处理一整帧；
+ *------------------------------------------------------------------
+ * Class: KernelBench
+ *
+ * Summary:
+ *   Test Case of one kernel. The synthetic data is prepared on construction, and run
+ * processes one whole frame.
+=====================================================================
+*/
+class KernelBench
+{
+public:
+    KernelBench(const string &kernel, const string &variant, Size size, int samples)
+        : kernel(kernel), variant(variant), size(size), samples(samples)
+    {
+    }
+    virtual ~KernelBench() {}
+
+    virtual void run() = 0;
+
+    string kernel;
+    string variant;
+    Size size;
+
+    // 样本个数，与样本个数无关的核函数为 0
+    // Number of Samples, 0 for kernels which don't depend on it
+    int samples;
+};
+
+//====================================================
+//   ViBe 样本匹配：按样本平面存储的样本库，逐行分类并更新前景计数
+//----------------------------------------------------
+//   ViBe Sample Matching: Sample Library in sample-plane-major layout, rows are classified
+// and the Foreground Counts updated
+//====================================================
+class ViBeMatchBench : public KernelBench
+{
+public:
+    ViBeMatchBench(const string &variant, Size size, int num_samples, ViBeClassifyRowFunc func)
+        : KernelBench("vibe_match", variant, size, num_samples), func(func)
+    {
+        RNG rng(1);
+        SyntheticImage(pix, size, CV_8UC1, rng);
+        plane_size = ((size_t)size.area() + 63) & ~(size_t)63;
+        sample_buf.resize(plane_size * num_samples);
+        for(int k = 0; k < num_samples; k++)
+            for(int i = 0; i < size.height; i++)
+                for(int j = 0; j < size.width; j++)
+                    sample_buf[k * plane_size + (size_t)i * size.width + j] = SampleNear(pix.at<uchar>(i, j), rng);
+        fg.create(size, CV_8UC1);
+        fore_num.assign(plane_size, 0);
+    }
+
+    void run()
+    {
+        for(int i = 0; i < size.height; i++)
+        {
+            size_t offset = (size_t)i * size.width;
+            func(pix.ptr<uchar>(i), &sample_buf[offset], plane_size, size.width, samples,
+                 MICROBENCH_VIBE_MIN_MATCHES, MICROBENCH_VIBE_RADIUS, fg.ptr<uchar>(i), &fore_num[offset]);
+        }
+    }
+
+private:
+    ViBeClassifyRowFunc func;
+    Mat pix, fg;
+    size_t plane_size;
+    vector<uchar> sample_buf;
+    vector<uchar> fore_num;
+};
+
+//====================================================
+//   ViBe+ 颜色畸变判定：RGB 模式的分类，灰度距离与颜色畸变同时满足才算匹配
+//----------------------------------------------------
+//   ViBe+ Color Distortion Test: classification in RGB mode, a match needs both the gray
+// distance and the color distortion
+//====================================================
+class ViBePlusColorBench : public KernelBench
+{
+public:
+    ViBePlusColorBench(const string &variant, Size size, int num_samples, bool scalar)
+        : KernelBench("vibeplus_color", variant, size, num_samples), scalar(scalar)
+    {
+        RNG rng(2);
+        SyntheticImage(bgr, size, CV_8UC3, rng);
+        cvtColor(bgr, gray, CV_BGR2GRAY);
+        plane_size = ((size_t)size.area() + 63) & ~(size_t)63;
+        sample_buf.resize(plane_size * num_samples);
+        sample_bgr.resize(plane_size * num_samples * 3);
+        sample_norm2.resize(plane_size * num_samples);
+        ada_threshold.resize(plane_size);
+        for(int i = 0; i < size.height; i++)
+        {
+            for(int j = 0; j < size.width; j++)
+            {
+                size_t idx = (size_t)i * size.width + j;
+                const uchar *p = bgr.ptr<uchar>(i) + 3 * j;
+                ada_threshold[idx] = (uchar)rng.uniform(ADA_THRESHOLD_MIN, ADA_THRESHOLD_MAX + 1);
+                for(int k = 0; k < num_samples; k++)
+                {
+                    int norm2 = 0;
+                    for(int c = 0; c < 3; c++)
+                    {
+                        uchar v = SampleNear(p[c], rng);
+                        sample_bgr[(3 * k + c) * plane_size + idx] = v;
+                        norm2 += v * v;
+                    }
+                    sample_norm2[k * plane_size + idx] = norm2;
+                    sample_buf[k * plane_size + idx] = SampleNear(gray.at<uchar>(i, j), rng);
+                }
+            }
+        }
+        seg.create(size, CV_8UC1);
+    }
+
+    void run()
+    {
+        for(int i = 0; i < size.height; i++)
+        {
+            size_t offset = (size_t)i * size.width;
+            if(scalar)
+                ViBePlusClassifyRowScalar(gray.ptr<uchar>(i), bgr.ptr<uchar>(i), &sample_buf[offset], &sample_bgr[offset],
+                                          &sample_norm2[offset], plane_size, size.width, samples, MICROBENCH_VIBE_MIN_MATCHES,
+                                          &ada_threshold[offset], seg.ptr<uchar>(i));
+            else
+                ViBePlusClassifyRow(gray.ptr<uchar>(i), bgr.ptr<uchar>(i), &sample_buf[offset], &sample_bgr[offset],
+                                    &sample_norm2[offset], plane_size, size.width, samples, MICROBENCH_VIBE_MIN_MATCHES,
+                                    &ada_threshold[offset], seg.ptr<uchar>(i));
+        }
+    }
+
+private:
+    bool scalar;
+    Mat bgr, gray, seg;
+    size_t plane_size;
+    vector<uchar> sample_buf;
+    vector<uchar> sample_bgr;
+    vector<int> sample_norm2;
+    vector<uchar> ada_threshold;
+};
+
+//====================================================
+//   ViBe+ 自适应阈值：由每个像素样本集的灰度和与平方和计算阈值
+//----------------------------------------------------
+//   ViBe+ Adaptive Threshold: the threshold of every pixel from Sum & Sum of Squares of its Sample Set
+//====================================================
+class AdaThresholdBench : public KernelBench
+{
+public:
+    AdaThresholdBench(Size size, int num_samples)
+        : KernelBench("ada_threshold", "lut", size, num_samples), vibeplus(num_samples)
+    {
+        RNG rng(3);
+        sum.resize(size.area());
+        sqsum.resize(size.area());
+        threshold.resize(size.area());
+        for(size_t idx = 0; idx < sum.size(); idx++)
+        {
+            int center = rng.uniform(0, 256), s = 0, sq = 0;
+            for(int k = 0; k < num_samples; k++)
+            {
+                int v = SampleNear(center, rng);
+                s += v;
+                sq += v * v;
+            }
+            sum[idx] = s;
+            sqsum[idx] = sq;
+        }
+    }
+
+    void run()
+    {
+        for(size_t idx = 0; idx < sum.size(); idx++)
+            threshold[idx] = (uchar)vibeplus.CalcuAdaThreshold(sum[idx], sqsum[idx]);
+    }
+
+private:
+    ViBePlus vibeplus;
+    vector<int> sum;
+    vector<int> sqsum;
+    vector<uchar> threshold;
+};
+
+/*===================================================================
+ * 类名：ViBePlusStageBench
+ * 说明：ViBe+ 邻域状态与闪烁等级更新：由位压缩分割模板计算改变状态的像素与闪烁等级；
+ *    ViBe+ 先以合成视频运行几帧，使分割模板与上一帧的分割模板都有效；
+ *    每次运行的输入不变（上一帧分割模板的交换不在此阶段中）；
+ *------------------------------------------------------------------
+ * Class: ViBePlusStageBench
+ *
+ * Summary:
+ *   ViBe+ Neighbour State & Blink Level Update: Changed Pixels & Blink Levels from the
+ * Bit-packed Segment Models.
+ *   ViBe+ runs a few frames of a synthetic video first, so the Segment Models of current
+ * and previous frames are both valid.
+ *   Every run has the same input (the swap of the previous Segment Model isn't in this stage).
+=====================================================================
+*/
+class ViBePlusStageBench : public KernelBench
+{
+public:
+    ViBePlusStageBench(Size size)
+        : KernelBench("blink_update", "bitpacked", size, 0)
+    {
+        RNG rng(4);
+        Mat background, frame;
+        SyntheticImage(background, size, CV_8UC1, rng);
+        vibeplus.setNumThreads(1);
+
+        // 静止背景上移动的方块，加上随机翻转的噪点
+        // A block moving over a static background, plus randomly flipping noise
+        int block = max(size.height / 6, 2);
+        for(int t = 0; t < 4; t++)
+        {
+            background.copyTo(frame);
+            int x0 = (t * block / 2) % max(size.width - block, 1);
+            for(int i = size.height / 3; i < min(size.height / 3 + block, size.height); i++)
+                for(int j = x0; j < min(x0 + block, size.width); j++)
+                    frame.at<uchar>(i, j) = (uchar)(255 - frame.at<uchar>(i, j));
+            for(int n = 0; n < size.area() / 50; n++)
+                frame.at<uchar>(rng.uniform(0, size.height), rng.uniform(0, size.width)) = (uchar)rng.uniform(0, 256);
+
+            vibeplus.FrameCapture(frame);
+            vibeplus.Run();
+        }
+        vibeplus.ExtractBG();
+    }
+
+    void run()
+    {
+        vibeplus.CalcuBlinkLevel();
+    }
+
+private:
+    ViBePlus vibeplus;
+};
+
+//====================================================
+//   Otsu 直方图：差分图像的 4 路子直方图统计与合并，或与差分融合的一次遍历
+//----------------------------------------------------
+//   Otsu Histogram: 4-way sub-histograms of the difference image and their merge, or fused
+// with the difference in one pass
+//====================================================
+class OtsuHistBench : public KernelBench
+{
+public:
+    OtsuHistBench(const string &variant, Size size, bool fused)
+        : KernelBench("otsu_hist", variant, size, 0), fused(fused)
+    {
+        RNG rng(5);
+        SyntheticImage(a, size, CV_8UC1, rng);
+        SyntheticImage(b, size, CV_8UC1, rng);
+        absdiff(a, b, diff);
+    }
+
+    void run()
+    {
+        memset(sub_hist, 0, sizeof(sub_hist));
+        for(int i = 0; i < size.height; i++)
+        {
+            if(fused)
+                BGDiffAbsDiffHistRow(a.ptr<uchar>(i), b.ptr<uchar>(i), size.width, diff.ptr<uchar>(i), sub_hist);
+            else
+                BGDiffHistRow(diff.ptr<uchar>(i), size.width, sub_hist);
+        }
+        BGDiffMergeHist(sub_hist, hist);
+    }
+
+private:
+    bool fused;
+    Mat a, b, diff;
+    int sub_hist[BGDIFF_SUB_HISTS * BGDIFF_HIST_SIZE];
+    int hist[BGDIFF_HIST_SIZE];
+};
+
+// BGDiff 背景更新方式
+// Background Update of BGDiff
+#define MICROBENCH_ACC_F32_GRAY   0
+#define MICROBENCH_ACC_F32_BGR    1
+#define MICROBENCH_ACC_Q8         2
+#define MICROBENCH_ACC_Q8_SCALAR  3
+
+//====================================================
+//   BGDiff 背景累积：一次遍历完成差分、直方图与背景滑动平均更新
+//----------------------------------------------------
+//   BGDiff Accumulate: Difference, Histogram & Background Running Average in one pass
+//====================================================
+class BGDiffAccumulateBench : public KernelBench
+{
+public:
+    BGDiffAccumulateBench(const string &variant, Size size, int mode)
+        : KernelBench("bgdiff_accumulate", variant, size, 0), mode(mode)
+    {
+        RNG rng(6);
+        SyntheticImage(src, size, mode == MICROBENCH_ACC_F32_BGR ? CV_8UC3 : CV_8UC1, rng);
+        Mat init_src;
+        SyntheticImage(init_src, size, src.type(), rng);
+        diff.create(size, CV_8UC1);
+        bg8.create(size, CV_8UC1);
+        bg_f32.create(size, CV_32FC1);
+        bg_q8.create(size, CV_16UC1);
+        for(int i = 0; i < size.height; i++)
+        {
+            if(mode == MICROBENCH_ACC_F32_GRAY || mode == MICROBENCH_ACC_F32_BGR)
+                BGDiffInitRowF32(init_src.ptr<uchar>(i), src.channels(), size.width, bg_f32.ptr<float>(i), bg8.ptr<uchar>(i));
+            else
+                BGDiffInitRowQ8(init_src.ptr<uchar>(i), 1, size.width, bg_q8.ptr<ushort>(i), bg8.ptr<uchar>(i));
+        }
+    }
+
+    void run()
+    {
+        // 更新速度 0.03，选择性更新关闭（gate 为 255）
+        // Update Speed 0.03, selective update off (gate is 255)
+        const float alpha = 0.03f;
+        const ushort alpha_q = (ushort)(alpha * (1 << BGDIFF_ALPHA_SHIFT) + 0.5f);
+        memset(sub_hist, 0, sizeof(sub_hist));
+        for(int i = 0; i < size.height; i++)
+        {
+            const uchar *s = src.ptr<uchar>(i);
+            uchar *d = diff.ptr<uchar>(i), *b8 = bg8.ptr<uchar>(i);
+            switch(mode)
+            {
+            case MICROBENCH_ACC_F32_GRAY:
+            case MICROBENCH_ACC_F32_BGR:
+                BGDiffAccumulateRowF32(s, src.channels(), size.width, alpha, alpha, 255, bg_f32.ptr<float>(i), d, b8, sub_hist);
+                break;
+            case MICROBENCH_ACC_Q8:
+                BGDiffAccumulateRowQ8(s, size.width, alpha_q, alpha_q, 255, bg_q8.ptr<ushort>(i), d, b8, sub_hist);
+                break;
+            default:
+                BGDiffAccumulateRowQ8Scalar(s, size.width, alpha_q, alpha_q, 255, bg_q8.ptr<ushort>(i), d, b8, sub_hist);
+                break;
+            }
+        }
+    }
+
+private:
+    int mode;
+    Mat src, diff, bg8, bg_f32, bg_q8;
+    int sub_hist[BGDIFF_SUB_HISTS * BGDIFF_HIST_SIZE];
+};
+
+//====================================================
+//   空洞填充：连通区域标记，填充小空洞并移除小斑点
+//----------------------------------------------------
+//   Hole Filling: Connected Region labeling, small holes filled & small blobs removed
+//====================================================
+class HoleFillingBench : public KernelBench
+{
+public:
+    HoleFillingBench(Size size)
+        : KernelBench("hole_filling", "runs", size, 0)
+    {
+        // 带有小空洞的前景方块，加上孤立的前景噪点
+        // Foreground blocks with small holes, plus isolated foreground noise
+        RNG rng(7);
+        mask = Mat::zeros(size, CV_8UC1);
+        int blocks = max(size.area() / 4000, 1);
+        for(int n = 0; n < blocks; n++)
+        {
+            int w = rng.uniform(4, 40), h = rng.uniform(4, 40);
+            int x0 = rng.uniform(0, size.width), y0 = rng.uniform(0, size.height);
+            for(int i = y0; i < min(y0 + h, size.height); i++)
+                for(int j = x0; j < min(x0 + w, size.width); j++)
+                    mask.at<uchar>(i, j) = 255;
+        }
+        for(int n = 0; n < size.area() / 100; n++)
+        {
+            uchar &p = mask.at<uchar>(rng.uniform(0, size.height), rng.uniform(0, size.width));
+            p = (uchar)(255 - p);
+        }
+        mask.copyTo(dst);
+    }
+
+    void run()
+    {
+        // 标记结果只由 mask 决定，重复填充 dst 的工作量相同
+        // Labels only depend on mask, so filling dst again is the same amount of work
+        regions.label(mask, 1);
+        regions.fill(dst, UPDATE_HOLE_AREA, SEG_BLOB_AREA);
+    }
+
+private:
+    Mat mask, dst;
+    ConnectedRegions regions;
+};
+
+// 一个测试用例的结果
+// Result of one test case
+struct KernelResult
+{
+    string kernel;
+    string variant;
+    Size size;
+    int samples;
+    double median_us;
+    double min_us;
+    double ns_per_pixel;
+    double mpix_per_s;
+};
+
+/*===================================================================
+ * 函数名：Measure
+ * 说明：预热之后运行 reps 次，取每次耗时的中位数与最小值；
+ * 参数：
+ *   KernelBench &bench:  测试用例
+ *   int reps:  计时的次数
+ * 返回值：KernelResult
+ *------------------------------------------------------------------
+ * Function: Measure
+ *
+ * Summary:
+ *   Run reps times after warming up, and take the median & the minimum of the times.
+ *
+ * Arguments:
+ *   KernelBench &bench - Test Case
+ *   int reps - timed runs
+ *
+ * Returns:
+ *   KernelResult
+=====================================================================
+*/
+static KernelResult Measure(KernelBench &bench, int reps)
+{
+    for(int r = 0; r < MICROBENCH_WARMUP; r++)
+        bench.run();
+
+    vector<double> times(reps);
+    for(int r = 0; r < reps; r++)
+    {
+        int64 start = getTickCount();
+        bench.run();
+        times[r] = (double)(getTickCount() - start) / getTickFrequency() * 1e6;
+    }
+    sort(times.begin(), times.end());
+
+    KernelResult result;
+    result.kernel = bench.kernel;
+    result.variant = bench.variant;
+    result.size = bench.size;
+    result.samples = bench.samples;
+    result.median_us = times[reps / 2];
+    result.min_us = times[0];
+    double pixels = (double)bench.size.area();
+    result.ns_per_pixel = result.median_us * 1000 / pixels;
+    result.mpix_per_s = result.median_us > 0 ? pixels / result.median_us : 0;
+    return result;
+}
+
+// 写出 JSON 结果
+// Write the JSON results
+static bool WriteJson(const string &file, int reps, const vector<KernelResult> &results)
+{
+    FILE *f = fopen(file.c_str(), "w");
+    if(f == NULL)
+        return false;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"benchmark\": \"bgsplit_microbench\",\n");
+    fprintf(f, "  \"reps\": %d,\n", reps);
+    fprintf(f, "  \"results\": [\n");
+    for(size_t k = 0; k < results.size(); k++)
+    {
+        const KernelResult &r = results[k];
+        fprintf(f, "    {\"kernel\": \"%s\", \"variant\": \"%s\", \"width\": %d, \"height\": %d, ",
+                r.kernel.c_str(), r.variant.c_str(), r.size.width, r.size.height);
+        if(r.samples > 0)
+            fprintf(f, "\"samples\": %d, ", r.samples);
+        else
+            fprintf(f, "\"samples\": null, ");
+        fprintf(f, "\"median_us\": %.3f, \"min_us\": %.3f, \"ns_per_pixel\": %.4f, \"mpix_per_s\": %.2f}%s\n",
+                r.median_us, r.min_us, r.ns_per_pixel, r.mpix_per_s, k + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// 按逗号分割
+// Split by commas
+static vector<string> SplitList(const string &s)
+{
+    vector<string> items;
+    stringstream ss(s);
+    string item;
+    while(getline(ss, item, ','))
+    {
+        if(!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+// 运行一个测试用例，输出一行结果并释放
+// Run one test case, print one line of result and release it
+static void RunCase(KernelBench *bench, int reps, vector<KernelResult> &results)
+{
+    KernelResult r = Measure(*bench, reps);
+    delete bench;
+    results.push_back(r);
+
+    cout << r.kernel << "/" << r.variant << " " << r.size.width << "x" << r.size.height;
+    if(r.samples > 0)
+        cout << " N=" << r.samples;
+    cout << ": " << r.median_us << "us, " << r.ns_per_pixel << "ns/pixel" << endl;
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: bgsplit_microbench [--sizes 160x120,...] [--samples 8,16,20,32] [--reps N] [--output file]" << endl
+         << "       [--kernels vibe_match,vibeplus_color,ada_threshold,blink_update,otsu_hist,bgdiff_accumulate,hole_filling]" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string sizes_arg = "160x120,640x480,1920x1080";
+    string samples_arg = "8,16,20,32";
+    string kernels_arg = "vibe_match,vibeplus_color,ada_threshold,blink_update,otsu_hist,bgdiff_accumulate,hole_filling";
+    string output = "bgsplit_microbench.json";
+    int reps = 30;
+
+    for(int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--sizes" && has_value)
+            sizes_arg = argv[++i];
+        else if(arg == "--samples" && has_value)
+            samples_arg = argv[++i];
+        else if(arg == "--kernels" && has_value)
+            kernels_arg = argv[++i];
+        else if(arg == "--reps" && has_value)
+            reps = max(atoi(argv[++i]), 1);
+        else if(arg == "--output" && has_value)
+            output = argv[++i];
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    vector<Size> sizes;
+    vector<string> size_items = SplitList(sizes_arg);
+    for(size_t k = 0; k < size_items.size(); k++)
+    {
+        int w = 0, h = 0;
+        if(sscanf(size_items[k].c_str(), "%dx%d", &w, &h) != 2 || w < 3 || h < 3)
+        {
+            cout << "ERROR: Bad size: " << size_items[k] << endl;
+            return -1;
+        }
+        sizes.push_back(Size(w, h));
+    }
+
+    // ViBe+ 的样本灰度和以 16 位存储，样本个数不能超过 257
+    // ViBe+ keeps the Sample Sums in 16 bits, so the Number of Samples must not exceed 257
+    vector<int> sample_counts;
+    vector<string> sample_items = SplitList(samples_arg);
+    for(size_t k = 0; k < sample_items.size(); k++)
+        sample_counts.push_back(min(max(atoi(sample_items[k].c_str()), 1), 257));
+
+    vector<string> kernels = SplitList(kernels_arg);
+    setNumThreads(1);
+
+    vector<KernelResult> results;
+    for(size_t n = 0; n < kernels.size(); n++)
+    {
+        const string &kernel = kernels[n];
+        for(size_t s = 0; s < sizes.size(); s++)
+        {
+            Size size = sizes[s];
+            if(kernel == "vibe_match")
+            {
+                for(size_t k = 0; k < sample_counts.size(); k++)
+                {
+                    int ns = sample_counts[k];
+                    RunCase(new ViBeMatchBench("simd", size, ns, &ViBeClassifyRow), reps, results);
+                    RunCase(new ViBeMatchBench("scalar", size, ns, &ViBeClassifyRowScalar), reps, results);
+                    ViBeClassifyRowFunc specialized = ViBeSelectClassifyRow(ns, MICROBENCH_VIBE_MIN_MATCHES);
+                    if(specialized != &ViBeClassifyRow)
+                        RunCase(new ViBeMatchBench("specialized", size, ns, specialized), reps, results);
+                }
+            }
+            else if(kernel == "vibeplus_color")
+            {
+                for(size_t k = 0; k < sample_counts.size(); k++)
+                {
+                    RunCase(new ViBePlusColorBench("simd", size, sample_counts[k], false), reps, results);
+                    RunCase(new ViBePlusColorBench("scalar", size, sample_counts[k], true), reps, results);
+                }
+            }
+            else if(kernel == "ada_threshold")
+            {
+                for(size_t k = 0; k < sample_counts.size(); k++)
+                    RunCase(new AdaThresholdBench(size, sample_counts[k]), reps, results);
+            }
+            else if(kernel == "blink_update")
+                RunCase(new ViBePlusStageBench(size), reps, results);
+            else if(kernel == "otsu_hist")
+            {
+                RunCase(new OtsuHistBench("hist", size, false), reps, results);
+                RunCase(new OtsuHistBench("absdiff_hist", size, true), reps, results);
+            }
+            else if(kernel == "bgdiff_accumulate")
+            {
+                RunCase(new BGDiffAccumulateBench("f32_gray", size, MICROBENCH_ACC_F32_GRAY), reps, results);
+                RunCase(new BGDiffAccumulateBench("f32_bgr", size, MICROBENCH_ACC_F32_BGR), reps, results);
+                RunCase(new BGDiffAccumulateBench("q8", size, MICROBENCH_ACC_Q8), reps, results);
+                RunCase(new BGDiffAccumulateBench("q8_scalar", size, MICROBENCH_ACC_Q8_SCALAR), reps, results);
+            }
+            else if(kernel == "hole_filling")
+                RunCase(new HoleFillingBench(size), reps, results);
+            else
+            {
+                cout << "ERROR: Unknown kernel: " << kernel << endl;
+                return -1;
+            }
+        }
+    }
+
+    if(!WriteJson(output, reps, results))
+    {
+        cout << "ERROR: Can't write " << output << endl;
+        return -1;
+    }
+    cout << "Results written to " << output << endl;
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*=================================================================
+ * Common Background Subtractor Interface of the Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include <cstring>
+#include "BGSplitSubtractor.h"
+
+BGSplitSubtractor::BGSplitSubtractor()
+{
+    memset(&frame_stats, 0, sizeof(frame_stats));
+}
+
+/*===================================================================
+ * 函数名：apply
+ * 说明：处理一帧，输出前景模板，并更新耗时与前景占比统计；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ *   Mat &mask:  输出前景模板，CV_8UC1，只读，下一次 apply 之前有效
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: apply
+ *
+ * Summary:
+ *   Process one Frame, output the Foreground Mask, and update the statistics of time
+ * & foreground ratio.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *   Mat &mask - output Foreground Mask, CV_8UC1, read-only and valid until the next apply
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGSplitSubtractor::apply(const FrameView &frame, Mat &mask)
+{
+    int64 start = getTickCount();
+    process(frame, mask);
+    double time = (double)(getTickCount() - start) / getTickFrequency() * 1000;
+
+    frame_stats.frames++;
+    frame_stats.last_ms = time;
+    frame_stats.total_ms += time;
+    if(time > frame_stats.max_ms)
+        frame_stats.max_ms = time;
+    frame_stats.fg_ratio = mask.empty() ? 0 : (double)countNonZero(mask) / mask.total();
+}
+
+void BGSplitSubtractor::apply(Mat frame, Mat &mask)
+{
+    apply(MakeFrameView(frame), mask);
+}
+
+/*===================================================================
+ * 函数名：reset
+ * 说明：清除模型与统计，下一帧重新开始；
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: reset
+ *
+ * Summary:
+ *   Clear the model & statistics, start again on the next frame.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGSplitSubtractor::reset()
+{
+    resetModel();
+    memset(&frame_stats, 0, sizeof(frame_stats));
+}
+
+/*===================================================================
+ * 函数名：stats
+ * 说明：获取运行统计；
+ * 返回值：const SubtractorStats &
+ *------------------------------------------------------------------
+ * Function: stats
+ *
+ * Summary:
+ *   Get Running Statistics.
+ *
+ * Returns:
+ *   const SubtractorStats &
+=====================================================================
+*/
+const SubtractorStats &BGSplitSubtractor::stats() const
+{
+    return frame_stats;
+}
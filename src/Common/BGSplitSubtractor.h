@@ -0,0 +1,116 @@
+/*=================================================================
+ * Common Background Subtractor Interface of the Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef BGSPLITSUBTRACTOR_H
+#define BGSPLITSUBTRACTOR_H
+
+#include "opencv2/opencv.hpp"
+#include "FrameView.h"
+
+using namespace cv;
+
+/*===================================================================
+ * 结构体：SubtractorStats
+ * 说明：背景分割算法的运行统计，由 BGSplitSubtractor::apply 更新；
+ *------------------------------------------------------------------
+ * Struct: SubtractorStats
+ *
+ * Summary:
+ *   Running Statistics of a Background Split Algorithm, updated by BGSplitSubtractor::apply.
+=====================================================================
+*/
+struct SubtractorStats
+{
+    // 已处理的帧数
+    // Number of processed frames
+    int64 frames;
+
+    // 最近一帧、累计与最大的处理耗时（毫秒），只计 process，不含前景占比的统计
+    // Processing time of the last frame, in total & at most (ms), of process only, without the foreground ratio
+    double last_ms;
+    double total_ms;
+    double max_ms;
+
+    // 最近一帧前景像素的占比
+    // Ratio of foreground pixels in the last frame
+    double fg_ratio;
+};
+
+/*===================================================================
+ * 类名：BGSplitSubtractor
+ * 说明：各背景分割算法的公共接口，使不同摄像头可以选用不同算法，并在相同条件下比较；
+ *    apply 计时并统计，实际的分割由派生类的 process 完成；
+ *    输出的前景模板为 CV_8UC1，前景为 255，可能引用算法内部的模板，只读，下一次 apply 之前有效；
+ *------------------------------------------------------------------
+ * Class: BGSplitSubtractor
+ *
+ * Summary:
+ *   Common Interface of the Background Split Algorithms, so each camera can use its own
+ * algorithm and the algorithms can be compared on equal terms.
+ *   apply times and counts, the real split is done by process of the derived class.
+ *   The output foreground mask is CV_8UC1 with 255 for foreground. It may reference the
+ * algorithm's internal mask, so it is read-only and valid until the next apply.
+=====================================================================
+*/
+class BGSplitSubtractor
+{
+public:
+    BGSplitSubtractor();
+    virtual ~BGSplitSubtractor() {}
+
+    // 处理一帧，输出前景模板
+    // Process one Frame, output the Foreground Mask
+    void apply(const FrameView &frame, Mat &mask);
+
+    // 处理一帧 Mat 图像（灰度或 BGR），输出前景模板
+    // Process one Mat Frame (gray or BGR), output the Foreground Mask
+    void apply(Mat frame, Mat &mask);
+
+    // 当前背景图像，基于样本的模型没有单一的背景图像时为空
+    // Current Background Image, empty when a sample-based model has no single background image
+    virtual Mat background() = 0;
+
+    // 算法名称
+    // Name of the Algorithm
+    virtual const char *name() const = 0;
+
+    // 清除模型与统计，下一帧重新开始
+    // Clear the model & statistics, start again on the next frame
+    void reset();
+
+    // 获取运行统计
+    // Get Running Statistics
+    const SubtractorStats &stats() const;
+
+protected:
+    // 分割一帧，由派生类实现
+    // Split one Frame, implemented by the derived class
+    virtual void process(const FrameView &frame, Mat &mask) = 0;
+
+    // 清除模型，由派生类实现
+    // Clear the model, implemented by the derived class
+    virtual void resetModel() = 0;
+
+private:
+    SubtractorStats frame_stats;
+};
+
+#endif // BGSPLITSUBTRACTOR_H
@@ -0,0 +1,143 @@
+/*=================================================================
+ * Bit-packed Binary Mask for Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef BITMASK_H
+#define BITMASK_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+using namespace std;
+
+/*===================================================================
+ * 类名：BitMask
+ * 说明：每个像素 1 bit 的二值模板，每行按 64 位字存储；
+ *    第 w 个字的第 b 位对应第 64 * w + b 列，行尾的填充位始终为0；
+ *    邻域运算以整字的移位与掩码完成，一次处理 64 个像素；
+ *------------------------------------------------------------------
+ * Class: BitMask
+ *
+ * Summary:
+ *   Binary Mask of 1 bit per pixel, every row is stored as 64-bit words.
+ *   Bit b of word w is column 64 * w + b, the padding bits at the end of a row are always 0.
+ *   Neighbourhood operations are done by whole-word shifts and masks, 64 pixels at a time.
+=====================================================================
+*/
+class BitMask
+{
+public:
+    BitMask() : rows(0), cols(0), words(0)
+    {
+    }
+
+    // 分配 rows * cols 的模板，并全部置0
+    // Assign a rows * cols mask and set all bits as 0
+    void create(int r, int c)
+    {
+        rows = r;
+        cols = c;
+        words = (c + 63) >> 6;
+        bits.assign((size_t)rows * words, 0);
+    }
+
+    // 全部置0
+    // Set all bits as 0
+    void setZero()
+    {
+        bits.assign(bits.size(), 0);
+    }
+
+    // 第 i 行首字地址
+    // Address of the first word of row i
+    uint64 *row(int i)
+    {
+        return &bits[(size_t)i * words];
+    }
+    const uint64 *row(int i) const
+    {
+        return &bits[(size_t)i * words];
+    }
+
+    // 读取 (i, j) 位
+    // Read bit (i, j)
+    bool get(int i, int j) const
+    {
+        return (row(i)[j >> 6] >> (j & 63)) & 1;
+    }
+
+    // 第 i 行 [j_begin, j_end) 列中是否有为1的位
+    // Whether there is a bit of 1 in columns [j_begin, j_end) of row i
+    bool any(int i, int j_begin, int j_end) const
+    {
+        if(j_begin >= j_end)
+            return false;
+        const uint64 *r = row(i);
+        int w_begin = j_begin >> 6, w_end = (j_end - 1) >> 6;
+        uint64 head = ~(uint64)0 << (j_begin & 63);
+        uint64 tail = ~(uint64)0 >> (63 - ((j_end - 1) & 63));
+        if(w_begin == w_end)
+            return (r[w_begin] & head & tail) != 0;
+        if(r[w_begin] & head)
+            return true;
+        for(int w = w_begin + 1; w < w_end; w++)
+            if(r[w])
+                return true;
+        return (r[w_end] & tail) != 0;
+    }
+
+    // 交换两个模板的数据
+    // Swap data of two masks
+    void swap(BitMask &other)
+    {
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(words, other.words);
+        bits.swap(other.bits);
+    }
+
+    // 第 i 行第 w 个字的八邻域并集：对应位为1表示该像素的八邻域中至少有一个像素为1，要求 1 <= i <= rows - 2
+    // Union of 8 neighbours of word w in row i: a bit is 1 if at least one of the pixel's 8 neighbours is 1, requires 1 <= i <= rows - 2
+    uint64 neighbours8(int i, int w) const
+    {
+        const uint64 *up = row(i - 1), *mid = row(i), *down = row(i + 1);
+
+        // 上下两行的三列与当前行的左右两列
+        // Three columns of the rows above & below, and left & right columns of current row
+        uint64 vert = up[w] | down[w];
+        uint64 all = vert | mid[w];
+        uint64 left = all << 1, right = all >> 1;
+        if(w > 0)
+            left |= (up[w - 1] | mid[w - 1] | down[w - 1]) >> 63;
+        if(w + 1 < words)
+            right |= (up[w + 1] | mid[w + 1] | down[w + 1]) << 63;
+        return vert | left | right;
+    }
+
+    // 模板的行数、列数，以及每行的字数
+    // Rows & Columns of the mask, and Words of every row
+    int rows, cols, words;
+
+private:
+    vector<uint64> bits;
+};
+
+#endif // BITMASK_H
@@ -0,0 +1,601 @@
+/*=================================================================
+ * Run-length Connected Region Labeling of Binary Masks for Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "ConnectedRegions.h"
+
+/*===================================================================
+ * 类名：ConnectedRegionsInvoker
+ * 说明：在 OpenCV 线程池中并行标记行条带；
+ *------------------------------------------------------------------
+ * Class: ConnectedRegionsInvoker
+ *
+ * Summary:
+ *   Label Row Bands in parallel on OpenCV's thread pool.
+=====================================================================
+*/
+class ConnectedRegionsInvoker : public ParallelLoopBody
+{
+public:
+    ConnectedRegionsInvoker(ConnectedRegions *r, const Mat &m)
+        : regions(r), mask(m)
+    {
+    }
+
+    void operator()(const Range &range) const
+    {
+        for(int b = range.start; b < range.end; b++)
+            ConnectedRegions::labelBand(mask, regions->bands[b]);
+    }
+
+private:
+    ConnectedRegions *regions;
+    Mat mask;
+};
+
+/*===================================================================
+ * 函数名：label
+ * 说明：标记二值模板的连通区域；
+ *    图像被划分为 nbands 个行条带并行标记，再按条带顺序拼接，并合并条带边界两侧连通的行程；
+ *    扫描结束后把每个行程的标记替换为根，并在根上累加边界标志，最后计算区域的层级与轮廓面积；
+ * 参数：
+ *   const Mat &mask:  二值模板，CV_8UC1，非0为前景
+ *   int nbands:  行条带个数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: label
+ *
+ * Summary:
+ *   Label the Connected Regions of a binary mask.
+ *   The image is split into nbands row bands labeled in parallel, which are then joined in
+ * band order, and the connected runs on both sides of every band border are merged.
+ *   After that every run's label is replaced by its root, the Border Flags are accumulated
+ * on the roots, and finally the Levels & contour Areas of the regions are computed.
+ *
+ * Arguments:
+ *   const Mat &mask - binary mask, CV_8UC1, non-zero is Foreground
+ *   int nbands - Number of Row Bands
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::label(const Mat &mask, int nbands)
+{
+    nbands = max(1, min(nbands, mask.rows));
+    bands.resize(nbands);
+    for(int b = 0; b < nbands; b++)
+    {
+        bands[b].row_begin = (int)((int64)mask.rows * b / nbands);
+        bands[b].row_end = (int)((int64)mask.rows * (b + 1) / nbands);
+    }
+
+    if(nbands == 1)
+    {
+        // 单个条带直接交换到结果中，不拷贝
+        // A single band is swapped into the result without copying
+        labelBand(mask, bands[0]);
+        runs.swap(bands[0].runs);
+        parent.swap(bands[0].parent);
+        border.swap(bands[0].border);
+    }
+    else
+    {
+        parallel_for_(Range(0, nbands), ConnectedRegionsInvoker(this, mask));
+
+        //==================================
+        //    拼接各条带，条带内的标记加上条带的起始编号
+        //----------------------------------------------
+        //   Join the bands, labels in a band are offset by the first index of the band
+        //==================================
+        runs.clear();
+        parent.clear();
+        border.clear();
+        for(int b = 0; b < nbands; b++)
+        {
+            const RegionBand &band = bands[b];
+            int offset = (int)runs.size();
+            runs.insert(runs.end(), band.runs.begin(), band.runs.end());
+            border.insert(border.end(), band.border.begin(), band.border.end());
+            for(size_t k = 0; k < band.parent.size(); k++)
+                parent.push_back(band.parent[k] + offset);
+
+            //==================================
+            //    合并条带边界两侧连通的行程
+            //----------------------------------------------
+            //   Merge the connected runs on both sides of the band border
+            //==================================
+            if(b > 0)
+            {
+                const RegionBand &prev = bands[b - 1];
+                int prev_offset = offset - (int)prev.runs.size();
+                mergeRows(runs, parent, prev_offset + prev.last_row_begin, offset,
+                          offset, offset + band.first_row_end);
+            }
+        }
+    }
+
+    //==================================
+    //    以根为标记，在根上累加边界标志，并记录各行首个行程
+    //----------------------------------------------
+    //   Use the roots as labels, accumulate Border Flag on the roots, and record the first run of every row
+    //==================================
+    row_start.assign(mask.rows + 1, (int)runs.size());
+    for(int k = (int)runs.size() - 1; k >= 0; k--)
+        row_start[runs[k].row] = k;
+    for(int k = 0; k < (int)runs.size(); k++)
+    {
+        int root = find(parent, k);
+        if(root != k)
+            border[root] |= border[k];
+        parent[k] = root;
+    }
+
+    measure(mask.rows, mask.cols);
+}
+
+/*===================================================================
+ * 函数名：labelBand
+ * 说明：标记一个行条带；
+ *    逐行把像素分解为前景段与背景段，并与上一行的同值段合并；
+ * 参数：
+ *   const Mat &mask:  二值模板，CV_8UC1，非0为前景
+ *   RegionBand &band:  行条带，行范围已经设置
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: labelBand
+ *
+ * Summary:
+ *   Label one Row Band.
+ *   Every row is split into Foreground Runs & Background Runs, and each run is merged with
+ * the runs of the same value in the previous row.
+ *
+ * Arguments:
+ *   const Mat &mask - binary mask, CV_8UC1, non-zero is Foreground
+ *   RegionBand &band - Row Band whose row range is set
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::labelBand(const Mat &mask, RegionBand &band)
+{
+    band.runs.clear();
+    band.parent.clear();
+    band.border.clear();
+    band.first_row_end = band.last_row_begin = 0;
+
+    int prev_begin = 0;
+    for(int i = band.row_begin; i < band.row_end; i++)
+    {
+        const uchar *p = mask.ptr<uchar>(i);
+        int cur_begin = (int)band.runs.size();
+
+        //==================================
+        //         行程编码
+        //----------------------------------------------
+        //   Run-length Encoding
+        //==================================
+        for(int j = 0; j < mask.cols; )
+        {
+            RegionRun run;
+            run.row = i;
+            run.begin = j;
+            run.fore = p[j] != 0;
+            while(j < mask.cols && (p[j] != 0) == run.fore)
+                j++;
+            run.end = j;
+
+            band.parent.push_back((int)band.runs.size());
+            band.border.push_back(i == 0 || i == mask.rows - 1 || run.begin == 0 || run.end == mask.cols);
+            band.runs.push_back(run);
+        }
+
+        //==================================
+        //      与上一行的同值段合并
+        //----------------------------------------------
+        //   Merge with the Runs of the same value in the previous row
+        //==================================
+        if(i > band.row_begin)
+            mergeRows(band.runs, band.parent, prev_begin, cur_begin, cur_begin, (int)band.runs.size());
+        else
+            band.first_row_end = (int)band.runs.size();
+        prev_begin = cur_begin;
+    }
+    band.last_row_begin = prev_begin;
+}
+
+/*===================================================================
+ * 函数名：mergeRows
+ * 说明：合并相邻两行中连通的同值行程：
+ *    - 前景段八连通，列范围相交或对角相邻即连通；
+ *    - 背景段四连通，列范围相交才连通；
+ * 参数：
+ *   const vector<RegionRun> &runs:  行程
+ *   vector<int> &parent:  并查集
+ *   int prev_begin, prev_end:  上一行的行程范围
+ *   int cur_begin, cur_end:  当前行的行程范围
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: mergeRows
+ *
+ * Summary:
+ *   Merge the connected runs of the same value in two adjacent rows:
+ *    - Foreground Runs are 8-connected, they connect if their column ranges overlap or touch diagonally;
+ *    - Background Runs are 4-connected, they connect only if their column ranges overlap.
+ *
+ * Arguments:
+ *   const vector<RegionRun> &runs - runs
+ *   vector<int> &parent - union-find
+ *   int prev_begin, prev_end - run range of the previous row
+ *   int cur_begin, cur_end - run range of current row
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::mergeRows(const vector<RegionRun> &runs, vector<int> &parent,
+                                 int prev_begin, int prev_end, int cur_begin, int cur_end)
+{
+    int q_begin = prev_begin;
+    for(int k = cur_begin; k < cur_end; k++)
+    {
+        const RegionRun &run = runs[k];
+
+        // 跳过已经在当前段左侧、连对角也不相邻的段
+        // Skip the runs left of current run which do not even touch it diagonally
+        while(q_begin < prev_end && runs[q_begin].end < run.begin)
+            q_begin++;
+
+        for(int q = q_begin; q < prev_end && runs[q].begin <= run.end; q++)
+        {
+            if(runs[q].fore != run.fore)
+                continue;
+            if(run.fore || (runs[q].begin < run.end && runs[q].end > run.begin))
+                merge(parent, q, k);
+        }
+    }
+}
+
+/*===================================================================
+ * 函数名：measure
+ * 说明：计算各区域的层级，及 0 级斑点与 1 级空洞的轮廓面积；
+ *    合并时以编号较小的根为新根，故根即为区域按行优先顺序的首个行程；
+ *    前景区域首个行程左侧的背景段（在行首时为外部）即包含它的背景区域；
+ *    背景空洞首个行程上方的前景像素即包含它的前景区域（不与边界相接，故上方一定有前景）；
+ *    包含者的根编号更小，因此按编号顺序一次遍历即可得到所有层级；
+ *    轮廓经过边界像素的中心，故斑点面积 = 像素个数 - 边界修正，空洞面积 = 像素个数 + 边界修正，
+ * 像素个数包含其内部的全部区域，边界修正对每个 2x2 窗口按其中属于该区域的角数 k 累加
+ * k = 1, 2, 3 时的 1/4, 1/2, 1/4；窗口只在两行的行程端点处需要逐个计算，其间为整段；
+ * 参数：
+ *   int rows:  模板行数
+ *   int cols:  模板列数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: measure
+ *
+ * Summary:
+ *   Compute the Level of every region, and the contour Area of level 0 blobs & level 1 holes.
+ *   Merging keeps the smaller root, so the root is the first run of the region in row-major order.
+ *   The background run left of the first run of a foreground region (outside when it starts
+ * the row) is the background region containing it.
+ *   The foreground pixel above the first run of a hole is the foreground region containing it
+ * (a hole does not touch the border, so there always is one).
+ *   The container has the smaller root, so one pass in index order gives all levels.
+ *   The contours pass the centres of the border pixels, so blob area = pixel count - border correction,
+ * hole area = pixel count + border correction. The pixel count includes every region inside,
+ * and the border correction adds 1/4, 1/2, 1/4 for each 2x2 window with k = 1, 2, 3 of its
+ * corners in the region. Windows only have to be visited one by one at the run ends of the two
+ * rows, between them they are taken as a whole span.
+ *
+ * Arguments:
+ *   int rows - rows of the mask
+ *   int cols - columns of the mask
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::measure(int rows, int cols)
+{
+    int n = (int)runs.size();
+    level.resize(n);
+    blob.resize(n);
+    hole.resize(n);
+    area4.resize(n);
+
+    //==================================
+    //    按编号顺序计算各区域的层级及所在的斑点与空洞
+    //----------------------------------------------
+    //   Levels and the containing Blob & Hole of every region, in index order
+    //==================================
+    for(int k = 0; k < n; k++)
+    {
+        if(parent[k] != k)
+            continue;
+
+        const RegionRun &run = runs[k];
+        int outer = -1;
+        if(run.fore)
+        {
+            if(run.begin > 0)
+                outer = parent[k - 1];
+            level[k] = (outer < 0 || level[outer] < 0) ? 0 : level[outer] + 1;
+        }
+        else if(border[k])
+            level[k] = -1;
+        else
+        {
+            // 上一行中包含 run.begin 列的行程
+            // the run of the previous row which covers column run.begin
+            int lo = row_start[run.row - 1], hi = row_start[run.row] - 1;
+            while(lo < hi)
+            {
+                int mid = (lo + hi + 1) >> 1;
+                if(runs[mid].begin <= run.begin)
+                    lo = mid;
+                else
+                    hi = mid - 1;
+            }
+            outer = parent[lo];
+            level[k] = level[outer] + 1;
+        }
+
+        blob[k] = level[k] < 0 ? -1 : level[k] == 0 ? k : blob[outer];
+        hole[k] = level[k] < 1 ? -1 : level[k] == 1 ? k : hole[outer];
+        area4[k] = 0;
+    }
+
+    //==================================
+    //    像素个数，含内部的全部区域
+    //----------------------------------------------
+    //   Pixel Counts, including every region inside
+    //==================================
+    for(int k = 0; k < n; k++)
+    {
+        int root = parent[k];
+        int len4 = (runs[k].end - runs[k].begin) * 4;
+        if(blob[root] >= 0)
+            area4[blob[root]] += len4;
+        if(hole[root] >= 0)
+            area4[hole[root]] += len4;
+    }
+
+    //==================================
+    //    逐对相邻行累加边界修正，图像外部为 -1
+    //----------------------------------------------
+    //   Border Corrections row pair by row pair, the outside of the image is -1
+    //==================================
+    for(int i = -1; i < rows; i++)
+    {
+        int a = i >= 0 ? row_start[i] : -1;
+        int b = i + 1 < rows ? row_start[i + 1] : -1;
+        int blob_a = -1, hole_a = -1, blob_b = -1, hole_b = -1;
+        for(int j = 0; ; )
+        {
+            int prev_blob_a = blob_a, prev_hole_a = hole_a, prev_blob_b = blob_b, prev_hole_b = hole_b;
+            blob_a = a >= 0 ? blob[parent[a]] : -1;
+            hole_a = a >= 0 ? hole[parent[a]] : -1;
+            blob_b = b >= 0 ? blob[parent[b]] : -1;
+            hole_b = b >= 0 ? hole[parent[b]] : -1;
+
+            // 跨越 j - 1 与 j 列的窗口
+            // the window across columns j - 1 & j
+            addWindow(prev_blob_a, blob_a, prev_blob_b, blob_b);
+            addWindow(prev_hole_a, hole_a, prev_hole_b, hole_b);
+
+            // 两行都不变的整段，每个窗口上下两行各有两个角
+            // the span where neither row changes, every window has two corners in each row
+            int end = min(a >= 0 ? runs[a].end : cols, b >= 0 ? runs[b].end : cols);
+            int span = end - j - 1;
+            if(span > 0 && blob_a != blob_b)
+            {
+                if(blob_a >= 0)
+                    area4[blob_a] -= 2 * span;
+                if(blob_b >= 0)
+                    area4[blob_b] -= 2 * span;
+            }
+            if(span > 0 && hole_a != hole_b)
+            {
+                if(hole_a >= 0)
+                    area4[hole_a] += 2 * span;
+                if(hole_b >= 0)
+                    area4[hole_b] += 2 * span;
+            }
+
+            j = end;
+            if(j == cols)
+            {
+                addWindow(blob_a, -1, blob_b, -1);
+                addWindow(hole_a, -1, hole_b, -1);
+                break;
+            }
+            if(a >= 0 && runs[a].end == j)
+                a++;
+            if(b >= 0 && runs[b].end == j)
+                b++;
+        }
+    }
+}
+
+/*===================================================================
+ * 函数名：addWindow
+ * 说明：在轮廓面积上累加一个 2x2 窗口的边界修正；
+ *    窗口中属于同一区域的角数 k = 1, 2, 3 时修正为 1/4, 1/2, 1/4（以 4 倍面积计为 1, 2, 1），
+ * 斑点减去修正，空洞加上修正；
+ * 参数：
+ *   int tl, tr, bl, br:  左上、右上、左下、右下角所在的斑点或空洞，-1 表示不计
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: addWindow
+ *
+ * Summary:
+ *   Add the border correction of one 2x2 window to the contour Areas.
+ *   With k = 1, 2, 3 corners in the same region the correction is 1/4, 1/2, 1/4 (1, 2, 1 in
+ * 4 times the area). It is subtracted from blobs and added to holes.
+ *
+ * Arguments:
+ *   int tl, tr, bl, br - Blob or Hole of the top-left, top-right, bottom-left & bottom-right corner, -1 is not counted
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::addWindow(int tl, int tr, int bl, int br)
+{
+    static const int correction4[5] = {0, 1, 2, 1, 0};
+    const int corner[4] = {tl, tr, bl, br};
+    for(int m = 0; m < 4; m++)
+    {
+        int t = corner[m];
+        if(t < 0 || (m > 0 && t == corner[0]) || (m > 1 && t == corner[1]) || (m > 2 && t == corner[2]))
+            continue;
+        int k = (t == tl) + (t == tr) + (t == bl) + (t == br);
+        area4[t] += runs[t].fore ? -correction4[k] : correction4[k];
+    }
+}
+
+/*===================================================================
+ * 函数名：fill
+ * 说明：按行程移除小的前景斑点，并填充小的前景空洞，与 findContours 之后逐轮廓 drawContours 的结果相同：
+ *    - 轮廓面积小于 min_blob_area 的 0 级斑点连同其内部全部区域置 0；
+ *    - 轮廓面积不超过 max_hole_area 的 1 级空洞连同其内部全部区域置 255；
+ *    - 空洞所在斑点被移除时，空洞轮廓经过的前景像素（与空洞四邻接）也置 255，与先移除斑点、再填充空洞
+ * 多边形的结果一致；
+ * 参数：
+ *   Mat &dst:  输出模板，CV_8UC1，与标记的模板尺寸相同
+ *   int max_hole_area:  被填充前景空洞的最大轮廓面积
+ *   int min_blob_area:  保留的前景斑点的最小轮廓面积
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: fill
+ *
+ * Summary:
+ *   Remove small Foreground Blobs and fill small Foreground Holes run by run, with the same
+ * result as drawContours on each contour after findContours:
+ *    - a level 0 blob whose contour Area is less than min_blob_area is set as 0 with every region inside;
+ *    - a level 1 hole whose contour Area is not larger than max_hole_area is set as 255 with every region inside;
+ *    - when the blob of a filled hole is removed, the foreground pixels its contour passes
+ *      (4-adjacent to the hole) are set as 255 too, as removing the blob and then filling the
+ *      hole polygon does.
+ *
+ * Arguments:
+ *   Mat &dst - output mask, CV_8UC1, the same size as the labeled mask
+ *   int max_hole_area - Max contour Area of the Foreground Holes to fill
+ *   int min_blob_area - Min contour Area of the Foreground Blobs to keep
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::fill(Mat &dst, int max_hole_area, int min_blob_area) const
+{
+    for(size_t k = 0; k < runs.size(); k++)
+    {
+        const RegionRun &run = runs[k];
+        int b = blob[parent[k]];
+        if(b >= 0 && area4[b] < min_blob_area * 4)
+            memset(dst.ptr<uchar>(run.row) + run.begin, 0, run.end - run.begin);
+    }
+
+    for(size_t k = 0; k < runs.size(); k++)
+    {
+        const RegionRun &run = runs[k];
+        int root = parent[k];
+        int h = hole[root];
+        if(h < 0 || area4[h] > max_hole_area * 4)
+            continue;
+
+        if(root == h && area4[blob[h]] < min_blob_area * 4)
+        {
+            // 空洞不与图像边界相接，四邻接的像素都在图像内
+            // A hole does not touch the image border, so its 4-adjacent pixels are inside the image
+            memset(dst.ptr<uchar>(run.row - 1) + run.begin, 255, run.end - run.begin);
+            memset(dst.ptr<uchar>(run.row) + run.begin - 1, 255, run.end - run.begin + 2);
+            memset(dst.ptr<uchar>(run.row + 1) + run.begin, 255, run.end - run.begin);
+        }
+        else
+            memset(dst.ptr<uchar>(run.row) + run.begin, 255, run.end - run.begin);
+    }
+}
+
+/*===================================================================
+ * 函数名：find
+ * 说明：查找行程所在区域的根，以路径减半压缩路径；
+ * 参数：
+ *   vector<int> &parent:  并查集
+ *   int x:  行程编号
+ * 返回值：int
+ *------------------------------------------------------------------
+ * Function: find
+ *
+ * Summary:
+ *   Find the root of the region of a run, and compress the path by path halving.
+ *
+ * Arguments:
+ *   vector<int> &parent - union-find
+ *   int x - index of the run
+ *
+ * Returns:
+ *   int
+=====================================================================
+*/
+int ConnectedRegions::find(vector<int> &parent, int x)
+{
+    while(parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/*===================================================================
+ * 函数名：merge
+ * 说明：合并两个行程所在的区域；
+ * 参数：
+ *   vector<int> &parent:  并查集
+ *   int a:  行程编号
+ *   int b:  行程编号
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: merge
+ *
+ * Summary:
+ *   Merge the regions of two runs.
+ *
+ * Arguments:
+ *   vector<int> &parent - union-find
+ *   int a - index of a run
+ *   int b - index of a run
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ConnectedRegions::merge(vector<int> &parent, int a, int b)
+{
+    a = find(parent, a);
+    b = find(parent, b);
+    if(a < b)
+        parent[b] = a;
+    else if(b < a)
+        parent[a] = b;
+}
@@ -0,0 +1,172 @@
+/*=================================================================
+ * Run-length Connected Region Labeling of Binary Masks for Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef CONNECTEDREGIONS_H
+#define CONNECTEDREGIONS_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+using namespace std;
+
+// 二值模板一行中连续的同值像素段
+// Run of consecutive pixels of the same value in one row of a binary mask
+struct RegionRun
+{
+    // 所在行，及列范围 [begin, end)
+    // Row, and Column Range [begin, end)
+    int row, begin, end;
+
+    // 前景段为1，背景段为0
+    // 1 for Foreground Run, 0 for Background Run
+    int fore;
+};
+
+// 一个行条带的行程与并查集，条带内的标记从0开始
+// Runs & Union-find of one Row Band, labels in the band start from 0
+struct RegionBand
+{
+    // 条带的行范围 [row_begin, row_end)
+    // Row Range of the band [row_begin, row_end)
+    int row_begin, row_end;
+
+    // 条带首行的行程个数，及末行首个行程的编号
+    // Run Number of the first row of the band, and Index of the first run of the last row
+    int first_row_end, last_row_begin;
+
+    // 条带的行程、并查集与边界标志，含义与 ConnectedRegions 中相同
+    // Runs, Union-find & Border Flags of the band, the same meaning as in ConnectedRegions
+    vector<RegionRun> runs;
+    vector<int> parent;
+    vector<uchar> border;
+};
+
+/*===================================================================
+ * 类名：ConnectedRegions
+ * 说明：以行程编码与并查集标记二值模板的连通区域，一次扫描同时标记前景斑点（八连通）
+ * 与背景空洞（四连通）；
+ *    区域的层级与 findContours(RETR_TREE) 的轮廓层级相同：与图像边界相接的背景为外部，
+ * 外部包围的前景斑点为 0 级，0 级斑点的空洞为 1 级，空洞中的前景岛为 2 级，依此类推；
+ *    0 级斑点与 1 级空洞的面积为其轮廓（经过边界像素中心的多边形）的面积，与 contourArea 相同，
+ * 由像素个数加上各 2x2 窗口中的边界修正得到，只在行程端点处计算；
+ *    填充与移除区域时按行程写入，结果与 drawContours 逐轮廓填充相同，不需要逐轮廓的多边形计算；
+ *    可以划分为行条带并行标记，各条带的区域在条带边界处合并；
+ *    所有缓冲区跨帧复用，图像尺寸与前景复杂度稳定后不再分配内存；
+ *------------------------------------------------------------------
+ * Class: ConnectedRegions
+ *
+ * Summary:
+ *   Label the Connected Regions of a Binary Mask by run-length encoding and union-find.
+ * One scan labels both Foreground Blobs (8-connected) and Background Holes (4-connected).
+ *   Regions have the levels of findContours(RETR_TREE): background touching the image
+ * border is outside, blobs enclosed by it are level 0, holes of level 0 blobs are level 1,
+ * islands in those holes are level 2, and so on.
+ *   The Area of a level 0 blob or level 1 hole is the area of its contour (the polygon
+ * through the centres of its border pixels), the same as contourArea. It is the pixel count
+ * plus a border correction over 2x2 windows, computed only at run ends.
+ *   Regions are filled or removed run by run, with the same result as drawContours on each
+ * contour, but without per-contour polygon work.
+ *   The mask can be labeled in parallel row bands, whose regions are merged at the band borders.
+ *   All buffers are reused across frames, so nothing is allocated once the image size and
+ * the foreground complexity are stable.
+=====================================================================
+*/
+class ConnectedRegions
+{
+public:
+    // 标记二值模板 mask（CV_8UC1，非0为前景）的连通区域，nbands 个行条带在 OpenCV 线程池中并行标记
+    // Label the Connected Regions of binary mask (CV_8UC1, non-zero is Foreground), nbands row bands are labeled
+    // in parallel on OpenCV's thread pool
+    void label(const Mat &mask, int nbands = 1);
+
+    // 在 dst 中移除轮廓面积小于 min_blob_area 的 0 级前景斑点（置0），并填充轮廓面积不超过 max_hole_area 的
+    // 1 级前景空洞（置255）；dst 与标记的模板尺寸相同，可以就是该模板
+    // Remove level 0 Foreground Blobs whose contour Area is less than min_blob_area (set as 0), and fill level 1
+    // Foreground Holes whose contour Area is not larger than max_hole_area (set as 255) in dst; dst has the size
+    // of the labeled mask, and it can be that mask.
+    void fill(Mat &dst, int max_hole_area, int min_blob_area) const;
+
+private:
+    friend class ConnectedRegionsInvoker;
+
+    // 对行条带进行行程编码，并合并条带内相邻行的行程
+    // Run-length encode a Row Band, and merge the runs of adjacent rows inside the band
+    static void labelBand(const Mat &mask, RegionBand &band);
+
+    // 合并上一行 [prev_begin, prev_end) 与当前行 [cur_begin, cur_end) 中连通的行程
+    // Merge the connected runs of previous row [prev_begin, prev_end) & current row [cur_begin, cur_end)
+    static void mergeRows(const vector<RegionRun> &runs, vector<int> &parent,
+                          int prev_begin, int prev_end, int cur_begin, int cur_end);
+
+    // 计算各区域的层级，及 0 级斑点与 1 级空洞的轮廓面积
+    // Compute the Level of every region, and the contour Area of level 0 blobs & level 1 holes
+    void measure(int rows, int cols);
+
+    // 在轮廓面积上累加一个 2x2 窗口的边界修正，四个角依次为左上、右上、左下、右下所在区域，-1 表示不计
+    // Add the border correction of one 2x2 window to the contour Areas, the corners are the regions of
+    // top-left, top-right, bottom-left & bottom-right, -1 is not counted
+    void addWindow(int tl, int tr, int bl, int br);
+
+    // 查找行程 x 所在区域的根，并压缩路径
+    // Find the root of the region of run x, and compress the path
+    static int find(vector<int> &parent, int x);
+
+    // 合并行程 a 与 b 所在的区域，以编号较小的根为新根
+    // Merge the regions of run a & b, the root of smaller index becomes the new root
+    static void merge(vector<int> &parent, int a, int b);
+
+    // 各行条带的标记结果
+    // Labels of every Row Band
+    vector<RegionBand> bands;
+
+    // 所有行程，按行优先顺序存储
+    // All Runs, stored in row-major order
+    vector<RegionRun> runs;
+
+    // 并查集，行程编号即为标记
+    // Union-find, the index of a run is its label
+    vector<int> parent;
+
+    // 区域是否与图像边界相接，标记完成后在根上有效
+    // Whether the Region touches the image border, valid on the roots after labeling
+    vector<uchar> border;
+
+    // 各行首个行程的编号，共 rows + 1 项
+    // Index of the first run of every row, rows + 1 entries
+    vector<int> row_start;
+
+    // 区域的层级，外部背景为 -1，标记完成后在根上有效
+    // Level of Regions, -1 for the outside background, valid on the roots after labeling
+    vector<int> level;
+
+    // 包含该区域的 0 级斑点与 1 级空洞（可以是区域本身），没有时为 -1，标记完成后在根上有效
+    // the level 0 Blob & level 1 Hole containing the region (it may be the region itself), -1 for none,
+    // valid on the roots after labeling
+    vector<int> blob;
+    vector<int> hole;
+
+    // 轮廓面积的 4 倍，在 0 级斑点与 1 级空洞的根上有效
+    // 4 times the contour Area, valid on the roots of level 0 blobs & level 1 holes
+    vector<int> area4;
+};
+
+#endif // CONNECTEDREGIONS_H
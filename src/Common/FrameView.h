@@ -0,0 +1,152 @@
+/*=================================================================
+ * Zero-copy View of a Caller-owned Frame Buffer for Background Split Algorithms.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef FRAMEVIEW_H
+#define FRAMEVIEW_H
+
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+
+// 帧格式：灰度、BGR 交错，以及解码器输出的 NV12 / I420（只使用其亮度平面）
+// Frame Format: Gray, interleaved BGR, and NV12 / I420 of decoder output (only the luma plane is used)
+#define FRAME_FORMAT_GRAY   0
+#define FRAME_FORMAT_BGR    1
+#define FRAME_FORMAT_NV12   2
+#define FRAME_FORMAT_I420   3
+
+/*===================================================================
+ * 结构体：FrameView
+ * 说明：调用者持有的帧缓冲区的视图，算法不拷贝、不释放该缓冲区；
+ *    NV12 / I420 格式时 data 指向亮度平面，色度平面不被读取；
+ *------------------------------------------------------------------
+ * Struct: FrameView
+ *
+ * Summary:
+ *   View of a caller-owned frame buffer, the algorithms neither copy nor release it.
+ *   For NV12 / I420, data points to the luma plane and the chroma planes are never read.
+=====================================================================
+*/
+struct FrameView
+{
+    // 首行首像素地址
+    // Address of the first pixel of the first row
+    const uchar *data;
+
+    // 图像宽度与高度（像素）
+    // Width & Height of the image (pixels)
+    int width;
+    int height;
+
+    // 相邻两行的字节间隔
+    // Bytes between two adjacent rows
+    size_t stride;
+
+    // 帧格式，FRAME_FORMAT_*
+    // Frame Format, FRAME_FORMAT_*
+    int format;
+};
+
+// 由缓冲区构造帧视图
+// Construct a Frame View from a buffer
+inline FrameView MakeFrameView(const uchar *data, int width, int height, size_t stride, int format = FRAME_FORMAT_GRAY)
+{
+    FrameView view = {data, width, height, stride, format};
+    return view;
+}
+
+// 不拷贝数据，由 8 位灰度或 BGR 的 Mat 构造帧视图
+// Construct a Frame View from an 8-bit gray or BGR Mat without copying the data
+inline FrameView MakeFrameView(const Mat &img)
+{
+    CV_Assert(img.depth() == CV_8U && (img.channels() == 1 || img.channels() == 3));
+    int format = img.channels() == 3 ? FRAME_FORMAT_BGR : FRAME_FORMAT_GRAY;
+    return MakeFrameView(img.data, img.cols, img.rows, img.step, format);
+}
+
+// 帧视图是否包含亮度（灰度）平面
+// Whether the Frame View contains a luma (gray) plane
+inline bool FrameViewHasLuma(const FrameView &view)
+{
+    return view.format == FRAME_FORMAT_GRAY || view.format == FRAME_FORMAT_NV12 || view.format == FRAME_FORMAT_I420;
+}
+
+/*===================================================================
+ * 函数名：FrameViewMat
+ * 说明：不拷贝数据，将帧视图包装为 Mat 头；
+ *    GRAY / NV12 / I420 返回亮度平面的 CV_8UC1 Mat，BGR 返回 CV_8UC3 Mat；
+ * 参数：
+ *   const FrameView &view:  帧视图
+ * 返回值：Mat
+ *------------------------------------------------------------------
+ * Function: FrameViewMat
+ *
+ * Summary:
+ *   Wrap the Frame View as a Mat header without copying the data.
+ *   GRAY / NV12 / I420 give a CV_8UC1 Mat of the luma plane, BGR gives a CV_8UC3 Mat.
+ *
+ * Arguments:
+ *   const FrameView &view - Frame View
+ *
+ * Returns:
+ *   Mat
+=====================================================================
+*/
+inline Mat FrameViewMat(const FrameView &view)
+{
+    int type = view.format == FRAME_FORMAT_BGR ? CV_8UC3 : CV_8UC1;
+    return Mat(view.height, view.width, type, (void *)view.data, view.stride);
+}
+
+/*===================================================================
+ * 函数名：FrameViewGray
+ * 说明：获取帧视图的灰度图；
+ *    GRAY / NV12 / I420 直接包装亮度平面，不拷贝；BGR 转换到 buf 中，复用 buf 的内存；
+ * 参数：
+ *   const FrameView &view:  帧视图
+ *   Mat &buf:  BGR 格式时存放灰度图的缓冲区
+ * 返回值：Mat
+ *------------------------------------------------------------------
+ * Function: FrameViewGray
+ *
+ * Summary:
+ *   Get the Gray Image of the Frame View.
+ *   GRAY / NV12 / I420 wrap the luma plane without copying; BGR is converted into buf,
+ * reusing buf's memory.
+ *
+ * Arguments:
+ *   const FrameView &view - Frame View
+ *   Mat &buf - buffer of the gray image for BGR format
+ *
+ * Returns:
+ *   Mat
+=====================================================================
+*/
+inline Mat FrameViewGray(const FrameView &view, Mat &buf)
+{
+    if(FrameViewHasLuma(view))
+        return FrameViewMat(view);
+
+    cvtColor(FrameViewMat(view), buf, CV_BGR2GRAY);
+    return buf;
+}
+
+#endif // FRAMEVIEW_H
@@ -0,0 +1,304 @@
+/*=================================================================
+ * Constant-time Rectangular Morphology of Binary Masks by van Herk / Gil-Werman Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#include <cstring>
+#include "Morphology.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MORPH_SIMD_SSE2 1
+#endif
+
+// 两个像素的最大值或最小值
+// Max or Min of two pixels
+static inline uchar MorphOp(uchar a, uchar b, bool is_max)
+{
+    return is_max ? (a > b ? a : b) : (a < b ? a : b);
+}
+
+// 两行像素逐个取最大值或最小值：dst = op(a, b)
+// Max or Min of two rows pixel by pixel: dst = op(a, b)
+static void MorphRowOp(uchar *dst, const uchar *a, const uchar *b, int n, bool is_max)
+{
+    int j = 0;
+#if MORPH_SIMD_SSE2
+    if(is_max)
+    {
+        for(; j <= n - 16; j += 16)
+            _mm_storeu_si128((__m128i *)(dst + j), _mm_max_epu8(_mm_loadu_si128((const __m128i *)(a + j)),
+                                                                _mm_loadu_si128((const __m128i *)(b + j))));
+    }
+    else
+    {
+        for(; j <= n - 16; j += 16)
+            _mm_storeu_si128((__m128i *)(dst + j), _mm_min_epu8(_mm_loadu_si128((const __m128i *)(a + j)),
+                                                                _mm_loadu_si128((const __m128i *)(b + j))));
+    }
+#endif
+    for(; j < n; j++)
+        dst[j] = MorphOp(a[j], b[j], is_max);
+}
+
+/*===================================================================
+ * 函数名：erode / dilate / open / close
+ * 说明：矩形结构元素的腐蚀、膨胀、开运算与闭运算；
+ * 参数：
+ *   const Mat &src:  输入模板，CV_8UC1
+ *   Mat &dst:  输出模板，可以就是 src
+ *   Size ksize:  矩形结构元素的宽与高
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: erode / dilate / open / close
+ *
+ * Summary:
+ *   Erode, Dilate, Open & Close with a rectangular structuring element.
+ *
+ * Arguments:
+ *   const Mat &src - input mask, CV_8UC1
+ *   Mat &dst - output mask, it can be src
+ *   Size ksize - width & height of the rectangular structuring element
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void RectMorphology::erode(const Mat &src, Mat &dst, Size ksize)
+{
+    filter(src, dst, ksize, false);
+}
+
+void RectMorphology::dilate(const Mat &src, Mat &dst, Size ksize)
+{
+    filter(src, dst, ksize, true);
+}
+
+void RectMorphology::open(const Mat &src, Mat &dst, Size ksize)
+{
+    filter(src, dst, ksize, false);
+    filter(dst, dst, ksize, true);
+}
+
+void RectMorphology::close(const Mat &src, Mat &dst, Size ksize)
+{
+    filter(src, dst, ksize, true);
+    filter(dst, dst, ksize, false);
+}
+
+/*===================================================================
+ * 函数名：filter
+ * 说明：矩形窗口内的最大值（膨胀）或最小值（腐蚀）；
+ *    先逐行由 src 写入 dst，再在 dst 上原地按列处理；
+ * 参数：
+ *   const Mat &src:  输入模板，CV_8UC1
+ *   Mat &dst:  输出模板，可以就是 src
+ *   Size ksize:  窗口的宽与高
+ *   bool is_max:  true 为最大值，false 为最小值
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: filter
+ *
+ * Summary:
+ *   Max (dilate) or Min (erode) in a rectangular window.
+ *   Rows are filtered from src into dst first, then the columns are filtered in place on dst.
+ *
+ * Arguments:
+ *   const Mat &src - input mask, CV_8UC1
+ *   Mat &dst - output mask, it can be src
+ *   Size ksize - width & height of the window
+ *   bool is_max - true for Max, false for Min
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void RectMorphology::filter(const Mat &src, Mat &dst, Size ksize, bool is_max)
+{
+    CV_Assert(src.type() == CV_8UC1 && ksize.width > 0 && ksize.height > 0);
+
+    // 先保留 src 的头，dst 就是 src 时 create 不会重新分配
+    // Keep src's header first; create doesn't reallocate when dst is src
+    Mat in = src;
+    dst.create(in.size(), CV_8UC1);
+
+    for(int i = 0; i < in.rows; i++)
+        filterRow(in.ptr<uchar>(i), dst.ptr<uchar>(i), in.cols, ksize.width, is_max);
+
+    if(ksize.height > 1)
+        filterCols(dst, ksize.height, is_max);
+}
+
+/*===================================================================
+ * 函数名：filterRow
+ * 说明：van Herk / Gil-Werman 一维滑动最大（最小）值；
+ *    补边后的序列 P 划分为长度为 k 的块，g 为块内前缀、h 为块内后缀，
+ *    窗口 P[x, x + k - 1] 的结果为 op(h[x], g[x + k - 1])，每个像素约 3 次比较；
+ * 参数：
+ *   const uchar *src:  输入行
+ *   uchar *dst:  输出行，可以就是 src
+ *   int n:  像素个数
+ *   int k:  窗口长度，锚点为 k / 2
+ *   bool is_max:  true 为最大值，false 为最小值
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: filterRow
+ *
+ * Summary:
+ *   van Herk / Gil-Werman 1-D Running Max (Min).
+ *   The padded sequence P is split into blocks of length k, g is the in-block prefix and
+ * h the in-block suffix, and the window P[x, x + k - 1] is op(h[x], g[x + k - 1]), about
+ * 3 comparisons per pixel.
+ *
+ * Arguments:
+ *   const uchar *src - input row
+ *   uchar *dst - output row, it can be src
+ *   int n - number of pixels
+ *   int k - window length, anchored at k / 2
+ *   bool is_max - true for Max, false for Min
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void RectMorphology::filterRow(const uchar *src, uchar *dst, int n, int k, bool is_max)
+{
+    if(k == 1)
+    {
+        if(dst != src)
+            memcpy(dst, src, n);
+        return;
+    }
+
+    // 图像外的像素取运算的单位元，不影响结果
+    // Pixels outside the image take the identity of the operation, so they don't affect the result
+    const uchar pad = is_max ? 0 : 255;
+    const int anchor = k / 2;
+    const int len = (n + k - 1 + k - 1) / k * k;
+
+    row_pad.resize(len);
+    row_prefix.resize(len);
+    row_suffix.resize(len);
+    uchar *P = &row_pad[0], *g = &row_prefix[0], *h = &row_suffix[0];
+
+    memset(P, pad, len);
+    memcpy(P + anchor, src, n);
+
+    for(int b = 0; b < len; b += k)
+    {
+        g[b] = P[b];
+        for(int t = b + 1; t < b + k; t++)
+            g[t] = MorphOp(g[t - 1], P[t], is_max);
+        h[b + k - 1] = P[b + k - 1];
+        for(int t = b + k - 2; t >= b; t--)
+            h[t] = MorphOp(h[t + 1], P[t], is_max);
+    }
+
+    for(int x = 0; x < n; x++)
+        dst[x] = MorphOp(h[x], g[x + k - 1], is_max);
+}
+
+/*===================================================================
+ * 函数名：filterCols
+ * 说明：按列的 van Herk / Gil-Werman 滑动最大（最小）值，以整行为单位向量化进行；
+ *    每次处理一个长度为 k 的行块：当前块的后缀原地累积在 cur 中，
+ *    同时把下一块的 k 行拷入 next 并累积前缀，第 b + t 行的结果为 op(cur[t], next 的前 t 行)；
+ *    下一块的行在被覆盖之前就已拷入缓冲，因此可以在 img 上原地输出；
+ * 参数：
+ *   Mat &img:  模板，原地处理
+ *   int k:  窗口高度，锚点为 k / 2
+ *   bool is_max:  true 为最大值，false 为最小值
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: filterCols
+ *
+ * Summary:
+ *   van Herk / Gil-Werman Running Max (Min) along the columns, vectorized over whole rows.
+ *   One block of k rows at a time: the suffix of current block accumulates in place in
+ * cur, while the k rows of the next block are copied into next and their prefix is
+ * accumulated; row b + t is op(cur[t], first t rows of next).
+ *   The rows of the next block are copied into the buffer before they are overwritten,
+ * so the output can be written in place on img.
+ *
+ * Arguments:
+ *   Mat &img - mask, filtered in place
+ *   int k - window height, anchored at k / 2
+ *   bool is_max - true for Max, false for Min
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void RectMorphology::filterCols(Mat &img, int k, bool is_max)
+{
+    const int n = img.rows, w = img.cols;
+    const uchar pad = is_max ? 0 : 255;
+    const int anchor = k / 2;
+
+    col_buf.resize((size_t)(2 * k + 2) * w);
+    uchar *cur = &col_buf[0];
+    uchar *next = cur + (size_t)k * w;
+    uchar *prefix = next + (size_t)k * w;
+    uchar *pad_row = prefix + w;
+    memset(pad_row, pad, w);
+
+    // 补边序列的第 t 行：img 的第 t - anchor 行，或补边行
+    // Row t of the padded sequence: row t - anchor of img, or the padding row
+#define MORPH_PADDED_ROW(t) ((t) - anchor >= 0 && (t) - anchor < n ? img.ptr<uchar>((t) - anchor) : pad_row)
+
+    for(int t = 0; t < k; t++)
+        memcpy(cur + (size_t)t * w, MORPH_PADDED_ROW(t), w);
+
+    for(int b = 0; b < n; b += k)
+    {
+        // 当前块的后缀
+        // Suffix of current block
+        for(int t = k - 2; t >= 0; t--)
+            MorphRowOp(cur + (size_t)t * w, cur + (size_t)t * w, cur + (size_t)(t + 1) * w, w, is_max);
+
+        for(int t = 0; t < k; t++)
+        {
+            // 在输出第 b + t 行之前拷入下一块的第 t 行
+            // Copy row t of the next block before row b + t is written
+            memcpy(next + (size_t)t * w, MORPH_PADDED_ROW(b + k + t), w);
+
+            int x = b + t;
+            if(x >= n)
+                continue;
+            uchar *out = img.ptr<uchar>(x);
+            if(t == 0)
+                memcpy(out, cur, w);
+            else
+            {
+                if(t == 1)
+                    memcpy(prefix, next, w);
+                else
+                    MorphRowOp(prefix, prefix, next + (size_t)(t - 1) * w, w, is_max);
+                MorphRowOp(out, cur + (size_t)t * w, prefix, w, is_max);
+            }
+        }
+
+        uchar *tmp = cur;
+        cur = next;
+        next = tmp;
+    }
+
+#undef MORPH_PADDED_ROW
+}
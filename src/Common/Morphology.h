@@ -0,0 +1,88 @@
+/*=================================================================
+ * Constant-time Rectangular Morphology of Binary Masks by van Herk / Gil-Werman Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+using namespace std;
+
+/*===================================================================
+ * 类名：RectMorphology
+ * 说明：矩形结构元素的腐蚀、膨胀、开运算与闭运算，用于各背景分割算法输出模板的后处理；
+ *    van Herk / Gil-Werman 算法：按行、按列分离为两次一维滑动最大（最小）值，
+ *    每个像素的比较次数为常数，与结构元素尺寸无关；
+ *    边界与 OpenCV 默认一致：图像外的像素不参与运算；
+ *    dst 可以就是 src，原地运算不需要额外的整帧拷贝；缓冲区只有若干行，跨帧复用；
+ *------------------------------------------------------------------
+ * Class: RectMorphology
+ *
+ * Summary:
+ *   Erode, Dilate, Open & Close with a rectangular structuring element, the post-processing
+ * of the masks of every Background Split Algorithm.
+ *   van Herk / Gil-Werman Algorithm: separated into two 1-D running max (min) passes along
+ * rows and along columns, with a constant number of comparisons per pixel whatever the
+ * size of the structuring element.
+ *   Borders are the same as OpenCV's default: pixels outside the image take no part.
+ *   dst can be src, and working in place needs no extra full-frame copy. The buffers are
+ * only a few rows, reused across frames.
+=====================================================================
+*/
+class RectMorphology
+{
+public:
+    // 腐蚀与膨胀，src 为 CV_8UC1，结构元素为 ksize 大小的矩形，锚点在中心
+    // Erode & Dilate, src is CV_8UC1, the structuring element is a ksize rectangle anchored at its center
+    void erode(const Mat &src, Mat &dst, Size ksize);
+    void dilate(const Mat &src, Mat &dst, Size ksize);
+
+    // 开运算（先腐蚀后膨胀）与闭运算（先膨胀后腐蚀）
+    // Open (erode then dilate) & Close (dilate then erode)
+    void open(const Mat &src, Mat &dst, Size ksize);
+    void close(const Mat &src, Mat &dst, Size ksize);
+
+private:
+    // 滑动最大值（膨胀）或滑动最小值（腐蚀）
+    // Running Max (dilate) or Running Min (erode)
+    void filter(const Mat &src, Mat &dst, Size ksize, bool is_max);
+
+    // 按行的一维滑动最大（最小）值，src 与 dst 可以相同
+    // 1-D Running Max (Min) along a row, src and dst can be the same
+    void filterRow(const uchar *src, uchar *dst, int n, int k, bool is_max);
+
+    // 按列的一维滑动最大（最小）值，在 img 上原地进行
+    // 1-D Running Max (Min) along the columns, in place on img
+    void filterCols(Mat &img, int k, bool is_max);
+
+    // 按行滑动的缓冲：补边后的一行，以及块内前缀、后缀
+    // Buffers of the row pass: the padded row, and the in-block prefix & suffix
+    vector<uchar> row_pad, row_prefix, row_suffix;
+
+    // 按列滑动的缓冲：当前块与下一块各 k 行，块内前缀一行，补边一行
+    // Buffers of the column pass: k rows each for current & next block, one in-block prefix row, one padding row
+    vector<uchar> col_buf;
+};
+
+#endif // MORPHOLOGY_H
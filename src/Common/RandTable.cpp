@@ -0,0 +1,281 @@
+/*=================================================================
+ * Precomputed Random Number Tables for the Update Decisions of ViBe & ViBe+ Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include <cmath>
+#include <climits>
+#include "RandTable.h"
+
+/*===================================================================
+ * 构造函数：RandTable
+ *------------------------------------------------------------------
+ * Constructed Function: RandTable
+=====================================================================
+*/
+RandTable::RandTable()
+{
+    state = 2463534242U;
+}
+
+/*===================================================================
+ * 函数名：init
+ * 说明：用 xorshift 随机数生成器生成随机数表，各项决策的分布与逐次调用 RNG 相同；
+ * 参数：
+ *   int num_samples:  每个像素点的样本个数，(0, RAND_TABLE_MAX_SAMPLES]
+ *   int random_sample:  子采样概率
+ *   int width:  图像宽度，即每行连续读取的项数
+ *   uint64 seed:  随机数种子
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: init
+ *
+ * Summary:
+ *   Generate the Random Number Tables by xorshift generator, every decision has the same
+ * distribution as calling RNG one by one.
+ *
+ * Arguments:
+ *   int num_samples - Number of pixel's samples, (0, RAND_TABLE_MAX_SAMPLES]
+ *   int random_sample - the probability of random sample
+ *   int width - width of image, i.e. number of entries read continuously for one row
+ *   uint64 seed - Seed of Random Number Generator
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void RandTable::init(int num_samples, int random_sample, int width, uint64 seed)
+{
+    CV_Assert(num_samples > 0 && num_samples <= RAND_TABLE_MAX_SAMPLES);
+
+    state = (unsigned)(seed ^ (seed >> 32));
+    if(state == 0)
+        state = 2463534242U;
+
+    double log_q = geometricLogQ(random_sample);
+    entries.resize(RAND_TABLE_SIZE + width);
+    for(int n = 0; n < RAND_TABLE_SIZE; n++)
+    {
+        RandEntry &e = entries[n];
+        e.gap = (ushort)min(geometricGap(xorshift() * 2.3283064365386962890625e-10, log_q), 65535);
+        e.sample_self = (uchar)(xorshift() % num_samples);
+        e.sample_neighbor = (uchar)(xorshift() % num_samples);
+        e.neighbor_y = (uchar)(xorshift() % 9);
+        e.neighbor_x = (uchar)(xorshift() % 9);
+        e.sample_fore = (uchar)(xorshift() % num_samples);
+    }
+
+    // 表尾重复表头
+    // the Tail repeats the Head
+    for(int n = RAND_TABLE_SIZE; n < (int)entries.size(); n++)
+        entries[n] = entries[n & (RAND_TABLE_SIZE - 1)];
+}
+
+/*===================================================================
+ * 函数名：empty
+ * 说明：随机数表是否已生成；
+ * 返回值：bool
+ *------------------------------------------------------------------
+ * Function: empty
+ *
+ * Summary:
+ *   the Random Number Tables are generated or not.
+ *
+ * Returns:
+ *   bool
+=====================================================================
+*/
+bool RandTable::empty() const
+{
+    return entries.empty();
+}
+
+/*===================================================================
+ * 函数名：row
+ * 说明：以随机偏移读取一行像素的随机数表；
+ *    每行（每帧）使用不同的偏移，使各帧读取的随机序列不同；
+ * 参数：
+ *   unsigned offset:  随机偏移
+ * 返回值：const RandEntry *
+ *------------------------------------------------------------------
+ * Function: row
+ *
+ * Summary:
+ *   get Random Number Table of one row at a random offset.
+ *   Every row (and every frame) uses a different offset, so the random sequences differ
+ * from frame to frame.
+ *
+ * Arguments:
+ *   unsigned offset - random offset
+ *
+ * Returns:
+ *   const RandEntry *
+=====================================================================
+*/
+const RandEntry *RandTable::row(unsigned offset) const
+{
+    return &entries[offset & (RAND_TABLE_SIZE - 1)];
+}
+
+/*===================================================================
+ * 函数名：at
+ * 说明：读取随机数表中的一项，下标超出表长时循环读取；
+ * 参数：
+ *   unsigned index:  下标
+ * 返回值：const RandEntry &
+ *------------------------------------------------------------------
+ * Function: at
+ *
+ * Summary:
+ *   get one Entry of Random Number Table, the index wraps around the table.
+ *
+ * Arguments:
+ *   unsigned index - index
+ *
+ * Returns:
+ *   const RandEntry &
+=====================================================================
+*/
+const RandEntry &RandTable::at(unsigned index) const
+{
+    return entries[index & (RAND_TABLE_SIZE - 1)];
+}
+
+/*===================================================================
+ * 函数名：drawGap
+ * 说明：抽取到下一个更新像素的间隔；
+ *    随机数表不为空时，读取 cursor 处的表项并将 cursor 后移，该表项同时提供本次更新的其他随机决策；
+ *    随机数表为空时，由 RNG 生成几何分布的间隔，entry 置为 NULL；
+ * 参数：
+ *   RNG &rng:  随机数生成器
+ *   double log_q:  几何分布参数 log(1 - 1 / random_sample)
+ *   unsigned &cursor:  随机数表的读取位置
+ *   const RandEntry *&entry:  输出本次更新所用的表项
+ * 返回值：int
+ *------------------------------------------------------------------
+ * Function: drawGap
+ *
+ * Summary:
+ *   Draw the Gap to the next updating pixel.
+ *   If the tables are not empty, read the entry at cursor and move cursor forward, this
+ * entry also provides the other random decisions of this update.
+ *   If the tables are empty, draw a geometric gap from RNG and set entry as NULL.
+ *
+ * Arguments:
+ *   RNG &rng - Random Number Generator
+ *   double log_q - Parameter log(1 - 1 / random_sample) of the geometric distribution
+ *   unsigned &cursor - reading position of the tables
+ *   const RandEntry *&entry - output the entry used by this update
+ *
+ * Returns:
+ *   int
+=====================================================================
+*/
+int RandTable::drawGap(RNG &rng, double log_q, unsigned &cursor, const RandEntry *&entry) const
+{
+    if(entries.empty())
+    {
+        entry = NULL;
+        return geometricGap(rng.uniform(0.0, 1.0), log_q);
+    }
+    entry = &entries[cursor++ & (RAND_TABLE_SIZE - 1)];
+    return entry->gap;
+}
+
+/*===================================================================
+ * 函数名：geometricGap
+ * 说明：以逆变换法生成几何分布的间隔：gap = 1 + floor(log(1 - u) / log(1 - p))；
+ *    每个像素以概率 p 独立更新时，相邻两个更新像素的间隔即服从该分布；
+ * 参数：
+ *   double u:  [0, 1) 均匀分布的随机数
+ *   double log_q:  log(1 - p)，p = 1 / random_sample
+ * 返回值：int
+ *------------------------------------------------------------------
+ * Function: geometricGap
+ *
+ * Summary:
+ *   Draw a geometric gap by inverse transform: gap = 1 + floor(log(1 - u) / log(1 - p)).
+ *   When every pixel updates independently with possibility p, the gap between two
+ * updating pixels follows this distribution.
+ *
+ * Arguments:
+ *   double u - random number uniform in [0, 1)
+ *   double log_q - log(1 - p), p = 1 / random_sample
+ *
+ * Returns:
+ *   int
+=====================================================================
+*/
+int RandTable::geometricGap(double u, double log_q)
+{
+    // random_sample <= 1 时每个像素都更新
+    // Every pixel updates when random_sample <= 1
+    if(log_q >= 0)
+        return 1;
+    double gap = log(1.0 - u) / log_q;
+    return gap < (double)INT_MAX - 1 ? 1 + (int)gap : INT_MAX;
+}
+
+/*===================================================================
+ * 函数名：geometricLogQ
+ * 说明：计算几何分布参数 log(1 - 1 / random_sample)；
+ * 参数：
+ *   int random_sample:  子采样概率
+ * 返回值：double
+ *------------------------------------------------------------------
+ * Function: geometricLogQ
+ *
+ * Summary:
+ *   Calculate Parameter log(1 - 1 / random_sample) of the geometric distribution.
+ *
+ * Arguments:
+ *   int random_sample - the probability of random sample
+ *
+ * Returns:
+ *   double
+=====================================================================
+*/
+double RandTable::geometricLogQ(int random_sample)
+{
+    if(random_sample <= 1)
+        return 0;
+    return log(1.0 - 1.0 / random_sample);
+}
+
+/*===================================================================
+ * 函数名：xorshift
+ * 说明：xorshift32 随机数生成器；
+ * 返回值：unsigned
+ *------------------------------------------------------------------
+ * Function: xorshift
+ *
+ * Summary:
+ *   xorshift32 Random Number Generator.
+ *
+ * Returns:
+ *   unsigned
+=====================================================================
+*/
+unsigned RandTable::xorshift()
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
@@ -0,0 +1,118 @@
+/*=================================================================
+ * Precomputed Random Number Tables for the Update Decisions of ViBe & ViBe+ Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef RANDTABLE_H
+#define RANDTABLE_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+using namespace std;
+
+// 随机数来源：每次调用 RNG，或读取预先生成的随机数表
+// Random Source: call RNG every time, or read the precomputed random number tables
+#define RANDOM_MODE_RNG     0
+#define RANDOM_MODE_TABLE   1
+
+// 随机数表的项数（必须为 2 的幂）
+// Entry Number of Random Number Table (must be a power of 2)
+#define RAND_TABLE_SIZE  65536
+
+// 样本编号以 uchar 存储，每个像素点的样本个数最多为 256
+// Sample IDs are stored as uchar, so a pixel has at most 256 samples
+#define RAND_TABLE_MAX_SAMPLES  256
+
+// 随机数表中的一项，包含一次更新所需的全部随机决策
+// One Entry of Random Number Table, it includes all random decisions of one update
+struct RandEntry
+{
+    // 到下一个更新像素的间隔，服从参数为 1 / random_sample 的几何分布
+    // Gap to the next updating pixel, it follows the geometric distribution with p = 1 / random_sample
+    ushort gap;
+
+    // 被替换的自身样本编号，[0, num_samples)
+    // ID of its own sample to be replaced, [0, num_samples)
+    uchar sample_self;
+
+    // 被替换的邻居点样本编号，[0, num_samples)
+    // ID of neighbour's sample to be replaced, [0, num_samples)
+    uchar sample_neighbor;
+
+    // 邻居点在 c_yoff、c_xoff 中的下标，[0, 9)
+    // Index of the neighbour in c_yoff & c_xoff, [0, 9)
+    uchar neighbor_y;
+    uchar neighbor_x;
+
+    // 连续前景点被替换的样本编号，[0, num_samples)
+    // ID of the sample replaced for a long-time foreground pixel, [0, num_samples)
+    uchar sample_fore;
+};
+
+class RandTable
+{
+public:
+    RandTable();
+
+    // 生成随机数表
+    // Generate the Random Number Tables
+    void init(int num_samples, int random_sample, int width, uint64 seed = 0x9E3779B97F4A7C15ULL);
+
+    // 随机数表是否已生成
+    // the Random Number Tables are generated or not
+    bool empty() const;
+
+    // 以随机偏移读取一行像素的随机数表，返回的指针至少可以读取 width 项
+    // get Random Number Table of one row at a random offset, at least width entries can be read from the returned pointer
+    const RandEntry *row(unsigned offset) const;
+
+    // 读取随机数表中的一项
+    // get one Entry of Random Number Table
+    const RandEntry &at(unsigned index) const;
+
+    // 抽取到下一个更新像素的间隔，并输出该次更新所用的表项；随机数表为空时调用 RNG，entry 置为 NULL
+    // Draw the Gap to the next updating pixel and output the entry used by this update;
+    // RNG is called when the tables are empty, and entry is set as NULL
+    int drawGap(RNG &rng, double log_q, unsigned &cursor, const RandEntry *&entry) const;
+
+    // 由 [0, 1) 均匀分布的随机数 u 生成几何分布的间隔，log_q = log(1 - 1 / random_sample)
+    // Draw a geometric gap from u which is uniform in [0, 1), log_q = log(1 - 1 / random_sample)
+    static int geometricGap(double u, double log_q);
+
+    // 几何分布参数 log(1 - 1 / random_sample)
+    // Parameter log(1 - 1 / random_sample) of the geometric distribution
+    static double geometricLogQ(int random_sample);
+
+private:
+    // xorshift 随机数生成器
+    // xorshift Random Number Generator
+    unsigned xorshift();
+
+    // 随机数表，长度为 RAND_TABLE_SIZE + width，尾部重复表头以便按行连续读取
+    // Random Number Table, the length is RAND_TABLE_SIZE + width, its tail repeats the head so a row can be read continuously
+    vector<RandEntry> entries;
+
+    // xorshift 状态
+    // State of xorshift
+    unsigned state;
+};
+
+#endif // RANDTABLE_H
@@ -0,0 +1,228 @@
+/*=================================================================
+ * Extract Moving Areas of a Video Stream by Frame Difference Method using OpenCV Library.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#include "FrameDiff.h"
+
+/*===================================================================
+ * 构造函数：FrameDiff
+ * 说明：设置差分阈值与差分帧数，环形缓冲在第一帧时分配；
+ * 参数：
+ *   int threshold:  差分阈值
+ *   int num_frames:  差分帧数，FRAMEDIFF_TWO_FRAMES 或 FRAMEDIFF_THREE_FRAMES 等
+ *------------------------------------------------------------------
+ * Constructed Function: FrameDiff
+ *
+ * Summary:
+ *   Set the Difference Threshold and the Number of Frames, the ring buffers are
+ * allocated on the first frame.
+ *
+ * Arguments:
+ *   int threshold - the Difference Threshold
+ *   int num_frames - Number of Frames of the Difference, FRAMEDIFF_TWO_FRAMES or FRAMEDIFF_THREE_FRAMES etc.
+=====================================================================
+*/
+FrameDiff::FrameDiff(int threshold, int num_frames)
+{
+    diff_threshold = threshold;
+    this->num_frames = 0;
+    gray_pos = mask_pos = frame_count = 0;
+    setNumFrames(num_frames);
+}
+
+/*===================================================================
+ * 函数名：init
+ * 说明：按图像尺寸分配灰度图与差分掩码的环形缓冲，差分掩码初始化为全零；
+ * 参数：
+ *   Size size:  图像尺寸
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: init
+ *
+ * Summary:
+ *   Allocate the ring buffers of gray frames and difference masks by the image size,
+ * and init the difference masks as all zero.
+ *
+ * Arguments:
+ *   Size size - image size
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiff::init(Size size)
+{
+    gray_ring[0].create(size, CV_8UC1);
+    gray_ring[1].create(size, CV_8UC1);
+
+    // 两帧差分不需要保存差分掩码
+    // The two-frame difference doesn't keep difference masks
+    mask_ring.resize(num_frames > FRAMEDIFF_TWO_FRAMES ? num_frames - 1 : 0);
+    for(size_t k = 0; k < mask_ring.size(); k++)
+    {
+        mask_ring[k].create(size, CV_8UC1);
+        mask_ring[k] = Scalar::all(0);
+    }
+
+    gray_pos = mask_pos = frame_count = 0;
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：帧间差分法；
+ *    当前帧灰度图写入环形缓冲，与上一帧逐行一次遍历完成 8 位差分与阈值化；
+ *    N 帧差分时同一遍历中保存本次差分掩码，并与之前 N - 2 次差分掩码相与；
+ * 参数：
+ *   Mat src:  源图像，灰度或 BGR
+ *   Mat &mask:  输出运动区域二值图像
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Frame Difference Method.
+ *   The gray image of current frame is written into the ring buffer, then the 8-bit
+ * difference against the previous frame and the threshold are done row by row in one pass.
+ *   For the N-frame difference, the same pass keeps this difference mask and ANDs it with
+ * the earlier N - 2 difference masks.
+ *
+ * Arguments:
+ *   Mat src - source image, gray or BGR
+ *   Mat &mask - output Moving Area Binary Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiff::process(Mat src, Mat &mask)
+{
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+
+    if(gray_ring[0].empty() || gray_ring[0].size() != src.size())
+        init(src.size());
+
+    mask.create(src.size(), CV_8UC1);
+
+    // 当前帧写入上一帧之外的另一个位置
+    // Current frame goes into the slot other than the previous frame
+    Mat &cur = gray_ring[gray_pos ^ 1];
+    const Mat &prev = gray_ring[gray_pos];
+    if(src.channels() == 3)
+        cvtColor(src, cur, CV_BGR2GRAY);
+
+    // 本次差分掩码与之前的差分掩码在环形缓冲中的位置
+    // Positions of this difference mask and of the earlier difference masks in the ring buffer
+    int n_and = 0;
+    int ring_size = (int)mask_ring.size();
+    int prev_pos[FRAMEDIFF_MAX_FRAMES];
+    for(int k = 1; k < ring_size; k++)
+        prev_pos[n_and++] = (mask_pos + k) % ring_size;
+
+    for(int i = 0; i < src.rows; i++)
+    {
+        uchar *cur_row = cur.ptr<uchar>(i);
+        if(src.channels() == 1)
+            memcpy(cur_row, src.ptr<uchar>(i), src.cols);
+
+        // 第一帧没有上一帧，输出全零
+        // The first frame has no previous frame, the output is all zero
+        if(frame_count == 0)
+        {
+            memset(mask.ptr<uchar>(i), 0, src.cols);
+            continue;
+        }
+
+        const uchar *and_rows[FRAMEDIFF_MAX_FRAMES];
+        for(int k = 0; k < n_and; k++)
+            and_rows[k] = mask_ring[prev_pos[k]].ptr<uchar>(i);
+        FrameDiffRow(cur_row, prev.ptr<uchar>(i), src.cols, diff_threshold,
+                     ring_size ? mask_ring[mask_pos].ptr<uchar>(i) : NULL, and_rows, n_and,
+                     mask.ptr<uchar>(i));
+    }
+
+    if(frame_count > 0 && ring_size)
+        mask_pos = (mask_pos + 1) % ring_size;
+    gray_pos ^= 1;
+    if(frame_count < num_frames)
+        frame_count++;
+}
+
+void FrameDiff::process(const FrameView &frame, Mat &mask)
+{
+    process(FrameViewMat(frame), mask);
+}
+
+/*===================================================================
+ * 函数名：reset
+ * 说明：清除环形缓冲，下一帧重新开始；
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: reset
+ *
+ * Summary:
+ *   Clear the ring buffers, start again on the next frame.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiff::reset()
+{
+    gray_ring[0].release();
+    gray_ring[1].release();
+    mask_ring.clear();
+    gray_pos = mask_pos = frame_count = 0;
+}
+
+/*===================================================================
+ * 函数名：setThreshold / setNumFrames
+ * 说明：设置差分阈值与差分帧数；差分帧数改变时清除环形缓冲；
+ * 参数：
+ *   int threshold:  差分阈值
+ *   int n:  差分帧数，限制在 2 - FRAMEDIFF_MAX_FRAMES
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setThreshold / setNumFrames
+ *
+ * Summary:
+ *   Set the Difference Threshold and the Number of Frames of the Difference; the ring
+ * buffers are cleared when the number of frames changes.
+ *
+ * Arguments:
+ *   int threshold - the Difference Threshold
+ *   int n - Number of Frames of the Difference, limited to 2 - FRAMEDIFF_MAX_FRAMES
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiff::setThreshold(int threshold)
+{
+    diff_threshold = threshold;
+}
+
+void FrameDiff::setNumFrames(int n)
+{
+    n = n < FRAMEDIFF_TWO_FRAMES ? FRAMEDIFF_TWO_FRAMES : n > FRAMEDIFF_MAX_FRAMES ? FRAMEDIFF_MAX_FRAMES : n;
+    if(n != num_frames)
+        reset();
+    num_frames = n;
+}
@@ -0,0 +1,120 @@
+/*=================================================================
+ * Extract Moving Areas of a Video Stream by Frame Difference Method using OpenCV Library.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#ifndef FRAMEDIFF_H
+#define FRAMEDIFF_H
+
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "Common/FrameView.h"
+#include "FrameDiffKernel.h"
+
+using namespace cv;
+using namespace std;
+
+// 差分阈值默认值，差分大于该值的像素为运动区域，可以帮助消除车辆的阴影
+// the Default Difference Threshold, pixels whose difference is greater than it are moving; it helps to remove the shadows of vehicles
+#define DEFAULT_FRAMEDIFF_THRESHOLD 30
+
+// 差分帧数：两帧差分，三帧差分（相邻两次差分相与）
+// Number of Frames of the Difference: two-frame difference, three-frame difference (AND of two adjacent differences)
+#define FRAMEDIFF_TWO_FRAMES    2
+#define FRAMEDIFF_THREE_FRAMES  3
+
+/*===================================================================
+ * 类名：FrameDiff
+ * 说明：帧间差分法；
+ *    保存上一帧灰度图与之前各次差分掩码的环形缓冲，图像尺寸不变时每帧不分配内存；
+ *    N 帧差分：相邻两帧的 N - 1 次差分掩码相与，三帧差分可去除两帧差分的“重影”；
+ *------------------------------------------------------------------
+ * Class: FrameDiff
+ *
+ * Summary:
+ *   Frame Difference Method.
+ *   Keeps ring buffers of the previous gray frame and of the earlier difference masks,
+ * and allocates nothing per frame while the image size stays the same.
+ *   N-frame Difference: the N - 1 difference masks of adjacent frames are ANDed, the
+ * three-frame difference removes the "ghost" of the two-frame difference.
+=====================================================================
+*/
+class FrameDiff
+{
+public:
+    FrameDiff(int threshold = DEFAULT_FRAMEDIFF_THRESHOLD, int num_frames = FRAMEDIFF_TWO_FRAMES);
+
+    // 处理一帧图像（灰度或 BGR），输出运动区域二值图像；前 N - 1 帧输出全零
+    // Process a frame (gray or BGR) and output the Moving Area Binary Image; all zero for the first N - 1 frames
+    void process(Mat src, Mat &mask);
+
+    // 由调用者持有的帧缓冲区处理一帧，GRAY / NV12 / I420 直接读取亮度平面
+    // Process a frame from a caller-owned frame buffer; GRAY / NV12 / I420 read the luma plane directly
+    void process(const FrameView &frame, Mat &mask);
+
+    // 清除环形缓冲，下一帧重新开始
+    // Clear the ring buffers, start again on the next frame
+    void reset();
+
+    // 设置差分阈值
+    // Set the Difference Threshold
+    void setThreshold(int threshold);
+
+    // 设置差分帧数，2 - FRAMEDIFF_MAX_FRAMES，环形缓冲在下一帧重新开始
+    // Set the Number of Frames of the Difference, 2 - FRAMEDIFF_MAX_FRAMES; the ring buffers start again on the next frame
+    void setNumFrames(int n);
+
+private:
+    // 按图像尺寸分配环形缓冲
+    // Allocate the ring buffers by the image size
+    void init(Size size);
+
+    // 灰度图环形缓冲：当前帧与上一帧
+    // Ring Buffer of gray frames: current frame & previous frame
+    Mat gray_ring[2];
+
+    // 上一帧灰度图在环形缓冲中的位置
+    // Position of the previous gray frame in its ring buffer
+    int gray_pos;
+
+    // 差分掩码环形缓冲，N - 1 个，初始化为全零，因此前 N - 1 帧的输出为全零
+    // Ring Buffer of difference masks, N - 1 of them, inited as all zero, so the output is all zero for the first N - 1 frames
+    vector<Mat> mask_ring;
+
+    // 下一个差分掩码在环形缓冲中的位置
+    // Position of the next difference mask in its ring buffer
+    int mask_pos;
+
+    // 自初始化以来处理的帧数
+    // Number of frames processed since init
+    int frame_count;
+
+    // 差分阈值
+    // Difference Threshold
+    int diff_threshold;
+
+    // 差分帧数
+    // Number of Frames of the Difference
+    int num_frames;
+};
+
+#endif // FRAMEDIFF_H
@@ -0,0 +1,139 @@
+/*=================================================================
+ * Vectorized Kernels of Frame Difference Method.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#include "FrameDiffKernel.h"
+
+#if FRAMEDIFF_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/*===================================================================
+ * 函数名：FrameDiffRowScalar
+ * 说明：逐像素完成一行的差分、阈值化与掩码相与（标量版本）；
+ * 参数：
+ *   const unsigned char *cur:  当前帧灰度图的一行
+ *   const unsigned char *prev:  上一帧灰度图的一行
+ *   int width:  像素个数
+ *   int thr:  阈值，差分大于该值的像素为运动区域
+ *   unsigned char *mask:  输出本帧差分掩码的一行，可为 NULL
+ *   const unsigned char *const *and_masks:  之前各帧差分掩码的一行
+ *   int n_and:  之前的差分掩码个数，不超过 FRAMEDIFF_MAX_FRAMES - 2
+ *   unsigned char *out:  输出运动区域二值图像的一行
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: FrameDiffRowScalar
+ *
+ * Summary:
+ *   Difference, Threshold and Mask AND of one row pixel by pixel (Scalar Version).
+ *
+ * Arguments:
+ *   const unsigned char *cur - row of current gray frame
+ *   const unsigned char *prev - row of previous gray frame
+ *   int width - number of pixels
+ *   int thr - threshold, pixels whose difference is greater than it are moving
+ *   unsigned char *mask - output row of this frame's difference mask, may be NULL
+ *   const unsigned char *const *and_masks - rows of the earlier frames' difference masks
+ *   int n_and - number of earlier difference masks, at most FRAMEDIFF_MAX_FRAMES - 2
+ *   unsigned char *out - output row of the Moving Area Binary Image
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiffRowScalar(const unsigned char *cur, const unsigned char *prev, int width, int thr,
+                        unsigned char *mask, const unsigned char *const *and_masks, int n_and,
+                        unsigned char *out)
+{
+    for(int j = 0; j < width; j++)
+    {
+        int d = cur[j] > prev[j] ? cur[j] - prev[j] : prev[j] - cur[j];
+        unsigned char m = d > thr ? 255 : 0;
+        if(mask)
+            mask[j] = m;
+        for(int k = 0; k < n_and; k++)
+            m &= and_masks[k][j];
+        out[j] = m;
+    }
+}
+
+/*===================================================================
+ * 函数名：FrameDiffRow
+ * 说明：向量化完成一行的 8 位差分、阈值化与掩码相与；
+ *    SSE2 每次处理 16 个像素，|a - b| 由两次饱和减法相或得到，不需要转换为浮点；
+ *    d > thr 由 subs(d, thr) != 0 得到，剩余像素使用标量版本；
+ * 参数：
+ *   参数与 FrameDiffRowScalar 相同
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: FrameDiffRow
+ *
+ * Summary:
+ *   8-bit Difference, Threshold and Mask AND of one row with SIMD instructions.
+ *   SSE2 handles 16 pixels at a time. |a - b| is the OR of two saturated subtractions,
+ * with no float conversion, and d > thr is subs(d, thr) != 0. The remaining pixels are
+ * handled by the scalar version.
+ *
+ * Arguments:
+ *   the same as FrameDiffRowScalar
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiffRow(const unsigned char *cur, const unsigned char *prev, int width, int thr,
+                  unsigned char *mask, const unsigned char *const *and_masks, int n_and,
+                  unsigned char *out)
+{
+    int j = 0;
+
+#if FRAMEDIFF_SIMD_SSE2
+    if(thr >= 0 && thr <= 255)
+    {
+        const __m128i vthr = _mm_set1_epi8((char)thr);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_cmpeq_epi8(zero, zero);
+        for(; j <= width - 16; j += 16)
+        {
+            __m128i c = _mm_loadu_si128((const __m128i *)(cur + j));
+            __m128i p = _mm_loadu_si128((const __m128i *)(prev + j));
+            __m128i d = _mm_or_si128(_mm_subs_epu8(c, p), _mm_subs_epu8(p, c));
+            __m128i m = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(d, vthr), zero), ones);
+            if(mask)
+                _mm_storeu_si128((__m128i *)(mask + j), m);
+            for(int k = 0; k < n_and; k++)
+                m = _mm_and_si128(m, _mm_loadu_si128((const __m128i *)(and_masks[k] + j)));
+            _mm_storeu_si128((__m128i *)(out + j), m);
+        }
+    }
+#endif
+
+    if(j < width)
+    {
+        // 剩余像素：之前的掩码指针同样偏移 j
+        // Remaining pixels: the earlier mask pointers are offset by j as well
+        const unsigned char *tail_masks[FRAMEDIFF_MAX_FRAMES];
+        for(int k = 0; k < n_and; k++)
+            tail_masks[k] = and_masks[k] + j;
+        FrameDiffRowScalar(cur + j, prev + j, width - j, thr, mask ? mask + j : NULL,
+                           tail_masks, n_and, out + j);
+    }
+}
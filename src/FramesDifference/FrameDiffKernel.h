@@ -0,0 +1,57 @@
+/*=================================================================
+ * Vectorized Kernels of Frame Difference Method.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+
+#ifndef FRAMEDIFFKERNEL_H
+#define FRAMEDIFFKERNEL_H
+
+#include <cstddef>
+
+// 向量化指令集选择：SSE2 每次处理 16 个像素，否则使用标量代码
+// SIMD Instruction Set: SSE2 handles 16 pixels per instruction, otherwise the scalar code is used.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAMEDIFF_SIMD_SSE2 1
+#endif
+
+// N 帧差分的最大帧数，之前的差分掩码个数不超过 FRAMEDIFF_MAX_FRAMES - 2
+// Maximum Number of Frames of the N-frame Difference, at most FRAMEDIFF_MAX_FRAMES - 2 earlier difference masks
+#define FRAMEDIFF_MAX_FRAMES 8
+
+// 对一行像素一次完成 8 位差分与阈值化，并与之前的差分掩码相与：
+//     m   = |cur - prev| > thr ? 255 : 0
+//     mask = m（mask 不为 NULL 时保存，供之后的帧使用）
+//     out = m & and_masks[0] & ... & and_masks[n_and - 1]
+// 8-bit Difference and Threshold of one row of pixels in a single pass, ANDed with the
+// earlier difference masks:
+//     m   = |cur - prev| > thr ? 255 : 0
+//     mask = m (kept for later frames when mask isn't NULL)
+//     out = m & and_masks[0] & ... & and_masks[n_and - 1]
+void FrameDiffRow(const unsigned char *cur, const unsigned char *prev, int width, int thr,
+                  unsigned char *mask, const unsigned char *const *and_masks, int n_and,
+                  unsigned char *out);
+
+// 标量版本，与向量化版本输出逐位一致
+// Scalar Version, its output is bit-exact with the vectorized version.
+void FrameDiffRowScalar(const unsigned char *cur, const unsigned char *prev, int width, int thr,
+                        unsigned char *mask, const unsigned char *const *and_masks, int n_and,
+                        unsigned char *out);
+
+#endif // FRAMEDIFFKERNEL_H
@@ -1,15 +1,13 @@
 /*=================================================
  * Version:
  * v1.0: 原版程序由IplImage转换为Mat
+ * v1.1: 帧间差分法封装成类: FrameDiff，环形缓冲保存上一帧，8 位差分与阈值化一次完成；
+ * v1.2: 膨胀、腐蚀改为公共模块 RectMorphology 的闭运算，原地进行，与结构元素尺寸无关；
 ===================================================
 */
 
-#include "highgui.h"
-#include "cv.h"
-#include <iostream>
-
-using namespace cv;
-using namespace std;
+#include "FrameDiff.h"
+#include "Common/Morphology.h"
 
 int main(int argc, char *argv[])
 {
@@ -29,65 +27,33 @@ int main(int argc, char *argv[])
         }
     }
 
-    // 用于遍历capture中的帧，通道数为3，需要转化为单通道才可以处理
-    Mat tmpFrame, tmpFrameF;
-    // 当前帧，单通道，uchar / Float
-    Mat currentFrame, currentFrameF;
-    // 上一帧，单通道，uchar / Float
-    Mat previousFrame, previousFrameF;
+    // 用于遍历capture中的帧
+    Mat tmpFrame;
+    // 运动区域二值图像
+    Mat currentFrame;
+
+    // 帧间差分法，阈值 30 可以帮助把车辆的阴影消除掉
+    FrameDiff frameDiff(DEFAULT_FRAMEDIFF_THRESHOLD, FRAMEDIFF_TWO_FRAMES);
 
-    int frameNum = 0;
+    int g_nStructElementSize = 3; //结构元素(内核矩阵)的尺寸
+    // 矩形结构元素，锚点在中心
+    Size element(2 * g_nStructElementSize + 1, 2 * g_nStructElementSize + 1);
+    RectMorphology morphology;
 
     capture >> tmpFrame;
     while(!tmpFrame.empty())
     {
-        capture >> tmpFrame;
-        //tmpFrame=cvQueryFrame(capture);
-        frameNum++;
-        if(frameNum == 1)
-        {
-            // 第一帧先初始化各个结构，为它们分配空间
-            previousFrame.create(tmpFrame.size(), CV_8UC1);
-            currentFrame.create(tmpFrame.size(), CV_8UC1);
-            currentFrameF.create(tmpFrame.size(), CV_32FC1);
-            previousFrameF.create(tmpFrame.size(), CV_32FC1);
-            tmpFrameF.create(tmpFrame.size(), CV_32FC1);
-        }
-
-        if(frameNum >= 2)
-        {
-            // 转化为单通道灰度图，此时currentFrame已经存了tmpFrame的内容
-            cvtColor(tmpFrame, currentFrame, CV_BGR2GRAY);
-            currentFrame.convertTo(tmpFrameF, CV_32FC1);
-            previousFrame.convertTo(previousFrameF, CV_32FC1);
-
-            // 做差求绝对值
-            absdiff(tmpFrameF, previousFrameF, currentFrameF);
-            currentFrameF.convertTo(currentFrame, CV_8UC1);
-            /*
-            在currentFrameMat中找大于20（阈值）的像素点，把currentFrame中对应的点设为255
-            此处阈值可以帮助把车辆的阴影消除掉
-            */
-//            threshold(currentFrameF, currentFrame, 20, 255.0, CV_THRESH_BINARY);
-            threshold(currentFrame, currentFrame, 30, 255, CV_THRESH_BINARY);
-
-            int g_nStructElementSize = 3; //结构元素(内核矩阵)的尺寸
-            // 获取自定义核
-            Mat element = getStructuringElement(MORPH_RECT,
-                                                Size(2 * g_nStructElementSize + 1, 2 * g_nStructElementSize + 1),
-                                                Point( g_nStructElementSize, g_nStructElementSize ));
-            // 膨胀
-            dilate(currentFrame, currentFrame, element);
-            // 腐蚀
-            erode(currentFrame, currentFrame, element);
-        }
+        // 8 位差分与阈值化一次完成，上一帧保存在 FrameDiff 的环形缓冲中
+        frameDiff.process(tmpFrame, currentFrame);
 
-        //把当前帧保存作为下一次处理的前一帧
-        cvtColor(tmpFrame, previousFrame, CV_BGR2GRAY);
+        // 闭运算：先膨胀后腐蚀
+        morphology.close(currentFrame, currentFrame, element);
 
         // 显示图像
         imshow("Camera", tmpFrame);
         imshow("Moving Area", currentFrame);
         waitKey(25);
+
+        capture >> tmpFrame;
     }
 }
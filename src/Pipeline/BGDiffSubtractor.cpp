@@ -0,0 +1,81 @@
+/*=================================================================
+ * Background Subtractor Adapter of the Streaming Background Difference.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Subtractors.h"
+#include "BGDifference/BGDifference.h"
+
+BGDiffSubtractor::BGDiffSubtractor()
+{
+    stream = new BGDiffStream();
+}
+
+BGDiffSubtractor::~BGDiffSubtractor()
+{
+    delete stream;
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：一次遍历完成差分、阈值化与背景更新，输出前景图像并保存背景图像；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ *   Mat &mask:  输出前景模板
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Difference, Threshold & Background Update in one pass, output the Foreground Image
+ * and keep the Background Image.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *   Mat &mask - output Foreground Mask
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void BGDiffSubtractor::process(const FrameView &frame, Mat &mask)
+{
+    stream->process(frame, mask, imgBackground);
+}
+
+void BGDiffSubtractor::resetModel()
+{
+    stream->reset();
+    imgBackground.release();
+}
+
+Mat BGDiffSubtractor::background()
+{
+    return imgBackground;
+}
+
+const char *BGDiffSubtractor::name() const
+{
+    return "bgdiff";
+}
+
+BGDiffStream &BGDiffSubtractor::algorithm()
+{
+    return *stream;
+}
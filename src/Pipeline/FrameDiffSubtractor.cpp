@@ -0,0 +1,81 @@
+/*=================================================================
+ * Background Subtractor Adapter of the Frame Difference.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Subtractors.h"
+#include "FramesDifference/FrameDiff.h"
+
+FrameDiffSubtractor::FrameDiffSubtractor()
+{
+    framediff = new FrameDiff();
+}
+
+FrameDiffSubtractor::~FrameDiffSubtractor()
+{
+    delete framediff;
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：帧间差分，输出运动区域；模板保存在适配器中，尺寸不变时复用内存；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ *   Mat &mask:  输出前景模板
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Frame Difference, output the Moving Area. The mask is kept in the adapter and reuses
+ * its memory while the image size stays the same.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *   Mat &mask - output Foreground Mask
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void FrameDiffSubtractor::process(const FrameView &frame, Mat &mask)
+{
+    framediff->process(frame, imgMask);
+    mask = imgMask;
+}
+
+void FrameDiffSubtractor::resetModel()
+{
+    framediff->reset();
+}
+
+Mat FrameDiffSubtractor::background()
+{
+    return Mat();
+}
+
+const char *FrameDiffSubtractor::name() const
+{
+    return "framediff";
+}
+
+FrameDiff &FrameDiffSubtractor::algorithm()
+{
+    return *framediff;
+}
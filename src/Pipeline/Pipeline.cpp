@@ -0,0 +1,167 @@
+/*=================================================================
+ * Background Split Pipeline: Ingestion, Background Subtractor, Post-processing  * Constant-time Rectangular Morphology of Binary Masks by van Herk / Gil-Werman Algorithm. Sinks.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Pipeline.h"
+
+DisplaySink::DisplaySink(int delay)
+    : delay(delay)
+{
+}
+
+bool DisplaySink::consume(int64 index, const Mat &frame, const Mat &mask, BGSplitSubtractor &subtractor)
+{
+    imshow("input", frame);
+    imshow(subtractor.name(), mask);
+
+    Mat bg = subtractor.background();
+    if(!bg.empty())
+        imshow("background", bg);
+
+    return waitKey(delay) != 27;
+}
+
+SubtractorPipeline::SubtractorPipeline(BGSplitSubtractor *subtractor)
+    : subtractor(subtractor), frame_index(0)
+{
+    CV_Assert(subtractor != NULL);
+}
+
+void SubtractorPipeline::addPostProcess(int op, Size ksize)
+{
+    PostProcessStep step = {op, ksize};
+    post_steps.push_back(step);
+}
+
+void SubtractorPipeline::addSink(FrameSink *sink)
+{
+    sinks.push_back(sink);
+}
+
+/*===================================================================
+ * 函数名：processFrame
+ * 说明：处理一帧：背景分割、依次后处理并送往各输出端；
+ *    第一个后处理步骤由算法的模板写入流水线自己的模板，之后的步骤原地进行；
+ *    没有后处理时直接输出算法的模板；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ * 返回值：bool，false 表示某个输出端要求停止
+ *------------------------------------------------------------------
+ * Function: processFrame
+ *
+ * Summary:
+ *   Process one Frame: background split, post-process step by step and send to every sink.
+ *   The first Post-processing Step writes from the algorithm's mask into the Pipeline's own
+ * mask, the later steps run in place. Without post-processing the algorithm's mask is the output.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *
+ * Returns:
+ *   bool, false means a sink asked to stop
+=====================================================================
+*/
+bool SubtractorPipeline::processFrame(const FrameView &frame)
+{
+    subtractor->apply(frame, raw_mask);
+
+    if(post_steps.empty())
+        mask = raw_mask;
+    else
+    {
+        // 流水线的模板不能与算法的模板共用内存
+        // The Pipeline's mask must not share memory with the algorithm's mask
+        if(mask.data == raw_mask.data)
+            mask.release();
+
+        const Mat *src = &raw_mask;
+        for(size_t k = 0; k < post_steps.size(); k++)
+        {
+            const PostProcessStep &step = post_steps[k];
+            switch(step.op)
+            {
+            case POSTPROC_OPEN:
+                morphology.open(*src, mask, step.ksize);
+                break;
+            case POSTPROC_CLOSE:
+                morphology.close(*src, mask, step.ksize);
+                break;
+            case POSTPROC_ERODE:
+                morphology.erode(*src, mask, step.ksize);
+                break;
+            default:
+                morphology.dilate(*src, mask, step.ksize);
+                break;
+            }
+            src = &mask;
+        }
+    }
+
+    Mat frame_mat = FrameViewMat(frame);
+    bool keep = true;
+    for(size_t k = 0; k < sinks.size(); k++)
+        keep = sinks[k]->consume(frame_index, frame_mat, mask, *subtractor) && keep;
+    frame_index++;
+
+    return keep;
+}
+
+/*===================================================================
+ * 函数名：run
+ * 说明：逐帧读取视频并送入流水线；
+ * 参数：
+ *   VideoCapture &capture:  视频源
+ *   int64 max_frames:  最多处理的帧数，小于 0 表示不限
+ * 返回值：int64，处理的帧数
+ *------------------------------------------------------------------
+ * Function: run
+ *
+ * Summary:
+ *   Read the video frame by frame and feed the Pipeline.
+ *
+ * Arguments:
+ *   VideoCapture &capture - video source
+ *   int64 max_frames - at most this many frames are processed, below 0 for no limit
+ *
+ * Returns:
+ *   int64, number of processed frames
+=====================================================================
+*/
+int64 SubtractorPipeline::run(VideoCapture &capture, int64 max_frames)
+{
+    int64 processed = 0;
+    while(max_frames < 0 || processed < max_frames)
+    {
+        capture >> frame_buf;
+        if(frame_buf.empty())
+            break;
+
+        processed++;
+        if(!processFrame(MakeFrameView(frame_buf)))
+            break;
+    }
+
+    return processed;
+}
+
+Mat SubtractorPipeline::getMask()
+{
+    return mask;
+}
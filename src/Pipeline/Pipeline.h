@@ -0,0 +1,157 @@
+/*=================================================================
+ * Background Split Pipeline: Ingestion, Background Subtractor, Post-processing  * Constant-time Rectangular Morphology of Binary Masks by van Herk / Gil-Werman Algorithm. Sinks.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "Common/BGSplitSubtractor.h"
+#include "Common/Morphology.h"
+
+using namespace cv;
+using namespace std;
+
+// 后处理：矩形结构元素的开运算、闭运算、腐蚀与膨胀
+// Post-processing: Open, Close, Erode & Dilate with a rectangular structuring element
+#define POSTPROC_OPEN    0
+#define POSTPROC_CLOSE   1
+#define POSTPROC_ERODE   2
+#define POSTPROC_DILATE  3
+
+// 后处理步骤
+// Post-processing Step
+struct PostProcessStep
+{
+    // 运算，POSTPROC_*
+    // Operation, POSTPROC_*
+    int op;
+
+    // 结构元素的宽与高
+    // Width & Height of the structuring element
+    Size ksize;
+};
+
+/*===================================================================
+ * 类名：FrameSink
+ * 说明：流水线的输出端，接收每一帧的输入图像与后处理之后的前景模板；
+ *------------------------------------------------------------------
+ * Class: FrameSink
+ *
+ * Summary:
+ *   Output end of the Pipeline, receives the input image and the post-processed
+ * foreground mask of every frame.
+=====================================================================
+*/
+class FrameSink
+{
+public:
+    virtual ~FrameSink() {}
+
+    // 接收一帧，返回 false 时流水线停止
+    // Receive one Frame, the Pipeline stops when it returns false
+    virtual bool consume(int64 index, const Mat &frame, const Mat &mask, BGSplitSubtractor &subtractor) = 0;
+};
+
+/*===================================================================
+ * 类名：DisplaySink
+ * 说明：显示输入图像、前景模板与背景图像（若有），按 ESC 停止流水线；
+ *------------------------------------------------------------------
+ * Class: DisplaySink
+ *
+ * Summary:
+ *   Show the input image, the foreground mask and the background image (if any),
+ * ESC stops the Pipeline.
+=====================================================================
+*/
+class DisplaySink : public FrameSink
+{
+public:
+    DisplaySink(int delay = 25);
+    bool consume(int64 index, const Mat &frame, const Mat &mask, BGSplitSubtractor &subtractor);
+
+private:
+    // waitKey 的等待时间（毫秒）
+    // Delay of waitKey (ms)
+    int delay;
+};
+
+/*===================================================================
+ * 类名：SubtractorPipeline
+ * 说明：背景分割流水线：输入 -> 背景分割算法 -> 后处理 -> 输出端；
+ *    算法与输出端由调用者持有；后处理输出到流水线自己的模板，不改动算法内部的模板；
+ *    各级缓冲区跨帧复用；
+ *------------------------------------------------------------------
+ * Class: SubtractorPipeline
+ *
+ * Summary:
+ *   Background Split Pipeline: Ingestion -> Background Subtractor -> Post-processing -> Sinks.
+ *   The subtractor and the sinks are owned by the caller. Post-processing writes into the
+ * Pipeline's own mask and leaves the algorithm's internal mask untouched.
+ *   The buffers of every stage are reused across frames.
+=====================================================================
+*/
+class SubtractorPipeline
+{
+public:
+    SubtractorPipeline(BGSplitSubtractor *subtractor);
+
+    // 增加一个后处理步骤，按增加的顺序执行
+    // Add a Post-processing Step, they run in the order they were added
+    void addPostProcess(int op, Size ksize);
+
+    // 增加一个输出端
+    // Add a Sink
+    void addSink(FrameSink *sink);
+
+    // 处理一帧：分割、后处理并送往各输出端，返回 false 表示某个输出端要求停止
+    // Process one Frame: split, post-process and send to every sink; false means a sink asked to stop
+    bool processFrame(const FrameView &frame);
+
+    // 读取视频直到结束、某个输出端要求停止或达到 max_frames 帧（小于 0 表示不限），返回处理的帧数
+    // Read the video until its end, until a sink asks to stop, or for max_frames frames (below 0 for no limit); returns the number of processed frames
+    int64 run(VideoCapture &capture, int64 max_frames = -1);
+
+    // 获取最近一帧后处理之后的前景模板
+    // Get the post-processed Foreground Mask of the last frame
+    Mat getMask();
+
+private:
+    BGSplitSubtractor *subtractor;
+    vector<PostProcessStep> post_steps;
+    vector<FrameSink *> sinks;
+    RectMorphology morphology;
+
+    // 算法输出的前景模板与后处理之后的前景模板
+    // Foreground Mask from the algorithm & after post-processing
+    Mat raw_mask;
+    Mat mask;
+
+    // 视频读取的帧缓冲，跨帧复用
+    // Frame Buffer of video reading, reused across frames
+    Mat frame_buf;
+
+    // 已处理的帧数
+    // Number of processed frames
+    int64 frame_index;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,54 @@
+/*=================================================================
+ * Background Subtractor Adapters of BGDiff, ViBe, ViBe+ & FrameDiff.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Subtractors.h"
+
+/*===================================================================
+ * 函数名：CreateSubtractor
+ * 说明：按名称创建背景分割算法，用于按摄像头选择算法；
+ * 参数：
+ *   const string &name:  "bgdiff"、"vibe"、"vibe+" 或 "framediff"
+ * 返回值：BGSplitSubtractor *，未知名称返回 NULL；由调用者释放
+ *------------------------------------------------------------------
+ * Function: CreateSubtractor
+ *
+ * Summary:
+ *   Create a Background Subtractor by name, used to choose the algorithm per camera.
+ *
+ * Arguments:
+ *   const string &name - "bgdiff", "vibe", "vibe+" or "framediff"
+ *
+ * Returns:
+ *   BGSplitSubtractor *, NULL for an unknown name; released by the caller
+=====================================================================
+*/
+BGSplitSubtractor *CreateSubtractor(const string &name)
+{
+    if(name == "bgdiff")
+        return new BGDiffSubtractor();
+    if(name == "vibe")
+        return new ViBeSubtractor();
+    if(name == "vibe+")
+        return new ViBePlusSubtractor();
+    if(name == "framediff")
+        return new FrameDiffSubtractor();
+    return NULL;
+}
@@ -0,0 +1,180 @@
+/*=================================================================
+ * Background Subtractor Adapters of BGDiff, ViBe, ViBe+  * Constant-time Rectangular Morphology of Binary Masks by van Herk / Gil-Werman Algorithm. FrameDiff.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef SUBTRACTORS_H
+#define SUBTRACTORS_H
+
+#include <string>
+#include "Common/BGSplitSubtractor.h"
+
+using namespace std;
+
+// ViBe 与 ViBe+ 的宏定义同名不同值，不能在同一编译单元中包含，因此适配器只前向声明各算法类，
+// 各自在单独的源文件中实现
+// ViBe & ViBe+ define macros of the same names with different values and can't be included in
+// one translation unit, so the adapters only forward declare the algorithm classes and are each
+// implemented in its own source file
+class BGDiffStream;
+class ViBe;
+class ViBePlus;
+class FrameDiff;
+
+/*===================================================================
+ * 类名：BGDiffSubtractor
+ * 说明：流式背景差分法 BGDiffStream 的适配器，背景为 8 位背景图像；
+ *------------------------------------------------------------------
+ * Class: BGDiffSubtractor
+ *
+ * Summary:
+ *   Adapter of the Streaming Background Difference BGDiffStream, the background is the
+ * 8-bit background image.
+=====================================================================
+*/
+class BGDiffSubtractor : public BGSplitSubtractor
+{
+public:
+    BGDiffSubtractor();
+    ~BGDiffSubtractor();
+
+    Mat background();
+    const char *name() const;
+
+    // 获取算法对象，用于设置参数
+    // Get the algorithm object, used to set its parameters
+    BGDiffStream &algorithm();
+
+protected:
+    void process(const FrameView &frame, Mat &mask);
+    void resetModel();
+
+private:
+    BGDiffStream *stream;
+    Mat imgBackground;
+};
+
+/*===================================================================
+ * 类名：ViBeSubtractor
+ * 说明：ViBe 算法的适配器；第一帧及图像尺寸改变时建立模型，输出全零前景；
+ *------------------------------------------------------------------
+ * Class: ViBeSubtractor
+ *
+ * Summary:
+ *   Adapter of the ViBe Algorithm. The model is built on the first frame and when the
+ * image size changes, with an all-zero foreground.
+=====================================================================
+*/
+class ViBeSubtractor : public BGSplitSubtractor
+{
+public:
+    ViBeSubtractor();
+    ~ViBeSubtractor();
+
+    Mat background();
+    const char *name() const;
+
+    // 获取算法对象，用于设置参数
+    // Get the algorithm object, used to set its parameters
+    ViBe &algorithm();
+
+protected:
+    void process(const FrameView &frame, Mat &mask);
+    void resetModel();
+
+private:
+    ViBe *vibe;
+    bool trained;
+    Size model_size;
+    Mat zero_mask;
+};
+
+/*===================================================================
+ * 类名：ViBePlusSubtractor
+ * 说明：ViBe+ 算法的适配器，前景为分割模板；图像尺寸或帧格式改变时重新建立模型；
+ *------------------------------------------------------------------
+ * Class: ViBePlusSubtractor
+ *
+ * Summary:
+ *   Adapter of the ViBe+ Algorithm, the foreground is the Segment Model. The model is
+ * rebuilt when the image size or the frame format changes.
+=====================================================================
+*/
+class ViBePlusSubtractor : public BGSplitSubtractor
+{
+public:
+    ViBePlusSubtractor();
+    ~ViBePlusSubtractor();
+
+    Mat background();
+    const char *name() const;
+
+    // 获取算法对象，用于设置参数
+    // Get the algorithm object, used to set its parameters
+    ViBePlus &algorithm();
+
+protected:
+    void process(const FrameView &frame, Mat &mask);
+    void resetModel();
+
+private:
+    ViBePlus *vibeplus;
+    Size model_size;
+    // 建立模型的帧格式，BGR 与其他格式的通道数不同，-1 表示尚未建立
+    // Frame Format the model was built with, BGR differs from the others in channel count, -1 before the model is built
+    int model_format;
+};
+
+/*===================================================================
+ * 类名：FrameDiffSubtractor
+ * 说明：帧间差分法 FrameDiff 的适配器，没有背景图像；
+ *------------------------------------------------------------------
+ * Class: FrameDiffSubtractor
+ *
+ * Summary:
+ *   Adapter of the Frame Difference FrameDiff, which has no background image.
+=====================================================================
+*/
+class FrameDiffSubtractor : public BGSplitSubtractor
+{
+public:
+    FrameDiffSubtractor();
+    ~FrameDiffSubtractor();
+
+    Mat background();
+    const char *name() const;
+
+    // 获取算法对象，用于设置参数
+    // Get the algorithm object, used to set its parameters
+    FrameDiff &algorithm();
+
+protected:
+    void process(const FrameView &frame, Mat &mask);
+    void resetModel();
+
+private:
+    FrameDiff *framediff;
+    Mat imgMask;
+};
+
+// 按名称创建背景分割算法："bgdiff"、"vibe"、"vibe+"、"framediff"，未知名称返回 NULL；由调用者释放
+// Create a Background Subtractor by name: "bgdiff", "vibe", "vibe+", "framediff", NULL for an unknown name; released by the caller
+BGSplitSubtractor *CreateSubtractor(const string &name);
+
+#endif // SUBTRACTORS_H
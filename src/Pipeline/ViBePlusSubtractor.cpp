@@ -0,0 +1,96 @@
+/*=================================================================
+ * Background Subtractor Adapter of the ViBe+ Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Subtractors.h"
+#include "ViBe+/ViBePlus.h"
+
+ViBePlusSubtractor::ViBePlusSubtractor()
+{
+    vibeplus = new ViBePlus();
+    model_format = -1;
+}
+
+ViBePlusSubtractor::~ViBePlusSubtractor()
+{
+    delete vibeplus;
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：捕获一帧并运行 ViBe+ 算法，输出分割模板；第一帧建立模型，分割模板为全零；
+ *    图像尺寸或帧格式改变时先重置模型，灰度与 RGB 模式的样本平面不能混用；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ *   Mat &mask:  输出前景模板，引用 ViBe+ 内部的分割模板
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Capture one Frame and run the ViBe+ Algorithm, output the Segment Model. The model is
+ * built on the first frame, with an all-zero Segment Model.
+ *   The model is reset first when the image size or the frame format changes, since the
+ * sample planes of Gray and RGB mode cannot be mixed.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *   Mat &mask - output Foreground Mask, referencing ViBe+'s internal Segment Model
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlusSubtractor::process(const FrameView &frame, Mat &mask)
+{
+    Size size(frame.width, frame.height);
+    if(size != model_size || frame.format != model_format)
+    {
+        vibeplus->reset();
+        model_size = size;
+        model_format = frame.format;
+    }
+
+    vibeplus->FrameCapture(frame);
+    vibeplus->Run();
+    mask = vibeplus->getSegModel();
+}
+
+void ViBePlusSubtractor::resetModel()
+{
+    vibeplus->reset();
+    model_size = Size();
+    model_format = -1;
+}
+
+Mat ViBePlusSubtractor::background()
+{
+    return Mat();
+}
+
+const char *ViBePlusSubtractor::name() const
+{
+    return "vibe+";
+}
+
+ViBePlus &ViBePlusSubtractor::algorithm()
+{
+    return *vibeplus;
+}
@@ -0,0 +1,97 @@
+/*=================================================================
+ * Background Subtractor Adapter of the ViBe Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include "Subtractors.h"
+#include "ViBe/Vibe.h"
+
+ViBeSubtractor::ViBeSubtractor()
+{
+    vibe = new ViBe();
+    trained = false;
+}
+
+ViBeSubtractor::~ViBeSubtractor()
+{
+    delete vibe;
+}
+
+/*===================================================================
+ * 函数名：process
+ * 说明：第一帧及图像尺寸改变时建立样本库，输出全零前景；之后运行 ViBe 算法，输出前景模型；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ *   Mat &mask:  输出前景模板，引用 ViBe 内部的前景模型
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: process
+ *
+ * Summary:
+ *   Build the Sample Library on the first frame and when the image size changes, with an
+ * all-zero foreground; then run the ViBe Algorithm and output the Foreground Model.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *   Mat &mask - output Foreground Mask, referencing ViBe's internal Foreground Model
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBeSubtractor::process(const FrameView &frame, Mat &mask)
+{
+    Size size(frame.width, frame.height);
+    if(!trained || size != model_size)
+    {
+        vibe->init(frame);
+        vibe->ProcessFirstFrame(frame);
+        trained = true;
+        model_size = size;
+
+        zero_mask.create(size, CV_8UC1);
+        zero_mask = Scalar::all(0);
+        mask = zero_mask;
+        return ;
+    }
+
+    vibe->Run(frame);
+    mask = vibe->getFGModel();
+}
+
+void ViBeSubtractor::resetModel()
+{
+    vibe->deleteSamples();
+    trained = false;
+}
+
+Mat ViBeSubtractor::background()
+{
+    return Mat();
+}
+
+const char *ViBeSubtractor::name() const
+{
+    return "vibe";
+}
+
+ViBe &ViBeSubtractor::algorithm()
+{
+    return *vibe;
+}
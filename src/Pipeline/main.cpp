@@ -0,0 +1,75 @@
+/*=================================================================
+ * Run any Background Split Algorithm through the common Pipeline using OpenCV Library.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include <iostream>
+#include "Pipeline.h"
+#include "Subtractors.h"
+
+// 用法：Pipeline_test [bgdiff | vibe | vibe+ | framediff] [视频路径]
+// Usage: Pipeline_test [bgdiff | vibe | vibe+ | framediff] [video path]
+int main(int argc, char* argv[])
+{
+    string algorithm = argc > 1 ? argv[1] : "vibe";
+
+    VideoCapture capture;
+    if(argc > 2)
+        capture = VideoCapture(argv[2]);
+    else
+    {
+        capture = VideoCapture("./Video/Camera Road 01.avi");
+        if(!capture.isOpened())
+        {
+            capture = VideoCapture("../Video/Camera Road 01.avi");
+            if(!capture.isOpened())
+                capture = VideoCapture("../../Video/Camera Road 01.avi");
+        }
+    }
+    if(!capture.isOpened())
+    {
+        cout<<"ERROR: Did't find this video!"<<endl;
+        return 0;
+    }
+
+    BGSplitSubtractor *subtractor = CreateSubtractor(algorithm);
+    if(subtractor == NULL)
+    {
+        cout<<"ERROR: Unknown algorithm: "<<algorithm<<endl;
+        return -1;
+    }
+
+    // 输入 -> 背景分割 -> 3x3 开运算去除孤立噪点 -> 显示
+    // Ingestion -> Background Split -> 3x3 Open removes isolated noise -> Display
+    SubtractorPipeline pipeline(subtractor);
+    pipeline.addPostProcess(POSTPROC_OPEN, Size(3, 3));
+    DisplaySink display;
+    pipeline.addSink(&display);
+
+    pipeline.run(capture);
+
+    const SubtractorStats &stats = subtractor->stats();
+    cout << "Algorithm: " << subtractor->name() << endl;
+    cout << "Frames: " << stats.frames << endl;
+    if(stats.frames > 0)
+        cout << "Time per Frame: " << stats.total_ms / stats.frames << "ms (max " << stats.max_ms << "ms)" << endl;
+
+    delete subtractor;
+    return 0;
+}
@@ -47,13 +47,15 @@
  *=================================================================
  */
 
+#include <climits>
 #include "ViBePlus.h"
+#include "ViBePlusKernel.h"
 
 /*===================================================================
  * 构造函数：ViBePlus
  * 说明：初始化ViBe+算法部分参数；
  * 参数：
- *   int num_sam:  每个像素点的样本个数
+ *   int num_sam:  每个像素点的样本个数，(0, RAND_TABLE_MAX_SAMPLES]
  *   int min_match:  #min指数
  *   int r:  Sqthere半径
  *   int rand_sam:  子采样概率
@@ -65,7 +67,7 @@
  *   Init several arguments of ViBe+ Algorithm.
  *
  * Arguments:
- *   int num_sam - Number of pixel's samples
+ *   int num_sam - Number of pixel's samples, (0, RAND_TABLE_MAX_SAMPLES]
  *   int min_match - Match Number of make pixel as Background
  *   int r - Radius of pixel value
  *   int rand_sam - the probability of random sample
@@ -74,11 +76,44 @@
 */
 ViBePlus::ViBePlus(int num_sam, int min_match, int r, int rand_sam)
 {
+    // 样本编号在随机数表中以 uchar 存储；灰度和 samples_sum 为 ushort，需要 num_samples * 255 <= 65535
+    // Sample IDs are stored as uchar in the Random Number Tables; the Gray Sum samples_sum is ushort,
+    // so num_samples * 255 <= 65535 is needed
+    CV_Assert(num_sam > 0 && num_sam <= RAND_TABLE_MAX_SAMPLES && num_sam <= USHRT_MAX / 255);
+
     num_samples = num_sam;
     num_min_matches = min_match;
     radius = r;
     random_sample = rand_sam;
     count = 0;
+    random_mode = RANDOM_MODE_RNG;
+    pipeline_mode = PIPELINE_STAGED;
+    num_threads = 0;
+    update_log_q = RandTable::geometricLogQ(random_sample);
+    samples = NULL;
+    samples_Frame = NULL;
+    samples_FrameNorm2 = NULL;
+    samples_sqsum = NULL;
+    samples_sum = NULL;
+    samples_AdaThreshold = NULL;
+    samples_ForeNum = NULL;
+    samples_BlinkLevel = NULL;
+    plane_size = 0;
+
+    //===================================================================
+    //   自适应阈值 AdaThreshold = sigma * AMP_MULTIFACTOR，sigma = sqrt(N * sqsum - sum * sum) / N；
+    //   灰度距离为整数，dist < AdaThreshold 与 dist < ceil(AdaThreshold) 等价，
+    //   而 ceil(AdaThreshold) <= t 等价于 N * sqsum - sum * sum <= (t * N / AMP_MULTIFACTOR)^2；
+    //------------------------------------------------------------------
+    //   Adaptive Threshold AdaThreshold = sigma * AMP_MULTIFACTOR, sigma = sqrt(N * sqsum - sum * sum) / N.
+    //   Gray distance is integer, so dist < AdaThreshold equals dist < ceil(AdaThreshold),
+    // and ceil(AdaThreshold) <= t equals N * sqsum - sum * sum <= (t * N / AMP_MULTIFACTOR)^2.
+    //====================================================================
+    for(int t = ADA_THRESHOLD_MIN; t < ADA_THRESHOLD_MAX; t++)
+    {
+        double limit = t * num_samples / AMP_MULTIFACTOR;
+        ada_limits[t - ADA_THRESHOLD_MIN] = (int)min(limit * limit, (double)INT_MAX);
+    }
 }
 
 /*===================================================================
@@ -98,8 +133,9 @@ ViBePlus::~ViBePlus(void)
 
 /*===================================================================
  * 函数名：FrameCapture
- * 说明：捕获一帧图像且根据捕获图像的格式分别存储（支持 RGB 与灰度模式）；；
- *
+ * 说明：捕获一帧图像且根据捕获图像的格式分别存储（支持 RGB 与灰度模式）；
+ *    只引用源图像的数据，不拷贝，源图像在 Run 结束之前不能被修改；
+ *    RGB 模式的灰度图转换到 Gray_buf 中，复用其内存；
  * 参数：
  *   Mat img:  源图像
  * 返回值：void
@@ -109,6 +145,9 @@ ViBePlus::~ViBePlus(void)
  * Summary:
  *   Capture One Frame From Video, and Save according to Image's Format
  * (Support RGB & Gray)
+ *   Only the data of source image is referenced without copying, so the source image
+ * must not be modified until Run returns. The gray image of RGB mode is converted
+ * into Gray_buf, reusing its memory.
  *
  * Arguments:
  *   Mat img - source image
@@ -119,19 +158,48 @@ ViBePlus::~ViBePlus(void)
 */
 void ViBePlus::FrameCapture(Mat img)
 {
-    img.copyTo(Frame);
+    Frame = img;
     if(img.channels() == 3)
     {
-        cvtColor(Frame, Gray, CV_BGR2GRAY);
+        cvtColor(Frame, Gray_buf, CV_BGR2GRAY);
+        Gray = Gray_buf;
         Channels = 3;
     }
     else
     {
-        img.copyTo(Gray);
+        Gray = img;
         Channels = 1;
     }
 }
 
+/*===================================================================
+ * 函数名：FrameCapture
+ * 说明：由调用者持有的帧缓冲区捕获一帧图像，不拷贝；
+ *    GRAY / NV12 / I420 格式直接读取亮度平面，以灰度模式运行，不做颜色转换；
+ *    BGR 格式以 RGB 模式运行；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: FrameCapture
+ *
+ * Summary:
+ *   Capture One Frame from a caller-owned frame buffer without copying.
+ *   GRAY / NV12 / I420 read the luma plane directly and run in Gray mode without
+ * colour conversion. BGR runs in RGB mode.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::FrameCapture(const FrameView &frame)
+{
+    FrameCapture(FrameViewMat(frame));
+}
+
 /*===================================================================
  * 函数名：init
  * 说明：背景模型初始化；
@@ -159,69 +227,58 @@ void ViBePlus::init()
         return ;
     }
 
-    // 动态分配三维数组，samples[][][num_samples]存储前景被连续检测的次数
-    // Dynamic Assign 3-D Array.
-    // sample[img.rows][img.cols][num_samples] is a 3-D Array which includes all pixels' samples.
-    samples = new unsigned char **[Gray.rows];
-
-    // 为 BGR 通道样本库动态分配数组
-    // Dynamic Assign Array for BGR Channels of Samples
-    samples_Frame = new unsigned char ***[Frame.rows];
-
-    // 为样本集平均值、方差动态分配数组
-    // Dynamic Assign Array for Average Values and Variance Values of Samples
-    samples_sumsqr = new double *[Gray.rows];
-    samples_ave = new double *[Gray.rows];
-
-    // 为样本集相关信息矩阵初始化，动态分配数组
-    // Dynamic Assign Array for Other Relative Information of Samples
-    samples_ForeNum = new int *[Gray.rows];
-    samples_BGInner = new bool *[Gray.rows];
-    samples_InnerState = new int *[Gray.rows];
-    samples_BlinkLevel = new int *[Gray.rows];
-    samples_MaxInnerGrad = new int *[Gray.rows];
-
-    for (int i = 0; i < Gray.rows; i++)
+    //===================================================================
+    //   样本库一次分配：num_samples 个灰度样本平面，RGB 模式下再加 3 * num_samples 个 BGR 通道样本平面；
+    //   创建样本库时，所有样本全部初始化为0
+    //------------------------------------------------------------------
+    //   Sample Library is one allocation: num_samples gray sample planes, plus 3 * num_samples
+    // BGR channel sample planes in RGB mode. All Samples init as 0 When Creating Sample Library.
+    //====================================================================
+    plane_size = ((size_t)Gray.rows * Gray.cols + 63) & ~(size_t)63;
+    size_t num_planes = Channels == 3 ? 4 * num_samples : num_samples;
+    samples = (uchar *)fastMalloc(plane_size * num_planes);
+    memset(samples, 0, plane_size * num_planes);
+
+    // 为 BGR 通道样本库及其模平方缓存分配连续平面
+    // Assign contiguous Planes for BGR Channels of Samples and their cached Squared Norms
+    if(Channels == 3)
     {
-        samples[i] = new uchar *[Gray.cols];
-        samples_Frame[i] = new uchar **[Frame.cols];
-        samples_sumsqr[i] = new double [Gray.cols];
-        samples_ave[i] = new double [Gray.cols];
-        samples_ForeNum[i] = new int [Gray.cols];
-        samples_BGInner[i] = new bool [Gray.cols];
-        samples_InnerState[i] = new int [Gray.cols];
-        samples_BlinkLevel[i] = new int [Gray.cols];
-        samples_MaxInnerGrad[i] = new int [Gray.cols];
-
-        for (int j = 0; j < Gray.cols; j++)
-        {
-            samples[i][j] =new uchar [num_samples];
-            samples_Frame[i][j] = new uchar *[num_samples];
-            samples_sumsqr[i][j] = 0;
-            samples_ave[i][j] = 0;
-            samples_ForeNum[i][j] = 0;
-            samples_BGInner[i][j] = false;
-            samples_InnerState[i][j] = 0;
-            samples_BlinkLevel[i][j] = 0;
-            samples_MaxInnerGrad[i][j] = 0;
-
-            for (int k = 0; k < num_samples + 1; k++)
-            {
-                // 创建样本库时，所有样本全部初始化为0
-                // All Samples init as 0 When Creating Sample Library.
-                samples[i][j][k] = 0;
-
-                // 创建样本库时，样本库RGB通道全部初始化为0
-                // All RGB Channels of Samples Init as 0 When Creating Sample Library.
-                samples_Frame[i][j][k] = new uchar [3];
-                for(int m = 0; m < 3; m++)
-                    samples_Frame[i][j][k][m] = 0;
-            }
-        }
+        samples_Frame = samples + plane_size * num_samples;
+        samples_FrameNorm2 = (int *)fastMalloc(plane_size * num_samples * sizeof(int));
+        memset(samples_FrameNorm2, 0, plane_size * num_samples * sizeof(int));
     }
 
+    //===================================================================
+    //   像素状态平面一次分配：灰度平方和、灰度和、自适应阈值、连续前景次数、闪烁等级；
+    //   按元素宽度从大到小排列，各平面保持对齐
+    //------------------------------------------------------------------
+    //   Pixel State Planes are one allocation: Sum of Squares, Sum, Adaptive Threshold,
+    // Foreground Count and Blink Level, ordered from the widest element so every plane stays aligned.
+    //====================================================================
+    size_t state_size = plane_size * (sizeof(uint) + sizeof(ushort) + 3 * sizeof(uchar));
+    uchar *state = (uchar *)fastMalloc(state_size);
+    memset(state, 0, state_size);
+    samples_sqsum = (uint *)state;
+    samples_sum = (ushort *)(state + plane_size * sizeof(uint));
+    samples_AdaThreshold = state + plane_size * (sizeof(uint) + sizeof(ushort));
+    samples_ForeNum = samples_AdaThreshold + plane_size;
+    samples_BlinkLevel = samples_ForeNum + plane_size;
+    memset(samples_AdaThreshold, ADA_THRESHOLD_MIN, plane_size);
+
     SegModel = Mat::zeros(Gray.size(),CV_8UC1);
     UpdateModel = Mat::zeros(Gray.size(),CV_8UC1);
+
+    // 位压缩分割模板，上一帧模板全部为背景，与八邻域状态位全部初始化为0等价
+    // Bit-packed Segment Models, the Previous one is all Background, which is equivalent to all State Bits initialized as 0
+    SegBits.create(Gray.rows, Gray.cols);
+    PrevSegBits.create(Gray.rows, Gray.cols);
+    ChangedBits.create(Gray.rows, Gray.cols);
+
+    // 按当前图像宽度重新生成随机数表
+    // Generate Random Number Tables again for current image width
+    rand_table = RandTable();
+    if(random_mode == RANDOM_MODE_TABLE)
+        rand_table.init(num_samples, random_sample, Gray.cols, ((uint64)rng.next() << 32) | rng.next());
 }
 
 /*===================================================================
@@ -258,6 +315,7 @@ void ViBePlus::ProcessFirstFrame()
     {
         for(int j = 0; j < Gray.cols; j++)
         {
+            size_t offset = (size_t)i * Gray.cols + j;
             for(int k = 0 ; k < num_samples; k++)
             {
                 // 随机选择num_samples个邻域像素点，构建背景模型
@@ -275,34 +333,23 @@ void ViBePlus::ProcessFirstFrame()
 
                 // 为样本库赋随机值
                 // Set random pixel's Value for Sample Library
-                samples[i][j][k] = Gray.at<uchar>(row, col);
+                uchar val = Gray.at<uchar>(row, col);
+                samples[k * plane_size + offset] = val;
 
                 // 为RGB通道样本库赋随机值
                 // Set random pixel's Value for Sample Libraries' RGB Channels
-                for(int m = 0; m < 3; m++)
-                    samples_Frame[i][j][k][m] = Frame.at<Vec3b>(row, col)[m];
+                if(Channels == 3)
+                    SetPixFrameSample(i, j, k, Frame.ptr<uchar>(row) + 3 * col);
 
-                // 累加当前像素样本集灰度值
-                // Accumulate Current Pixel's Sample Library's Gray Values
-                samples_ave[i][j] += samples[i][j][k];
+                // 累加当前像素样本集灰度值与灰度平方值
+                // Accumulate Current Pixel's Sample Library's Gray Values & Squared Gray Values
+                samples_sum[offset] += val;
+                samples_sqsum[offset] += val * val;
             }
 
-            // 首次计算当前像素点样本集平均值灰度
-            // Calculate Current Pixel's Sample Library's Gray Average Value Firstly
-            samples_ave[i][j] /= num_samples;
-
-            //========================================
-            //        计算方差值  |  Calculate the Variance
-            //========================================
-            for(int k = 0 ; k < num_samples; k++)
-            {
-                // 累加与均值差值的平方
-                // Accumulate Current Pixel's Square Value of the Difference between Current Value and Average.
-                samples_sumsqr[i][j] += pow(samples[i][j][k] - samples_ave[i][j], 2);
-            }
-            // 首次获得样本方差值
-            // Calculate Current Pixel's Sample Library's Variance Value Firstly
-            samples_sumsqr[i][j] /= num_samples;
+            // 首次计算当前像素点样本集的自适应阈值
+            // Calculate Current Pixel's Sample Library's Adaptive Threshold Firstly
+            samples_AdaThreshold[offset] = (uchar)CalcuAdaThreshold(samples_sum[offset], samples_sqsum[offset]);
         }
     }
 }
@@ -310,6 +357,8 @@ void ViBePlus::ProcessFirstFrame()
 /*===================================================================
  * 函数名：Run
  * 说明：运行 ViBe 算法
+ *    PIPELINE_STAGED 模式下依次调用 ExtractBG、CalcuUpdateModel 与 Update，每一步在行条带上并行处理；
+ * PIPELINE_FUSED 模式下按行流水线单次遍历整帧；
  *
  * 返回值：void
  *------------------------------------------------------------------
@@ -317,6 +366,9 @@ void ViBePlus::ProcessFirstFrame()
  *
  * Summary:
  *   Run the ViBe Algorithm.
+ *   ExtractBG, CalcuUpdateModel & Update are called one after another in PIPELINE_STAGED
+ * mode, each of them runs on row bands in parallel; the frame is processed in one
+ * row-pipelined sweep in PIPELINE_FUSED mode.
  *
  * Returns:
  *   void
@@ -344,6 +396,13 @@ void ViBePlus::Run()
         return ;
     }
 
+    if(pipeline_mode == PIPELINE_FUSED)
+    {
+        RunFused();
+        count++;
+        return ;
+    }
+
     //=============================================
     //       一、提取分割模板
     //--------------------------------------------------------
@@ -371,594 +430,1271 @@ void ViBePlus::Run()
 }
 
 /*===================================================================
- * 函数名：ExtractBG
- * 说明：提取分割模板
+ * 类名：ViBePlusBandInvoker
+ * 说明：在 OpenCV 线程池中并行处理 ViBe+ 的行条带；
+ *------------------------------------------------------------------
+ * Class: ViBePlusBandInvoker
  *
+ * Summary:
+ *   Process Row Bands of ViBe+ in parallel on OpenCV's thread pool.
+=====================================================================
+*/
+class ViBePlusBandInvoker : public ParallelLoopBody
+{
+public:
+    ViBePlusBandInvoker(ViBePlus *v, void (ViBePlus::*f)(ViBePlusBand &))
+        : vibeplus(v), func(f)
+    {
+    }
+
+    void operator()(const Range &range) const
+    {
+        for(int b = range.start; b < range.end; b++)
+            (vibeplus->*func)(vibeplus->bands[b]);
+    }
+
+private:
+    ViBePlus *vibeplus;
+    void (ViBePlus::*func)(ViBePlusBand &);
+};
+
+/*===================================================================
+ * 函数名：PrepareBands
+ * 说明：把图像划分为行条带，每个条带至少 VIBEPLUS_MIN_BAND_ROWS 行；
+ *    由跨帧的随机数生成器为每个条带生成种子，使每帧的随机更新模式都不相同；
+ * 参数：
+ *   int nbands:  行条带个数
  * 返回值：void
  *------------------------------------------------------------------
- * Function: ExtractBG
+ * Function: PrepareBands
  *
  * Summary:
- *   Run the ViBe Algorithm.
+ *   Split the image into Row Bands, every band has VIBEPLUS_MIN_BAND_ROWS rows at least.
+ *   Every band is seeded from the frame-persistent generator, so the random update pattern
+ * changes every frame.
+ *
+ * Arguments:
+ *   int nbands - Number of Row Bands
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::ExtractBG()
+void ViBePlus::PrepareBands(int nbands)
 {
-    RNG rng;
-    int k = 0, dist = 0, matches = 0;
-    for(int i = 0; i < Gray.rows; i++)
+    nbands = max(1, min(nbands, Gray.rows / VIBEPLUS_MIN_BAND_ROWS));
+    bands.resize(nbands);
+    for(int b = 0; b < nbands; b++)
     {
-        for(int j = 0; j < Gray.cols; j++)
-        {
-            //==============================================
-            //        计算自适应阈值  |  Calculate Adaptive Threshold
-            //==============================================
-            // 距离的自适应阈值
-            // Adaptive Threshold of Distance
-            double AdaThreshold = 20, sigma = 0;
-
-            // 根据方差计算标准差
-            // Calculate Standard Deviation According to Variance Value
-            sigma = sqrt(samples_sumsqr[i][j]);
-
-            // 计算得到的距离自适应阈值
-            // Calculate Adaptive Threshold
-            AdaThreshold = sigma * AMP_MULTIFACTOR;
-
-            // 调整自适应阈值范围
-            // Adjust Range of Adaptive Threshold
-            if(AdaThreshold < 20)   AdaThreshold = 20;
-            if(AdaThreshold > 40)   AdaThreshold = 40;
-
-            //=============================================
-            //        计算颜色畸变与匹配情况
-            //--------------------------------------------------------
-            //    Calculate Color Distortion & Sample Match Number
-            //=============================================
-            // 当前帧在 (i, j) 点的 RGB 通道值
-            // (i, j) Pixel of Current Frame's RGB Channels Values
-            int R, G, B;
-            B = Frame.at<Vec3b>(i, j)[0]; G = Frame.at<Vec3b>(i, j)[1]; R = Frame.at<Vec3b>(i, j)[2];
-            for(k = 0, matches = 0; matches < num_min_matches && k < num_samples; k++)
-            {
-                // 当前帧在 (i, j) 点第 k 个样本的 RGB 通道值
-                // Number k Sample in (i, j) Pixel of Current Frame's RGB Channels Values
-                int R_sam, G_sam, B_sam;
-                B_sam = samples_Frame[i][j][k][0]; G_sam = samples_Frame[i][j][k][1]; R_sam = samples_Frame[i][j][k][2];
-
-                // 计算颜色畸变
-                // Calculate Color Distortion
-                double colordist, RGB_Norm2, RGBSam_Norm2, RGB_Vec, p2;
-                RGB_Norm2 = pow(B, 2) + pow(G, 2) + pow(R, 2);
-                RGBSam_Norm2 = pow(B_sam, 2) + pow(G_sam, 2) + pow(R_sam, 2);
-                RGB_Vec = R_sam * R + G_sam * G + B_sam * B; RGB_Vec = pow(RGB_Vec, 2);
-                p2 = RGB_Vec / RGBSam_Norm2;
-                colordist = RGB_Norm2 > p2 ? sqrt(RGB_Norm2 - p2) : 0;
-
-                //=============================================
-                // 若当前值与样本值之差小于自适应阈值，且颜色畸变值小于20，满足匹配条件；
-                // If: (1) the Difference of Current Value and Sample's Value is less than Adaptive Threshold;
-                //      (2) Color Distortion is less than 20;
-                // Then:  Sample Match.
-                //=============================================
-                dist = abs(samples[i][j][k] - Gray.at<uchar>(i, j));
-                if (dist < AdaThreshold && colordist < 20)
-                    matches++;
-            }
-
-            /*===================================================================
-             * 说明：
-             *      当前像素值与样本库中值匹配次数较高，则认为是背景像素点；
-             *      此时更新前景统计次数、更新前景模型、更新该像素模型样本值、更新该像素点邻域像素点的模型样本值
-             *------------------------------------------------------------------
-             * Summary:
-             *   the Match Times of current pixel value and samples in library is large enough to
-             * regard current pixel as a Background pixel.
-             *   Then it needs to be done:
-             *   - Run the times of Foreground Statistic
-             *   - Run Foreground Model
-             *   - Run model sample library of this pixel probably
-             *   - Run model sample library of this pixel's neighborhood pixel probably
-            =====================================================================
-            */
-            //========================================
-            //        前景提取   |   Extract Foreground Areas
-            //========================================
-            if (matches >= num_min_matches)
-            {
-                // 已经认为是背景像素，故该像素的前景统计次数置0
-                // This pixel has regard as a background pixel, so the count of this pixel's foreground statistic set as 0
-                samples_ForeNum[i][j]=0;
-
-                // 该像素点被的前景模型像素值置0
-                // Set Foreground Model's pixel as 0
-                SegModel.at<uchar>(i, j) = 0;
-            }
-            /*===================================================================
-             * 说明：
-             *      当前像素值与样本库中值匹配次数较低，则认为是前景像素点；
-             *      此时需要更新前景统计次数、判断更新前景模型；
-             *------------------------------------------------------------------
-             * Summary:
-             *   the Match Times of current pixel value and samples in library is small enough to
-             * regard current pixel as a Foreground pixel.
-             *   Then it needs to be done:
-             *   - Run the times of Foreground Statistic
-             *   - Judge and Run Foreground Model
-            =====================================================================
-            */
-            else
-            {
-                // 已经认为是前景像素，故该像素的前景统计次数+1
-                // This pixel has regard as a foreground pixel, so the count of this pixel's foreground statistic plus 1
-                samples_ForeNum[i][j]++;
-
-                // 该像素点被的前景模型像素值置255
-                // Set Foreground Model's pixel as 255
-                SegModel.at<uchar>(i, j) = 255;
-
-                // 如果某个像素点连续50次被检测为前景，则认为一块静止区域被误判为运动，将其更新为背景点
-                // if this pixel is regarded as foreground for more than 50 times, then we regard this static area as dynamic area by mistake, and Run this pixel as background one.
-                if(samples_ForeNum[i][j] > 50)
-                {
-                    int random = rng.uniform(0, num_samples);
-                    samples[i][j][random] = Gray.at<uchar>(i, j);
-
-                    // 同时更新RGB通道样本库
-                    // Update RGB Channels' Values of Sample Libraries
-                    for(int m = 0; m < 3; m++)
-                        samples_Frame[i][j][random][m] = Frame.at<Vec3b>(i, j)[m];
-                }
-            }
-        }
+        ViBePlusBand &band = bands[b];
+        band.row_begin = (int)((int64)Gray.rows * b / nbands);
+        band.row_end = (int)((int64)Gray.rows * (b + 1) / nbands);
+        band.rng = RNG(((uint64)rng.next() << 32) | rng.next());
+        band.deferred.clear();
     }
 }
 
 /*===================================================================
- * 函数名：CalcuUpdateModel
- * 说明：根据已经得到的分割模板，计算更新模板
+ * 函数名：ForEachBand
+ * 说明：在 OpenCV 线程池中对每个行条带并行调用 func，全部条带完成后返回；
+ *    条带只写入自己的行，读取相邻条带的边界行（一像素的光环）须在前一次调用中完成；
+ * 参数：
+ *   void (ViBePlus::*func)(ViBePlusBand &):  条带处理函数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ForEachBand
+ *
+ * Summary:
+ *   Call func on every Row Band in parallel on OpenCV's thread pool, and return after all
+ * bands have finished.
+ *   A band only writes its own rows; the border rows of neighbour bands it reads (the
+ * one-pixel halo) must be finished by a previous call.
+ *
+ * Arguments:
+ *   void (ViBePlus::*func)(ViBePlusBand &) - work on a band
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::ForEachBand(void (ViBePlus::*func)(ViBePlusBand &))
+{
+    if(bands.size() == 1)
+        (this->*func)(bands[0]);
+    else
+        parallel_for_(Range(0, (int)bands.size()), ViBePlusBandInvoker(this, func));
+}
+
+/*===================================================================
+ * 函数名：ApplyDeferred
+ * 说明：按条带顺序写入延迟的样本更新，更新像素在更新模板中已经不是背景的除外；
  *
  * 返回值：void
  *------------------------------------------------------------------
- * Function: CalcuUpdateModel
+ * Function: ApplyDeferred
  *
  * Summary:
- *   Calculate Update Model from Segment Model.
+ *   Write the Deferred Sample Updates in band order, except those whose updating pixel is
+ * no more background in Update Model.
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::CalcuUpdateModel()
+void ViBePlus::ApplyDeferred()
 {
-    //========================================================
-    //    更新蒙版的计算，填充更新蒙版前景空洞区域
-    //-----------------------------------------------
-    //   Calculate Update Model, and Fill Foreground Hole Areas of Update Model
-    //========================================================
-    SegModel.copyTo(UpdateModel);
-    Mat imgtmp;
-    vector<vector<Point> > contours;
-    vector<Vec4i> hierarchy;
-    UpdateModel.copyTo(imgtmp);
-
-    // 提取轮廓
-    // Extract Contours
-    findContours(imgtmp, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_NONE);
-    for(int i = 0; i < contours.size(); i++)
+    for(size_t b = 0; b < bands.size(); b++)
     {
-        // 一级父轮廓
-        // Level 1 of Father Contour
-        int father = hierarchy[i][3];
-        // 二级父轮廓
-        // Level 2 of Father Contour
-        int grandpa;
-        if(father >= 0)
-            grandpa = hierarchy[father][3];
-        else
-            grandpa = -1;
-
-        //===================================================================
-        // 有父轮廓，无两级父轮廓，说明该轮廓是等级为 1 的轮廓，即我们需要的前景空洞区域；
-        //------------------------------------------------------------------
-        // If: (1) Have Level 1 of Father Contour;
-        //      (2) No Level 2 of Father Contour;
-        // Then:  It means this Contour is Level 1 Contour, and it's Foreground Hole Areas we need.
-        //====================================================================
-        if(father >= 0 && grandpa == -1)
+        const vector<ViBePlusDeferredUpdate> &deferred = bands[b].deferred;
+        for(size_t n = 0; n < deferred.size(); n++)
         {
-            // 填充面积 <= 50 的前景空洞区域
-            // Fill Foreground Hole Areas whose Area is less than 50
-            if(contourArea(contours[i]) <= 50)
-                drawContours(UpdateModel, contours, i, Scalar(255), -1);
+            const ViBePlusDeferredUpdate &d = deferred[n];
+            if(UpdateModel.at<uchar>(d.i, d.j) == 0)
+                ApplyUpdate(d.i, d.j, d.row, d.col, d.k);
         }
     }
+}
+
+/*===================================================================
+ * 函数名：RunFused
+ * 说明：按行流水线单次遍历运行 ViBe+；
+ *    第 r 步分类第 r 行，计算第 r - 1 行的闪烁等级，并更新第 r - 2 行，
+ * 样本库的每一行在仍位于缓存中时完成读取与写入：
+ *    - 第 r - 1 行的八邻域状态需要第 r 行的分割结果；
+ *    - 第 r - 2 行的邻居样本更新会写入第 r - 1 行，此时该行已经分类，与分步运行的先后关系一致；
+ *    前景空洞填充需要整帧的分割模板，故可能落在空洞中的少量更新延迟到空洞填充之后处理，
+ * 其余输出与分步运行相同（随机数序列除外）；
+ *
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: RunFused
+ *
+ * Summary:
+ *   Run ViBe+ in one row-pipelined sweep.
+ *   Step r classifies row r, calculates Blink Level of row r - 1 and updates row r - 2,
+ * so every row of the Sample Library is read and written while it is still in cache:
+ *    - the 8 neighbour state of row r - 1 needs the segmentation of row r;
+ *    - the neighbour sample update of row r - 2 writes into row r - 1, which is already
+ *      classified, the same order as the staged run.
+ *   Hole filling needs the whole Segment Model, so the few updates which may fall in a hole
+ * are deferred until the holes are filled. Apart from the random number stream, the output
+ * is the same as the staged run.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::RunFused()
+{
+    const int rows = Gray.rows;
+    const int64 cols = Gray.cols;
 
-    for(int i = 1; i < Gray.rows - 1; i++)
+    // 单次遍历只使用一个条带
+    // One sweep uses a single band
+    PrepareBands(1);
+    ViBePlusBand &band = bands[0];
+    BeginUpdate(band);
+
+    for(int r = 0; r < rows + 2; r++)
     {
-        for(int j = 1; j < Gray.cols - 1; j++)
+        // 分类第 r 行，更新模板的该行先复制分割结果
+        // Classify row r, the row of Update Model copies the segmentation first
+        if(r < rows)
         {
-            // 邻域总状态位
-            // Neighbor Area State Bits
-            int state = 0, maxGrad = 0;
-            //=============================
-            //     判断背景内边缘
-            //-----------------------------------------------
-            //   Judge Background Inner Edge
-            //=============================
-            if(SegModel.at<uchar>(i, j) <= 0)
-            {
-                // 定义邻域范围
-                // Range of Neighbor Area
-                int i_min, i_max, j_min, j_max;
-                i_min = i - 1; i_max = i + 1; j_min = j - 1; j_max = j + 1;
-
-                //==================================
-                //     计算邻域状态，邻域灰度最大梯度；
-                //----------------------------------------------
-                //   Calculate State & Max Gray Gradient of Neighbor Area
-                //==================================
-                for(int i_tmp = i_min; i_tmp <= i_max; i_tmp++)
-                {
-                    for(int j_tmp = j_min; j_tmp <= j_max; j_tmp++)
-                    {
-                        if( !(i_tmp == i && j_tmp == j) )
-                        {
-                            // 邻域内单点状态：前景为1，背景为0
-                            // One Pixel's State of Neighbor Area
-                            // 0 -- Background;  1 -- Foreground
-                            int bitstate = (SegModel.at<uchar>(i_tmp, j_tmp) == 255) ? 1 : 0;
-                            state = (state << 1) + bitstate;
-
-                            // 计算最大梯度
-                            // Calculate Max Gradient
-                            int tmpGrad = Gray.at<uchar>(i, j) - Gray.at<uchar>(i_tmp, j_tmp); tmpGrad = abs(tmpGrad);
-                            if(tmpGrad >= maxGrad)  maxGrad = tmpGrad;
-                        }
-                    }
-                }
-                // 当前状态位限定在8bit，即 0-255 之间
-                // Set State Bits in 8Bits (0 -- 255)
-                state = state & 255;
-
-                // 状态位大于 0，则说明邻域有前景，即当前点为背景内边缘；
-                // If State Bits is larger than 0, it means there is Foreground Point in Neighbor Area, and Current Point Belongs to Background Inner Edge.
-                if(state > 0)
-                    samples_BGInner[i][j] = true;
-                else
-                    samples_BGInner[i][j] = false;
-            }
-            else
-            {
-                samples_BGInner[i][j] = false;
-                samples_InnerState[i][j] = 0;
-            }
-
-            //==================================
-            //         计算闪烁等级
-            //----------------------------------------------
-            //   Calculate Blink Level
-            //==================================
-            if(samples_BGInner[i][j])
-            {
-                // 当前邻域状态与上一帧邻域状态相同，则说明当前点不闪烁；
-                // If Neighbor Area State of Current Frame is same as Previous Frame's, it means Current Pixel is not Blinking.
-                if(state == samples_InnerState[i][j])
-                    samples_BlinkLevel[i][j] = max(samples_BlinkLevel[i][j] - 1, 0);
-                // 当前邻域状态与上一帧邻域状态不同，则说明当前点闪烁；
-                // If Neighbor Area State of Current Frame is not same as Previous Frame's, it means Current Pixel is Blinking.
-                else
-                {
-                    samples_BlinkLevel[i][j] += 15;
-                    samples_BlinkLevel[i][j] = min(samples_BlinkLevel[i][j], 150);
-                }
-            }
-            else
-            {
-                samples_BlinkLevel[i][j] = max(samples_BlinkLevel[i][j] - 1, 0);
-            }
+            ExtractBGRow(r, band);
+            memcpy(UpdateModel.ptr<uchar>(r), SegModel.ptr<uchar>(r), Gray.cols);
+            CalcuChangedRow(r);
+        }
 
-            //==================================
-            //         更新状态位
-            //----------------------------------------------
-            //   Update State Bits
-            //==================================
-            samples_InnerState[i][j] = state;
-            samples_MaxInnerGrad[i][j] = maxGrad;
+        // 计算第 r - 1 行的闪烁等级
+        // Calculate Blink Level of row r - 1
+        if(r - 1 >= 1 && r - 1 <= rows - 2)
+            CalcuBlinkRow(r - 1);
 
-            //==================================
-            //      闪烁等级 > 30，从更新蒙版 UpdateModel 中移除
-            //----------------------------------------------
-            //   If Blink Level is Larger than 30, Then remove this Pixel from Update Model.
-            //==================================
-            if(samples_BlinkLevel[i][j] > 30)
-            {
-                UpdateModel.at<uchar>(i, j) = 255;
-//                SegModel.at<uchar>(i, j) = 0;
-            }
+        // 更新第 r - 2 行
+        // Update row r - 2
+        if(r >= 2)
+        {
+            UpdateRange(band, false, (r - 1) * cols, true);
+            UpdateRange(band, true, (r - 1) * cols, true);
         }
     }
 
     //==================================
-    //         处理分割蒙版前景区域
+    //    填充更新蒙版前景空洞区域，再写入不在空洞中的延迟更新
     //----------------------------------------------
-    //   Process Foreground Areas of Segment Areas
+    //   Fill Foreground Hole Areas of Update Model, then write the Deferred Updates out of the holes
     //==================================
-    SegModel.copyTo(imgtmp);
-    findContours(imgtmp, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_NONE);
-
-    for(int i = 0; i < contours.size(); i++) {
-        // 一级父轮廓
-        // Level 1 of Father Contour
-        int father = hierarchy[i][3];
-        // 二级父轮廓
-        // Level 2 of Father Contour
-        int grandpa;
-        if(father >= 0)
-            grandpa = hierarchy[father][3];
-        else
-            grandpa = -1;
-        //===================================================================
-        // 有一级父轮廓，无两级父轮廓，说明该轮廓是等级为 1 的轮廓，即需要的前景空洞区域；
-        //------------------------------------------------------------------
-        // If: (1) Have Level 1 of Father Contour;
-        //      (2) No Level 2 of Father Contour;
-        // Then:  It means this Contour is Level 1 Contour, and it's Foreground Hole Areas we need.
-        //====================================================================
-        if(father >= 0 && grandpa == -1) {
-            // 填充面积 <= 20 的前景空洞区域
-            // Fill Foreground Hole Areas whose Area is less than 20
-            double area = contourArea(contours[i]);
-            if(area <= 20)
-                drawContours(SegModel, contours, i, Scalar(255), -1);
-        }
+    FillUpdateHoles();
+    ApplyDeferred();
 
-        //===================================================================
-        // 无父轮廓，说明该轮廓是最外围轮廓，即等级为 0 的前景斑点区域；
-        //------------------------------------------------------------------
-        // If:        No Level 1 of Father Contour;
-        // Then:  It means this Contour is Level 0 Contour, and it's Foreground Blob Areas we need.
-        //====================================================================
-        if(father == -1) {
-            // 填充面积 <= 10 的前景斑点区域
-            // Fill Foreground Blob Areas whose Area is less than 10
-            double area = contourArea(contours[i]);
-            if(area < 10)
-                drawContours(SegModel, contours, i, Scalar(0), -1);
-        }
-    }
+    PrevSegBits.swap(SegBits);
+    FilterSegModel();
 }
 
 /*===================================================================
- * 函数名：Update
- * 说明：更新背景模板
+ * 函数名：ExtractBG
+ * 说明：提取分割模板；
+ *    图像被划分为行条带，在 OpenCV 线程池中并行处理，每个条带使用独立种子的随机数生成器；
  *
  * 返回值：void
  *------------------------------------------------------------------
- * Function: Update
+ * Function: ExtractBG
  *
  * Summary:
- *   Update the Update Model.
+ *   Run the ViBe Algorithm.
+ *   The image is split into row bands which run in parallel on OpenCV's thread pool, and
+ * every band draws from its own independently seeded Random Number Generator.
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::Update()
+void ViBePlus::ExtractBG()
 {
-    RNG rng;
-    for(int i = 0; i < Gray.rows; i++)
-    {
-        for(int j = 0; j < Gray.cols; j++)
-        {
-            //===================================================================
-            // 更新模板 UpdateModel 的前景像素点不被用来更新样本库
-            //------------------------------------------------------------------
-            // Foreground Pixels in UpdateModel won't be used to Update Sample Libraries.
-            //====================================================================
-            if (UpdateModel.at<uchar>(i, j) <= 0)
-            {
-                // 已经认为该像素是背景像素，那么它有 1 / φ 的概率去更新自己的模型样本值
-                // This pixel is already regarded as Background Pixel, then it has possibility of 1/φ to Run its model sample's value.
-                int random = rng.uniform(0, random_sample);
-                if (random == 0)
-                {
-                    uchar newVal = Gray.at<uchar>(i, j);
-                    random = rng.uniform(0, num_samples);
-                    // 更新样本集灰度方差
-                    // Update Variance of Gray Value Sample Library
-                    UpdatePixSampleSumSquare(i, j, random, newVal);
-                    samples[i][j][random] = newVal;
-
-                    // 同时更新RGB通道样本库
-                    // Update RGB Channels' Values of Sample Library
-                    for(int m = 0; m < 3; m++)
-                        samples_Frame[i][j][random][m] = Frame.at<Vec3b>(i, j)[m];
-                }
-
-                // 同时也有 1 / φ 的概率去更新它的邻居点的模型样本值
-                // At the same time, it has possibility of 1/φ to Run its neighborhood point's sample value.
-                random = rng.uniform(0, random_sample);
-                if (random == 0)
-                {
-                    //===================================================================
-                    //   根据当前点最大梯度 maxGrad，跳出该次循环，便抑制传播
-                    //------------------------------------------------------------------
-                    //  Jump out of this Loop for Inhibiting Diffusion According to Gray Value Max Gradient of Current Pixel.
-                    //====================================================================
-                    if(samples_MaxInnerGrad[i][j] > 50)     continue;
-
-                    int row, col;
-                    uchar newVal = Gray.at<uchar>(i, j);
-                    random = rng.uniform(0, 9); row = i + c_yoff[random];
-                    random = rng.uniform(0, 9); col = j + c_xoff[random];
-
-                    // 防止选取的像素点越界
-                    // Protect Pixel from Crossing the border
-                    if (row < 0) row = 0;
-                    if (row >= Gray.rows)  row = Gray.rows - 1;
-                    if (col < 0) col = 0;
-                    if (col >= Gray.cols) col = Gray.cols - 1;
-
-                    // 为样本库赋随机值
-                    // Set random pixel's Value for Sample Library
-                    random = rng.uniform(0, num_samples);
-                    UpdatePixSampleSumSquare(row, col, random, newVal);
-                    samples[row][col][random] = newVal;
-
-                    // 同时更新RGB通道样本库
-                    // Update RGB Channels' Values of Sample Libraries
-                    for(int m = 0; m < 3; m++)
-                        samples_Frame[row][col][random][m] = Frame.at<Vec3b>(i, j)[m];
-                }
-            }
-        }
-    }
+    PrepareBands(num_threads > 0 ? num_threads : getNumThreads());
+    ForEachBand(&ViBePlus::ExtractBGBand);
 }
 
 /*===================================================================
- * 函数名：UpdatePixSampleSumSquare
- * 说明：更新当前像素点样本集方差
+ * 函数名：ExtractBGBand
+ * 说明：提取行条带的分割模板；
  * 参数：
- *      int i：行数
- *      int j：列数
- *      int k：样本编号
- *      int val：更新的样本值
+ *   ViBePlusBand &band:  行条带
  * 返回值：void
  *------------------------------------------------------------------
- * Function: UpdatePixSampleSumSquare
+ * Function: ExtractBGBand
  *
  * Summary:
- *   Update Variance of Sample Set of Current Pixel whose location is (i, j)
+ *   Extract the Segment Model of a Row Band.
  *
  * Arguments:
- *   int i - Number of Line
- *   int j - Number of Column
- *   int k - ID in Sample Library
- *   int val - Sample Value Updated
+ *   ViBePlusBand &band - Row Band
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::UpdatePixSampleSumSquare(int i, int j, int k, int val)
+void ViBePlus::ExtractBGBand(ViBePlusBand &band)
 {
-    double res = 0;
-    // 更新当前像素点样本集平均值
-    // Update Average Value of Current Pixel's Sample Library
-    UpdatePixSampleAve(i, j, k, val);
-    // 计算样本集平均值更新后的样本集灰度总平方和
-    // Calculate Sum of Gray Value's Square After Average Value Updated.
-    for(int m = 0; m < num_samples; m++)
-        res += pow(samples[i][j][k] - samples_ave[i][j], 2);
-    res /= num_samples;
-    samples_sumsqr[i][j] = res;
+    for(int i = band.row_begin; i < band.row_end; i++)
+        ExtractBGRow(i, band);
 }
 
 /*===================================================================
- * 函数名：UpdatePixSampleAve
- * 说明：更新当前像素点样本集平均值
+ * 函数名：ExtractBGRow
+ * 说明：提取第 i 行的分割模板，同时写入位压缩分割模板；随机决策来自所在条带；
  * 参数：
  *      int i：行数
- *      int j：列数
- *      int k：样本编号
- *      int val：更新的样本值
+ *      ViBePlusBand &band：第 i 行所在的行条带
  * 返回值：void
  *------------------------------------------------------------------
- * Function: UpdatePixSampleAve
+ * Function: ExtractBGRow
  *
  * Summary:
- *   Update Average Value of Sample Set of Current Pixel whose location is (i, j)
+ *   Extract row i of the Segment Model, and write the Bit-packed Segment Model as well.
+ * The random decisions come from its band.
  *
  * Arguments:
  *   int i - Number of Line
- *   int j - Number of Column
- *   int k - ID in Sample Library
- *   int val - Sample Value Updated
+ *   ViBePlusBand &band - Row Band of row i
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::UpdatePixSampleAve(int i, int j, int k, int val)
+void ViBePlus::ExtractBGRow(int i, ViBePlusBand &band)
 {
-    double res;
-    // 计算原样本集灰度总值
-    // Calculate the sum of Previous Sample Library's Gray Values
-    res = samples_ave[i][j] * num_samples;
-    // 计算更新后的样本集灰度平均值
-    // Calculate the Gray Value Average of Sample Library After Updating
-    res = res - samples[i][j][k] + val;
-    res /= num_samples;
-    samples_ave[i][j] = res;
+    // 使用随机数表时，每行以随机偏移读取随机数表
+    // When using Random Number Tables, every row reads the tables at a random offset
+    const RandEntry *rand_row = rand_table.empty() ? NULL : rand_table.row(band.rng.next());
+
+    // 位压缩分割模板的当前行
+    // Current Row of Bit-packed Segment Model
+    uint64 *seg_bits = SegBits.row(i);
+    memset(seg_bits, 0, SegBits.words * sizeof(uint64));
+
+    //=============================================
+    //        计算颜色畸变与匹配情况
+    //--------------------------------------------------------
+    //    Calculate Color Distortion & Sample Match Number
+    //=============================================
+    //=============================================
+    // 若当前值与样本值之差小于自适应阈值（样本替换时已经更新），且颜色畸变值小于20，满足匹配条件；
+    // 由向量化核函数逐行计算，直接输出分割模板的一行；灰度模式没有颜色信息，颜色畸变视为0；
+    // If: (1) the Difference of Current Value and Sample's Value is less than Adaptive Threshold
+    //         (it is updated when a sample is replaced);
+    //      (2) Color Distortion is less than 20;
+    // Then:  Sample Match.
+    // The vectorized kernel handles a whole row and writes the Segment Model row directly;
+    // Gray mode has no colour information, so Color Distortion is regarded as 0.
+    //=============================================
+    size_t row_offset = (size_t)i * Gray.cols;
+    uchar *seg = SegModel.ptr<uchar>(i);
+    ViBePlusClassifyRow(Gray.ptr<uchar>(i), Channels == 3 ? Frame.ptr<uchar>(i) : NULL,
+                        samples + row_offset,
+                        samples_Frame ? samples_Frame + row_offset : NULL,
+                        samples_FrameNorm2 ? samples_FrameNorm2 + row_offset : NULL,
+                        plane_size, Gray.cols, num_samples, num_min_matches,
+                        samples_AdaThreshold + row_offset, seg);
+
+    for(int j = 0; j < Gray.cols; j++)
+    {
+        /*===================================================================
+         * 说明：
+         *      当前像素值与样本库中值匹配次数较高，则认为是背景像素点；
+         *      此时更新前景统计次数、更新前景模型、更新该像素模型样本值、更新该像素点邻域像素点的模型样本值
+         *------------------------------------------------------------------
+         * Summary:
+         *   the Match Times of current pixel value and samples in library is large enough to
+         * regard current pixel as a Background pixel.
+         *   Then it needs to be done:
+         *   - Run the times of Foreground Statistic
+         *   - Run Foreground Model
+         *   - Run model sample library of this pixel probably
+         *   - Run model sample library of this pixel's neighborhood pixel probably
+        =====================================================================
+        */
+        //========================================
+        //        前景提取   |   Extract Foreground Areas
+        //========================================
+        if (seg[j] == 0)
+        {
+            // 已经认为是背景像素，故该像素的前景统计次数置0
+            // This pixel has regard as a background pixel, so the count of this pixel's foreground statistic set as 0
+            samples_ForeNum[row_offset + j] = 0;
+        }
+        /*===================================================================
+         * 说明：
+         *      当前像素值与样本库中值匹配次数较低，则认为是前景像素点；
+         *      此时需要更新前景统计次数、判断更新前景模型；
+         *------------------------------------------------------------------
+         * Summary:
+         *   the Match Times of current pixel value and samples in library is small enough to
+         * regard current pixel as a Foreground pixel.
+         *   Then it needs to be done:
+         *   - Run the times of Foreground Statistic
+         *   - Judge and Run Foreground Model
+        =====================================================================
+        */
+        else
+        {
+            // 已经认为是前景像素，故该像素的前景统计次数+1
+            // This pixel has regard as a foreground pixel, so the count of this pixel's foreground statistic plus 1
+            uchar &fore_num = samples_ForeNum[row_offset + j];
+            if(fore_num < 255)
+                fore_num++;
+
+            // 该像素点已经在分割模板中置255，同时写入位压缩分割模板
+            // Foreground Model's pixel has been set as 255, also set it in the Bit-packed Segment Model
+            seg_bits[j >> 6] |= (uint64)1 << (j & 63);
+
+            // 如果某个像素点连续50次被检测为前景，则认为一块静止区域被误判为运动，将其更新为背景点
+            // if this pixel is regarded as foreground for more than 50 times, then we regard this static area as dynamic area by mistake, and Run this pixel as background one.
+            if(fore_num > 50)
+            {
+                int random = rand_row ? rand_row[j].sample_fore : band.rng.uniform(0, num_samples);
+                SetPixSample(i, j, random, Gray.at<uchar>(i, j));
+
+                // 同时更新RGB通道样本库
+                // Update RGB Channels' Values of Sample Libraries
+                if(Channels == 3)
+                    SetPixFrameSample(i, j, random, Frame.ptr<uchar>(i) + 3 * j);
+            }
+        }
+    }
 }
 
 /*===================================================================
- * 函数名：getSegModel
- * 说明：获取前景模型二值图像；
- * 返回值：Mat
+ * 函数名：CalcuUpdateModel
+ * 说明：根据已经得到的分割模板，计算更新模板；
+ *
+ * 返回值：void
  *------------------------------------------------------------------
- * Function: getSegModel
+ * Function: CalcuUpdateModel
  *
  * Summary:
- *   get Foreground Model Binary Image.
+ *   Calculate Update Model from Segment Model.
  *
  * Returns:
- *   Mat
+ *   void
 =====================================================================
 */
-Mat ViBePlus::getSegModel()
+void ViBePlus::CalcuUpdateModel()
 {
-    return SegModel;
+    //==================================
+    //         计算闪烁等级
+    //----------------------------------------------
+    //   Calculate Blink Level
+    //==================================
+    CalcuBlinkLevel();
+
+    //========================================================
+    //    填充更新蒙版前景空洞区域
+    //-----------------------------------------------
+    //   Fill Foreground Hole Areas of Update Model
+    //========================================================
+    FillUpdateHoles();
+
+    //==================================
+    //         更新状态位
+    //----------------------------------------------
+    //   Update State Bits
+    //==================================
+    PrevSegBits.swap(SegBits);
+
+    //==================================
+    //         处理分割蒙版前景区域
+    //----------------------------------------------
+    //   Process Foreground Areas of Segment Areas
+    //==================================
+    FilterSegModel();
 }
 
 /*===================================================================
- * 函数名：getUpdateModel
- * 说明：获取更新模型二值图像；
- * 返回值：Mat
+ * 函数名：CalcuBlinkLevel
+ * 说明：更新模板复制分割模板，计算闪烁等级，并将闪烁等级过高的像素从更新模板中移除；
+ *    背景内边缘与闪烁状态由位压缩分割模板逐字计算，一次处理 64 个像素；
+ *    ExtractBG 的行条带并行处理；条带边界行的八邻域状态需要读取相邻条带的一行（光环），
+ * 故先计算所有条带改变状态的像素，再计算闪烁等级；
+ *    要求 ExtractBG 已经运行，上一帧的位压缩分割模板在 CalcuUpdateModel 中交换；
+ *
+ * 返回值：void
  *------------------------------------------------------------------
- * Function: getUpdateModel
+ * Function: CalcuBlinkLevel
  *
  * Summary:
- *   get Foreground Model Binary Image.
+ *   The Update Model copies the Segment Model, then Blink Levels are calculated and the
+ * Pixels of high Blink Level are removed from the Update Model.
+ *   Background Inner Edge & Blink State are calculated word by word from the Bit-packed
+ * Segment Model, 64 pixels at a time.
+ *   The row bands of ExtractBG are processed in parallel. The 8 neighbour state of a band's
+ * border rows reads one row of the neighbour bands (the halo), so the changed pixels of all
+ * bands are calculated before the blink levels.
+ *   ExtractBG must have run. The Bit-packed Segment Model of the previous frame is swapped
+ * in CalcuUpdateModel.
  *
  * Returns:
- *   Mat
+ *   void
 =====================================================================
 */
-Mat ViBePlus::getUpdateModel()
+void ViBePlus::CalcuBlinkLevel()
 {
-    return UpdateModel;
+    ForEachBand(&ViBePlus::CalcuChangedBand);
+    ForEachBand(&ViBePlus::CalcuBlinkBand);
 }
 
-
 /*===================================================================
- * 函数名：deleteSamples
- * 说明：删除样本库；
+ * 函数名：CalcuChangedBand
+ * 说明：更新模板的行条带先复制分割模板，并计算行条带中相对上一帧改变状态的像素；
+ * 参数：
+ *   ViBePlusBand &band:  行条带
  * 返回值：void
  *------------------------------------------------------------------
- * Function: deleteSamples
+ * Function: CalcuChangedBand
  *
  * Summary:
- *   Delete Sample Library.
+ *   The Row Band of Update Model copies the Segment Model first, and the Pixels of the band
+ * which changed state since Previous Frame are calculated.
+ *
+ * Arguments:
+ *   ViBePlusBand &band - Row Band
  *
  * Returns:
  *   void
 =====================================================================
 */
-void ViBePlus::deleteSamples()
+void ViBePlus::CalcuChangedBand(ViBePlusBand &band)
 {
-    delete samples;
-    delete samples_Frame;
-    delete samples_ave;
-    delete samples_sumsqr;
-    delete samples_ForeNum;
-    delete samples_BGInner;
-    delete samples_InnerState;
-    delete samples_BlinkLevel;
-    delete samples_MaxInnerGrad;
+    for(int i = band.row_begin; i < band.row_end; i++)
+    {
+        memcpy(UpdateModel.ptr<uchar>(i), SegModel.ptr<uchar>(i), Gray.cols);
+        CalcuChangedRow(i);
+    }
+}
+
+/*===================================================================
+ * 函数名：CalcuBlinkBand
+ * 说明：计算行条带的闪烁等级，图像首行与末行不处理；
+ * 参数：
+ *   ViBePlusBand &band:  行条带
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: CalcuBlinkBand
+ *
+ * Summary:
+ *   Calculate Blink Level of a Row Band, the first and the last rows of the image are not processed.
+ *
+ * Arguments:
+ *   ViBePlusBand &band - Row Band
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::CalcuBlinkBand(ViBePlusBand &band)
+{
+    int i_end = min(band.row_end, Gray.rows - 1);
+    for(int i = max(band.row_begin, 1); i < i_end; i++)
+        CalcuBlinkRow(i);
+}
+
+/*===================================================================
+ * 函数名：CalcuChangedRow
+ * 说明：计算第 i 行相对上一帧改变状态的像素；
+ * 参数：
+ *      int i：行数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: CalcuChangedRow
+ *
+ * Summary:
+ *   Calculate the Pixels of row i which changed state since Previous Frame.
+ *
+ * Arguments:
+ *   int i - Number of Line
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::CalcuChangedRow(int i)
+{
+    const uint64 *seg = SegBits.row(i), *prev = PrevSegBits.row(i);
+    uint64 *changed = ChangedBits.row(i);
+    for(int w = 0; w < SegBits.words; w++)
+        changed[w] = seg[w] ^ prev[w];
+}
+
+/*===================================================================
+ * 函数名：CalcuBlinkRow
+ * 说明：计算第 i 行的闪烁等级，并将闪烁等级过高的像素从更新模板中移除；
+ *    要求第 i - 1 至 i + 1 行的位压缩分割模板与改变状态的像素已经计算；
+ * 参数：
+ *      int i：行数，1 <= i <= rows - 2
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: CalcuBlinkRow
+ *
+ * Summary:
+ *   Calculate Blink Level of row i, and remove Pixels of high Blink Level from Update Model.
+ *   Bit-packed Segment Model & Changed Pixels of rows i - 1 to i + 1 must be calculated.
+ *
+ * Arguments:
+ *   int i - Number of Line, 1 <= i <= rows - 2
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::CalcuBlinkRow(int i)
+{
+    //===================================================================
+    //   以位压缩分割模板逐字计算背景内边缘与闪烁状态，一次处理 64 个像素：
+    //   - 背景内边缘：当前点为背景，且八邻域中有前景；
+    //   - 邻域状态与上一帧相同：上一帧当前点为背景（上一帧状态位有效），且八邻域中没有像素改变状态；
+    //   - 闪烁：背景内边缘，且邻域状态与上一帧不同；
+    //------------------------------------------------------------------
+    //   Calculate Background Inner Edge & Blink State word by word from the Bit-packed Segment
+    // Model, 64 pixels at a time:
+    //   - Background Inner Edge: Current Pixel is Background, and there is Foreground in its 8 neighbours;
+    //   - Neighbor Area State same as Previous Frame's: Current Pixel was Background in Previous
+    //     Frame (so its Previous State Bits are valid), and none of its 8 neighbours changed state;
+    //   - Blink: Background Inner Edge, and Neighbor Area State differs from Previous Frame's.
+    //====================================================================
+    const uint64 *seg = SegBits.row(i), *prev = PrevSegBits.row(i);
+    uchar *level = samples_BlinkLevel + (size_t)i * Gray.cols;
+    uchar *update = UpdateModel.ptr<uchar>(i);
+    for(int w = 0; w < SegBits.words; w++)
+    {
+        // 内部像素掩码，第 0 列与最后一列不处理
+        // Mask of Inner Pixels, the first and the last columns are not processed
+        uint64 inner = ~(uint64)0;
+        if(w == 0)
+            inner &= ~(uint64)1;
+        int tail = Gray.cols - 1 - (w << 6);
+        if(tail < 64)
+            inner &= ((uint64)1 << tail) - 1;
+
+        uint64 bginner = ~seg[w] & SegBits.neighbours8(i, w);
+        uint64 same = ~prev[w] & ~ChangedBits.neighbours8(i, w);
+        uint64 blink = bginner & ~same & inner;
+
+        int j_begin = max(w << 6, 1), j_end = min((w << 6) + 64, Gray.cols - 1);
+        for(int j = j_begin; j < j_end; j++)
+        {
+            // 闪烁点的闪烁等级增加15，其他点减少1
+            // Blink Level of Blinking Pixels plus 15, others minus 1
+            if((blink >> (j & 63)) & 1)
+                level[j] = (uchar)min(level[j] + 15, 150);
+            else
+                level[j] = (uchar)max(level[j] - 1, 0);
+
+            //==================================
+            //      闪烁等级 > 30，从更新蒙版 UpdateModel 中移除
+            //----------------------------------------------
+            //   If Blink Level is Larger than 30, Then remove this Pixel from Update Model.
+            //==================================
+            if(level[j] > 30)
+                update[j] = 255;
+        }
+    }
+}
+
+/*===================================================================
+ * 函数名：FillUpdateHoles
+ * 说明：标记分割模板的连通区域，在更新模板中填充面积不超过 UPDATE_HOLE_AREA 的前景空洞区域；
+ *    与 ExtractBG 相同的行条带并行标记，跨越条带边界的连通区域在条带边界处合并；
+ *    标记结果由 FilterSegModel 复用，故须在分割模板被修改之前调用；
+ *
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: FillUpdateHoles
+ *
+ * Summary:
+ *   Label the Connected Regions of Segment Model, and fill Foreground Hole Areas whose Area
+ * is not larger than UPDATE_HOLE_AREA in Update Model.
+ *   The row bands of ExtractBG are labeled in parallel, and regions crossing a band border
+ * are merged there.
+ *   The labels are reused by FilterSegModel, so it must be called before Segment Model is modified.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::FillUpdateHoles()
+{
+    //===================================================================
+    // 以行程编码与并查集一次扫描标记前景斑点与前景空洞，层级与面积与 findContours(RETR_TREE)、
+    // contourArea 相同：等级为 1 的轮廓即前景空洞区域，等级为 0 的轮廓即前景斑点区域；
+    //------------------------------------------------------------------
+    // Label Foreground Blobs & Foreground Holes in one scan by run-length encoding and union-find,
+    // with the levels & areas of findContours(RETR_TREE) and contourArea: Level 1 Contours are the
+    // Foreground Hole Areas, and Level 0 Contours are the Foreground Blob Areas.
+    //====================================================================
+    SegRegions.label(SegModel, (int)bands.size());
+
+    // 填充面积 <= 50 的前景空洞区域
+    // Fill Foreground Hole Areas whose Area is not larger than 50
+    SegRegions.fill(UpdateModel, UPDATE_HOLE_AREA, 0);
+}
+
+/*===================================================================
+ * 函数名：FilterSegModel
+ * 说明：以 FillUpdateHoles 的标记结果，填充分割模板中面积不超过 SEG_HOLE_AREA 的前景空洞区域，
+ * 并移除面积小于 SEG_BLOB_AREA 的前景斑点区域；
+ *
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: FilterSegModel
+ *
+ * Summary:
+ *   Fill Foreground Hole Areas whose Area is not larger than SEG_HOLE_AREA, and remove
+ * Foreground Blob Areas whose Area is less than SEG_BLOB_AREA in Segment Model, with the
+ * labels of FillUpdateHoles.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::FilterSegModel()
+{
+    // 填充面积 <= 20 的前景空洞区域，移除面积 < 10 的前景斑点区域
+    // Fill Foreground Hole Areas whose Area is not larger than 20, and remove Foreground Blob Areas whose Area is less than 10
+    SegRegions.fill(SegModel, SEG_HOLE_AREA, SEG_BLOB_AREA);
+}
+
+/*===================================================================
+ * 函数名：MayBeUpdateHole
+ * 说明：判断当前背景像素点是否可能位于更新模板被填充的前景空洞中；
+ *    前景空洞不与图像边界相接，故边界像素不会位于空洞中；
+ *    空洞的轮廓面积不小于其像素个数，填充的空洞不超过 UPDATE_HOLE_AREA 个像素，故空洞中像素所在行的背景段，
+ * 左右两侧 UPDATE_HOLE_AREA 个像素之内必有前景；
+ *    返回 false 时该像素一定不会被填充，返回 true 时只是可能被填充；
+ * 参数：
+ *      int i：行数
+ *      int j：列数
+ * 返回值：bool
+ *------------------------------------------------------------------
+ * Function: MayBeUpdateHole
+ *
+ * Summary:
+ *   Judge whether Current Background Pixel may lie in a Foreground Hole filled in Update Model.
+ *   Foreground Holes do not touch the image border, so border pixels never lie in a hole.
+ *   The contour area of a hole is not less than its pixel count, so a filled hole has at most
+ * UPDATE_HOLE_AREA pixels, and the background run of a hole pixel has foreground within
+ * UPDATE_HOLE_AREA pixels on both sides.
+ *   If it returns false the pixel is never filled; true only means it may be filled.
+ *
+ * Arguments:
+ *   int i - Number of Line
+ *   int j - Number of Column
+ *
+ * Returns:
+ *   bool
+=====================================================================
+*/
+bool ViBePlus::MayBeUpdateHole(int i, int j)
+{
+    if(i <= 0 || j <= 0 || i >= Gray.rows - 1 || j >= Gray.cols - 1)
+        return false;
+    return SegBits.any(i, max(j - UPDATE_HOLE_AREA, 0), j) &&
+           SegBits.any(i, j + 1, min(j + 1 + UPDATE_HOLE_AREA, Gray.cols));
+}
+
+/*===================================================================
+ * 函数名：Update
+ * 说明：更新背景模板；
+ *    按几何分布抽取到下一个更新像素的间隔，只访问实际更新的像素；
+ *    ExtractBG 的行条带并行更新，跨越条带边界（光环）的邻居样本更新先存入各条带的队列，
+ * 全部条带处理完成后再写入样本库；
+ *
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: Update
+ *
+ * Summary:
+ *   Update the Update Model.
+ *   The update pass visits only the pixels that actually update: the gap to the next
+ * updating pixel is drawn from a geometric distribution.
+ *   The row bands of ExtractBG are updated in parallel. Neighbour sample updates crossing a
+ * band border (the halo) are queued per band, and written after all bands have finished.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::Update()
+{
+    //===================================================================
+    // 更新模板 UpdateModel 的前景像素点不被用来更新样本库；
+    // 每个背景像素以 1 / φ 的概率更新，故按几何分布的间隔直接跳到下一个更新像素，只在这些位置检查更新模板；
+    //------------------------------------------------------------------
+    // Foreground Pixels in UpdateModel won't be used to Update Sample Libraries.
+    // Every background pixel updates with possibility of 1/φ, so jump straight to the next
+    // updating pixel by a geometrically distributed gap, and check the Update Model only there.
+    //====================================================================
+    ForEachBand(&ViBePlus::UpdateBand);
+
+    // 写入跨越条带边界的邻居样本更新
+    // Write the Neighbour Sample Updates crossing Band Borders
+    ApplyDeferred();
+}
+
+/*===================================================================
+ * 函数名：UpdateBand
+ * 说明：更新行条带的样本库，跨越条带边界的邻居样本更新存入条带的延迟队列；
+ * 参数：
+ *   ViBePlusBand &band:  行条带
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: UpdateBand
+ *
+ * Summary:
+ *   Update the Sample Library of a Row Band, Neighbour Sample Updates crossing the band
+ * border are stored in the band's deferred queue.
+ *
+ * Arguments:
+ *   ViBePlusBand &band - Row Band
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::UpdateBand(ViBePlusBand &band)
+{
+    const int64 band_end = (int64)band.row_end * Gray.cols;
+    BeginUpdate(band);
+    UpdateRange(band, false, band_end, false);
+    UpdateRange(band, true, band_end, false);
+}
+
+/*===================================================================
+ * 函数名：BeginUpdate
+ * 说明：开始行条带本帧的样本更新，重置几何间隔抽样状态；
+ * 参数：
+ *   ViBePlusBand &band:  行条带
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: BeginUpdate
+ *
+ * Summary:
+ *   Begin the Sample Update of this Frame on a Row Band, and reset the state of geometric gap sampling.
+ *
+ * Arguments:
+ *   ViBePlusBand &band - Row Band
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::BeginUpdate(ViBePlusBand &band)
+{
+    band.update_cursor = band.rng.next();
+    band.update_pos[0] = band.update_pos[1] = -1;
+    band.update_entry[0] = band.update_entry[1] = NULL;
+}
+
+/*===================================================================
+ * 函数名：UpdateRange
+ * 说明：处理行条带中位置小于 pos_end 的自身或邻居样本更新，可以多次调用，从上次结束的位置继续；
+ *    跨越条带边界的邻居样本更新存入条带的延迟队列；
+ * 参数：
+ *      ViBePlusBand &band：行条带
+ *      bool neighbor：false 为自身样本更新，true 为邻居样本更新
+ *      int64 pos_end：结束位置（按行优先的像素编号）
+ *      bool fused：是否为流水线模式，为 true 时可能落在更新模板前景空洞中的更新也存入延迟队列
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: UpdateRange
+ *
+ * Summary:
+ *   Process Self or Neighbour Sample Updates of a Row Band whose position is less than
+ * pos_end. It can be called several times, and continues from where the last call stopped.
+ *   Neighbour Sample Updates crossing the band border are stored in the band's deferred queue.
+ *
+ * Arguments:
+ *   ViBePlusBand &band - Row Band
+ *   bool neighbor - false for Self Sample Update, true for Neighbour Sample Update
+ *   int64 pos_end - End Position (row-major pixel index)
+ *   bool fused - fused pipeline mode or not, if true the updates which may fall in a
+ *                Foreground Hole of Update Model are stored in the deferred queue as well
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::UpdateRange(ViBePlusBand &band, bool neighbor, int64 pos_end, bool fused)
+{
+    const uchar *update_mask = UpdateModel.data;
+    RNG &rng = band.rng;
+    int64 &pos = band.update_pos[neighbor];
+    const RandEntry *&e = band.update_entry[neighbor];
+
+    if(pos < 0)
+        pos = (int64)band.row_begin * Gray.cols - 1 + rand_table.drawGap(rng, update_log_q, band.update_cursor, e);
+
+    for(; pos < pos_end; pos += rand_table.drawGap(rng, update_log_q, band.update_cursor, e))
+    {
+        if(update_mask[pos] != 0)
+            continue;
+
+        int i = (int)(pos / Gray.cols), j = (int)(pos - (int64)i * Gray.cols);
+        int row = i, col = j, random;
+
+        if(!neighbor)
+        {
+            // 已经认为该像素是背景像素，那么它有 1 / φ 的概率去更新自己的模型样本值
+            // This pixel is already regarded as Background Pixel, then it has possibility of 1/φ to Run its model sample's value.
+            random = e ? e->sample_self : rng.uniform(0, num_samples);
+        }
+        else
+        {
+            // 同时也有 1 / φ 的概率去更新它的邻居点的模型样本值
+            // At the same time, it has possibility of 1/φ to Run its neighborhood point's sample value.
+
+            //===================================================================
+            //   根据当前点最大梯度 maxGrad，跳出该次循环，便抑制传播
+            //------------------------------------------------------------------
+            //  Jump out of this Loop for Inhibiting Diffusion According to Gray Value Max Gradient of Current Pixel.
+            //====================================================================
+            if(MaxInnerGrad(i, j) > 50)     continue;
+
+            random = e ? e->neighbor_y : rng.uniform(0, 9); row = i + c_yoff[random];
+            random = e ? e->neighbor_x : rng.uniform(0, 9); col = j + c_xoff[random];
+
+            // 防止选取的像素点越界
+            // Protect Pixel from Crossing the border
+            if (row < 0) row = 0;
+            if (row >= Gray.rows)  row = Gray.rows - 1;
+            if (col < 0) col = 0;
+            if (col >= Gray.cols) col = Gray.cols - 1;
+
+            random = e ? e->sample_neighbor : rng.uniform(0, num_samples);
+        }
+
+        // 跨越条带边界的更新延迟处理；流水线模式下更新模板的空洞尚未填充，可能落在空洞中的更新也延迟处理
+        // Updates crossing the band border are deferred; the holes of Update Model are not filled yet in fused mode,
+        // so the updates which may fall in a hole are deferred as well
+        if(row < band.row_begin || row >= band.row_end || (fused && MayBeUpdateHole(i, j)))
+        {
+            ViBePlusDeferredUpdate d = {i, j, row, col, random};
+            band.deferred.push_back(d);
+            continue;
+        }
+
+        ApplyUpdate(i, j, row, col, random);
+    }
+}
+
+/*===================================================================
+ * 函数名：ApplyUpdate
+ * 说明：以像素 (i, j) 的当前值替换像素 (row, col) 的第 k 个样本，
+ *    同时更新样本集灰度和、平方和、自适应阈值与 RGB 通道样本库；
+ * 参数：
+ *      int i：更新像素的行数
+ *      int j：更新像素的列数
+ *      int row：被替换样本所属像素的行数
+ *      int col：被替换样本所属像素的列数
+ *      int k：样本编号
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ApplyUpdate
+ *
+ * Summary:
+ *   Replace Sample k of Pixel (row, col) by the current value of Pixel (i, j), and update
+ * Sum, Sum of Squares, Adaptive Threshold & RGB Channels of Sample Library as well.
+ *
+ * Arguments:
+ *   int i - Number of Line of the Updating Pixel
+ *   int j - Number of Column of the Updating Pixel
+ *   int row - Number of Line of the Pixel whose Sample is replaced
+ *   int col - Number of Column of the Pixel whose Sample is replaced
+ *   int k - ID in Sample Library
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::ApplyUpdate(int i, int j, int row, int col, int k)
+{
+    // 替换样本，同时更新样本集灰度和、平方和与自适应阈值
+    // Replace the Sample, and update Sum, Sum of Squares & Adaptive Threshold of Sample Library
+    SetPixSample(row, col, k, Gray.at<uchar>(i, j));
+
+    // 同时更新RGB通道样本库
+    // Update RGB Channels' Values of Sample Library
+    if(Channels == 3)
+        SetPixFrameSample(row, col, k, Frame.ptr<uchar>(i) + 3 * j);
+}
+
+/*===================================================================
+ * 函数名：MaxInnerGrad
+ * 说明：计算当前像素点与八邻域像素点灰度差的最大值；
+ *    只在邻域更新时对实际被选中的像素计算，边界像素返回0；
+ * 参数：
+ *      int i：行数
+ *      int j：列数
+ * 返回值：int
+ *------------------------------------------------------------------
+ * Function: MaxInnerGrad
+ *
+ * Summary:
+ *   Calculate Max Gray Gradient between Current Pixel and its 8 neighbours.
+ *   It is only calculated for the pixels actually picked by the neighbour update, and
+ * returns 0 for border pixels.
+ *
+ * Arguments:
+ *   int i - Number of Line
+ *   int j - Number of Column
+ *
+ * Returns:
+ *   int
+=====================================================================
+*/
+int ViBePlus::MaxInnerGrad(int i, int j)
+{
+    if(i <= 0 || j <= 0 || i >= Gray.rows - 1 || j >= Gray.cols - 1)
+        return 0;
+
+    int maxGrad = 0, val = Gray.at<uchar>(i, j);
+    for(int i_tmp = i - 1; i_tmp <= i + 1; i_tmp++)
+    {
+        const uchar *p = Gray.ptr<uchar>(i_tmp);
+        for(int j_tmp = j - 1; j_tmp <= j + 1; j_tmp++)
+            maxGrad = max(maxGrad, abs(val - p[j_tmp]));
+    }
+    return maxGrad;
+}
+
+/*===================================================================
+ * 函数名：SetPixSample
+ * 说明：替换当前像素点的第 k 个灰度样本；
+ *    以 O(1) 更新样本集灰度和与平方和，并重新计算自适应阈值；
+ * 参数：
+ *      int i：行数
+ *      int j：列数
+ *      int k：样本编号
+ *      int val：更新的样本值
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: SetPixSample
+ *
+ * Summary:
+ *   Replace Gray Sample k of Current Pixel whose location is (i, j).
+ *   Sum & Sum of Squares of the Sample Set are updated in O(1), and the Adaptive
+ * Threshold is calculated again.
+ *
+ * Arguments:
+ *   int i - Number of Line
+ *   int j - Number of Column
+ *   int k - ID in Sample Library
+ *   int val - Sample Value Updated
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::SetPixSample(int i, int j, int k, int val)
+{
+    size_t offset = (size_t)i * Gray.cols + j;
+    uchar *sam = samples + k * plane_size + offset;
+    int old = *sam;
+    *sam = (uchar)val;
+
+    // 减去原样本值，加上新样本值
+    // Subtract the Previous Sample Value, and add the New one
+    samples_sum[offset] += val - old;
+    samples_sqsum[offset] += val * val - old * old;
+    samples_AdaThreshold[offset] = (uchar)CalcuAdaThreshold(samples_sum[offset], samples_sqsum[offset]);
+}
+
+/*===================================================================
+ * 函数名：SetPixFrameSample
+ * 说明：替换当前像素点的第 k 个 BGR 通道样本，并缓存其模平方；
+ * 参数：
+ *      int i：行数
+ *      int j：列数
+ *      int k：样本编号
+ *      const uchar *bgr：更新的 BGR 通道值
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: SetPixFrameSample
+ *
+ * Summary:
+ *   Replace BGR Channels Sample k of Current Pixel whose location is (i, j), and cache
+ * its Squared Norm.
+ *
+ * Arguments:
+ *   int i - Number of Line
+ *   int j - Number of Column
+ *   int k - ID in Sample Library
+ *   const uchar *bgr - BGR Channels Values Updated
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::SetPixFrameSample(int i, int j, int k, const uchar *bgr)
+{
+    size_t offset = (size_t)i * Gray.cols + j;
+    uchar *sam = samples_Frame + 3 * k * plane_size + offset;
+    sam[0] = bgr[0]; sam[plane_size] = bgr[1]; sam[2 * plane_size] = bgr[2];
+    samples_FrameNorm2[k * plane_size + offset] = bgr[0] * bgr[0] + bgr[1] * bgr[1] + bgr[2] * bgr[2];
+}
+
+/*===================================================================
+ * 函数名：CalcuAdaThreshold
+ * 说明：由样本集灰度和与平方和计算距离的自适应阈值；
+ *    阈值为 ceil(sigma * AMP_MULTIFACTOR)，限定在 ADA_THRESHOLD_MIN 与 ADA_THRESHOLD_MAX 之间，
+ *    以整数与查找表 ada_limits 计算，不需要开方；
+ * 参数：
+ *      int sum：样本集灰度和
+ *      int sqsum：样本集灰度平方和
+ * 返回值：int
+ *------------------------------------------------------------------
+ * Function: CalcuAdaThreshold
+ *
+ * Summary:
+ *   Calculate Adaptive Threshold of Distance from Sum & Sum of Squares of the Sample Set.
+ *   The threshold is ceil(sigma * AMP_MULTIFACTOR) limited between ADA_THRESHOLD_MIN and
+ * ADA_THRESHOLD_MAX, and calculated by integers & the lookup table ada_limits without sqrt.
+ *
+ * Arguments:
+ *   int sum - Sum of Gray Values of Sample Set
+ *   int sqsum - Sum of Squared Gray Values of Sample Set
+ *
+ * Returns:
+ *   int
+=====================================================================
+*/
+int ViBePlus::CalcuAdaThreshold(int sum, int sqsum)
+{
+    // 方差的 N * N 倍
+    // N * N times of the Variance
+    int64 var = (int64)num_samples * sqsum - (int64)sum * sum;
+
+    int t = ADA_THRESHOLD_MIN;
+    while(t < ADA_THRESHOLD_MAX && var > ada_limits[t - ADA_THRESHOLD_MIN])
+        t++;
+    return t;
+}
+
+/*===================================================================
+ * 函数名：setRandomMode
+ * 说明：设置更新决策的随机数来源，须在模型初始化之前调用；
+ * 参数：
+ *   int mode:  随机数来源
+ *      - RANDOM_MODE_RNG:     逐次调用 RNG
+ *      - RANDOM_MODE_TABLE:   读取预先生成的随机数表
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setRandomMode
+ *
+ * Summary:
+ *   Set Random Source of the Update Decisions, it must be called before the model is inited.
+ *
+ * Arguments:
+ *   int mode - Random Source
+ *      - RANDOM_MODE_RNG:     call RNG one by one
+ *      - RANDOM_MODE_TABLE:   read the precomputed random number tables
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::setRandomMode(int mode)
+{
+    random_mode = mode;
+}
+
+/*===================================================================
+ * 函数名：setPipelineMode
+ * 说明：设置运行方式；
+ * 参数：
+ *   int mode:  运行方式
+ *      - PIPELINE_STAGED:   依次调用 ExtractBG、CalcuUpdateModel 与 Update，每一步遍历整帧
+ *      - PIPELINE_FUSED:    按行流水线单次遍历整帧，样本库的工作集保持在缓存中
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setPipelineMode
+ *
+ * Summary:
+ *   Set Pipeline Mode.
+ *
+ * Arguments:
+ *   int mode - Pipeline Mode
+ *      - PIPELINE_STAGED:   call ExtractBG, CalcuUpdateModel & Update one after another, each traverses the whole frame
+ *      - PIPELINE_FUSED:    process the frame in one row-pipelined sweep, the working set of Sample Library stays in cache
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::setPipelineMode(int mode)
+{
+    pipeline_mode = mode;
+}
+
+/*===================================================================
+ * 函数名：setNumThreads
+ * 说明：设置并行处理的线程（行条带）个数；PIPELINE_FUSED 模式单次遍历整帧，总是只使用一个条带；
+ * 参数：
+ *   int n:  线程个数，0 表示使用 OpenCV 线程池的线程个数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setNumThreads
+ *
+ * Summary:
+ *   Set Number of Threads (Row Bands) for parallel Run. PIPELINE_FUSED mode sweeps the whole
+ * frame once, so it always uses a single band.
+ *
+ * Arguments:
+ *   int n - Number of Threads, 0 means the thread number of OpenCV's thread pool
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::setNumThreads(int n)
+{
+    num_threads = max(n, 0);
+}
+
+/*===================================================================
+ * 函数名：getSegModel
+ * 说明：获取前景模型二值图像；
+ * 返回值：Mat
+ *------------------------------------------------------------------
+ * Function: getSegModel
+ *
+ * Summary:
+ *   get Foreground Model Binary Image.
+ *
+ * Returns:
+ *   Mat
+=====================================================================
+*/
+Mat ViBePlus::getSegModel()
+{
+    return SegModel;
+}
+
+/*===================================================================
+ * 函数名：getUpdateModel
+ * 说明：获取更新模型二值图像；
+ * 返回值：Mat
+ *------------------------------------------------------------------
+ * Function: getUpdateModel
+ *
+ * Summary:
+ *   get Foreground Model Binary Image.
+ *
+ * Returns:
+ *   Mat
+=====================================================================
+*/
+Mat ViBePlus::getUpdateModel()
+{
+    return UpdateModel;
+}
+
+
+/*===================================================================
+ * 函数名：deleteSamples
+ * 说明：删除样本库；
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: deleteSamples
+ *
+ * Summary:
+ *   Delete Sample Library.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::deleteSamples()
+{
+    if(samples != NULL)
+        fastFree(samples);
+    if(samples_FrameNorm2 != NULL)
+        fastFree(samples_FrameNorm2);
+    samples = NULL;
+    samples_Frame = NULL;
+    samples_FrameNorm2 = NULL;
+    // 像素状态平面与灰度平方和平面一同分配
+    // Pixel State Planes are allocated together with the Sum of Squares plane
+    if(samples_sqsum != NULL)
+        fastFree(samples_sqsum);
+    samples_sqsum = NULL;
+    samples_sum = NULL;
+    samples_AdaThreshold = NULL;
+    samples_ForeNum = NULL;
+    samples_BlinkLevel = NULL;
+}
+
+/*===================================================================
+ * 函数名：reset
+ * 说明：删除样本库并清零帧计数，下一次 Run 以当前帧重新建立模型；
+ *    init 会重新分配样本库，图像尺寸改变时必须先调用 reset；
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: reset
+ *
+ * Summary:
+ *   Delete Sample Library & clear the Frame Count, the next Run rebuilds the model
+ * from its frame.
+ *   init reassigns the Sample Library, so reset must be called first when the image
+ * size changes.
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlus::reset()
+{
+    deleteSamples();
+    count = 0;
 }
 
@@ -26,10 +26,60 @@
 #include <cstdio>
 #include "opencv2/opencv.hpp"
 #include "ViBePlusMacro.h"
+#include "Common/RandTable.h"
+#include "Common/FrameView.h"
+#include "Common/BitMask.h"
+#include "Common/ConnectedRegions.h"
 
 using namespace cv;
 using namespace std;
 
+// 流水线模式下可能落在更新模板前景空洞中的样本更新，在空洞填充之后再决定是否写入
+// Sample Update which may fall in a Foreground Hole of the Update Model in fused pipeline mode,
+// it is written or dropped after the holes are filled.
+struct ViBePlusDeferredUpdate
+{
+    // 更新像素的位置
+    // Location of the Updating Pixel
+    int i, j;
+
+    // 被替换样本所属像素的位置
+    // Location of the Pixel whose Sample is replaced
+    int row, col;
+
+    // 被替换的样本编号
+    // ID of the Sample replaced
+    int k;
+};
+
+// 行条带及其独立的随机数与更新状态
+// Row Band with its own Random Number & Update State
+struct ViBePlusBand
+{
+    // 条带的行范围 [row_begin, row_end)
+    // Row Range of the band [row_begin, row_end)
+    int row_begin, row_end;
+
+    // 条带的随机数生成器，每帧由跨帧的随机数生成器重新播种
+    // Random Number Generator of the band, seeded again every frame from the frame-persistent generator
+    RNG rng;
+
+    // 几何间隔抽样状态：下一个自身（[0]）/ 邻居（[1]）更新像素的位置，-1 表示尚未抽取，及其所用的随机数表项
+    // State of geometric gap sampling: Position of the next Self ([0]) / Neighbour ([1]) Updating Pixel,
+    // -1 means not drawn yet, and the Random Number Table Entry it uses
+    int64 update_pos[2];
+    const RandEntry *update_entry[2];
+
+    // 随机数表的读取位置
+    // Read Position of the Random Number Table
+    unsigned update_cursor;
+
+    // 延迟写入的样本更新：跨越条带边界的邻居样本更新，以及流水线模式下可能落在空洞中的更新
+    // Deferred Sample Updates: Neighbour Sample Updates crossing the band border, and the updates which
+    // may fall in a hole in fused pipeline mode
+    vector<ViBePlusDeferredUpdate> deferred;
+};
+
 class ViBePlus
 {
 public:
@@ -39,10 +89,14 @@ public:
          int rand_sam = DEFAULT_RANDOM_SAMPLE);
     ~ViBePlus(void);
 
-    // 捕获一帧图像
-    // Capture one Frame of Video
+    // 捕获一帧图像，只引用源图像的数据，源图像在 Run 结束之前不能被修改
+    // Capture one Frame of Video, only the source image's data is referenced, so it must not be modified until Run returns
     void FrameCapture(Mat img);
 
+    // 由调用者持有的帧缓冲区捕获一帧图像，GRAY / NV12 / I420 直接读取亮度平面，不拷贝
+    // Capture one Frame from a caller-owned frame buffer, GRAY / NV12 / I420 read the luma plane directly without copying
+    void FrameCapture(const FrameView &frame);
+
     // 背景模型初始化
     // Init Background Model.
     void init();
@@ -63,17 +117,39 @@ public:
     // Calculate Update Model from Segment Model
     void CalcuUpdateModel();
 
+    // 计算闪烁等级，更新模板复制分割模板并移除闪烁等级过高的像素，是 CalcuUpdateModel 的第一步
+    // Calculate Blink Level: the Update Model copies the Segment Model and drops Pixels of high
+    // Blink Level, the first step of CalcuUpdateModel
+    void CalcuBlinkLevel();
+
     // 更新背景模板
     // Update the Update Model
     void Update();
 
-    // 更新当前像素点样本集方差
-    // Update Variance of Sample Set of Current Pixel whose location is (i, j)
-    void UpdatePixSampleSumSquare(int i, int j, int k, int val);
+    // 替换当前像素点的第 k 个灰度样本，以 O(1) 更新样本集灰度和、平方和与自适应阈值
+    // Replace Gray Sample k of Current Pixel whose location is (i, j), and update Sum, Sum of Squares
+    // & Adaptive Threshold of its Sample Set in O(1)
+    void SetPixSample(int i, int j, int k, int val);
+
+    // 替换当前像素点的第 k 个 BGR 通道样本，并缓存其模平方
+    // Replace BGR Channels Sample k of Current Pixel whose location is (i, j), and cache its Squared Norm
+    void SetPixFrameSample(int i, int j, int k, const uchar *bgr);
+
+    // 由样本集灰度和与平方和计算自适应阈值
+    // Calculate Adaptive Threshold from Sum & Sum of Squares of Sample Set
+    int CalcuAdaThreshold(int sum, int sqsum);
+
+    // 设置更新决策的随机数来源：RANDOM_MODE_RNG 或 RANDOM_MODE_TABLE
+    // Set Random Source of the Update Decisions: RANDOM_MODE_RNG or RANDOM_MODE_TABLE
+    void setRandomMode(int mode);
+
+    // 设置运行方式：PIPELINE_STAGED 或 PIPELINE_FUSED
+    // Set Pipeline Mode: PIPELINE_STAGED or PIPELINE_FUSED
+    void setPipelineMode(int mode);
 
-    // 更新当前像素点样本集平均值
-    // Update Average Value of Sample Set of Current Pixel whose location is (i, j)
-    void UpdatePixSampleAve(int i, int j, int k, int val);
+    // 设置并行处理的线程（行条带）个数，0 表示使用 OpenCV 线程池的线程个数
+    // Set Number of Threads (Row Bands) for parallel Run, 0 means the thread number of OpenCV's thread pool.
+    void setNumThreads(int n);
 
     // 获取前景模型二值图像
     // get Foreground Model Binary Image.
@@ -87,6 +163,14 @@ public:
     // Delete Sample Library and Relative Information.
     void deleteSamples();
 
+    // 删除样本库并清零帧计数，下一次 Run 以当前帧重新建立模型（图像尺寸改变时必须调用）
+    // Delete Sample Library & clear the Frame Count, the next Run rebuilds the model from its frame (required when the image size changes)
+    void reset();
+
+    // 计算当前像素点邻域灰度最大梯度
+    // Calculate Max Gray Gradient of Neighbor Area of Current Pixel whose location is (i, j)
+    int MaxInnerGrad(int i, int j);
+
     // x的邻居点
     // x's neighborhood points
     int c_xoff[9] = {-1,  0,  1, -1, 1, -1, 0, 1, 0};
@@ -96,6 +180,71 @@ public:
     int c_yoff[9] = {-1,  0,  1, -1, 1, -1, 0, 1, 0};
 
 private:
+    friend class ViBePlusBandInvoker;
+
+    // 划分 nbands 个行条带，并为每个条带的随机数生成器播种
+    // Split nbands Row Bands, and seed the Random Number Generator of every band
+    void PrepareBands(int nbands);
+
+    // 在 OpenCV 线程池中对每个行条带并行调用 func
+    // Call func on every Row Band in parallel on OpenCV's thread pool
+    void ForEachBand(void (ViBePlus::*func)(ViBePlusBand &));
+
+    // 各阶段在一个行条带上的处理：提取分割模板、计算改变状态的像素、计算闪烁等级、更新样本库
+    // Work of every stage on one Row Band: Extract Segment Model, Calculate Changed Pixels,
+    // Calculate Blink Level, and Update Sample Library
+    void ExtractBGBand(ViBePlusBand &band);
+    void CalcuChangedBand(ViBePlusBand &band);
+    void CalcuBlinkBand(ViBePlusBand &band);
+    void UpdateBand(ViBePlusBand &band);
+
+    // 写入各条带延迟的样本更新，更新像素在更新模板中已经不是背景的除外
+    // Write the Deferred Sample Updates of every band, except those whose updating pixel is no more background in Update Model
+    void ApplyDeferred();
+
+    // 按行流水线单次遍历运行 ViBe+：分类第 r 行，计算第 r - 1 行的闪烁等级，更新第 r - 2 行
+    // Run ViBe+ in one row-pipelined sweep: classify row r, calculate Blink Level of row r - 1, and update row r - 2
+    void RunFused();
+
+    // 提取第 i 行的分割模板，随机决策来自所在条带
+    // Extract row i of Segment Model, the random decisions come from its band
+    void ExtractBGRow(int i, ViBePlusBand &band);
+
+    // 计算第 i 行相对上一帧改变状态的像素
+    // Calculate the Pixels of row i which changed state since Previous Frame
+    void CalcuChangedRow(int i);
+
+    // 计算第 i 行的闪烁等级，并将闪烁等级过高的像素从更新模板中移除，要求 1 <= i <= rows - 2
+    // Calculate Blink Level of row i, and remove Pixels of high Blink Level from Update Model, requires 1 <= i <= rows - 2
+    void CalcuBlinkRow(int i);
+
+    // 填充更新模板中的前景空洞区域
+    // Fill Foreground Hole Areas of Update Model
+    void FillUpdateHoles();
+
+    // 填充分割模板中的前景空洞区域，并移除前景斑点区域
+    // Fill Foreground Hole Areas & remove Foreground Blob Areas of Segment Model
+    void FilterSegModel();
+
+    // 当前像素点是否可能位于更新模板被填充的前景空洞中
+    // Whether Current Pixel may lie in a Foreground Hole filled in Update Model
+    bool MayBeUpdateHole(int i, int j);
+
+    // 开始行条带本帧的样本更新
+    // Begin the Sample Update of this Frame on a Row Band
+    void BeginUpdate(ViBePlusBand &band);
+
+    // 处理行条带中位置小于 pos_end 的自身（neighbor 为 false）或邻居（neighbor 为 true）样本更新；
+    // 跨越条带边界的更新，以及 fused 为 true 时可能落在更新模板前景空洞中的更新，存入条带的延迟队列
+    // Process Self (neighbor is false) or Neighbour (neighbor is true) Sample Updates of a Row Band whose position
+    // is less than pos_end; updates crossing the band border, and when fused is true the updates which may fall in
+    // a Foreground Hole of Update Model, are stored in the band's deferred queue
+    void UpdateRange(ViBePlusBand &band, bool neighbor, int64 pos_end, bool fused);
+
+    // 以像素 (i, j) 的当前值替换像素 (row, col) 的第 k 个样本
+    // Replace Sample k of Pixel (row, col) by the current value of Pixel (i, j)
+    void ApplyUpdate(int i, int j, int row, int col, int k);
+
     // 当前帧图像
     // Current Raw Frame
     Mat Frame;
@@ -104,6 +253,10 @@ private:
     // Current Gray Frame
     Mat Gray;
 
+    // RGB 模式下由当前帧转换得到的灰度图
+    // Gray Image converted from Current Frame in RGB mode
+    Mat Gray_buf;
+
     // 当前帧通道数
     // Channels' Number of Current Frame
     int Channels;
@@ -115,42 +268,69 @@ private:
     //====================================================
     //        样本库相关  |  Sample Library Information Related
     //====================================================
-    // 样本库
-    // Sample Library, size = img.rows * img.cols *  DEFAULT_NUM_SAMPLES
-    unsigned char ***samples;
+    // 样本库，一次分配的连续内存，按样本平面存储：
+    //     num_samples 个灰度样本平面，RGB 模式下之后是 3 * num_samples 个 BGR 通道样本平面；
+    // Sample Library, one contiguous aligned buffer in sample-plane-major layout:
+    //     num_samples gray sample planes, followed by 3 * num_samples BGR channel sample planes in RGB mode.
+    // Gray sample k of pixel (i, j) is samples[k * plane_size + i * cols + j].
+    uchar *samples;
+
+    // RGB通道图像样本库，指向样本库中的 BGR 通道样本平面，灰度模式为 NULL；
+    // 第 k 个样本的第 c 通道位于 samples_Frame[(3 * k + c) * plane_size + i * cols + j]
+    // RGB Channels Sample Library, points to the BGR channel sample planes of the Sample Library, NULL in gray mode.
+    // Channel c of sample k is samples_Frame[(3 * k + c) * plane_size + i * cols + j]
+    uchar *samples_Frame;
+
+    // RGB通道样本的模平方，写入样本时缓存，num_samples 个平面，灰度模式为 NULL
+    // Squared Norms of RGB Channels Samples, cached when a sample is written, num_samples planes, NULL in gray mode
+    int *samples_FrameNorm2;
+
+    // 每个样本平面的元素个数（按 64 对齐）
+    // Elements of each sample plane (rounded up to 64)
+    size_t plane_size;
 
-    // RGB通道图像样本库
-    // Sample Library, size = img.rows * img.cols *  DEFAULT_NUM_SAMPLES * 3 (The 3 values Save the pixel's [B, G, R])
-    unsigned char ****samples_Frame;
-
-    // 样本集灰度方差
-    // the Gray Value Variance of Sample Set
-    double **samples_sumsqr;
-
-    // 样本集灰度均值
-    // the Gray Value Average Value of Sample Set
-    double **samples_ave;
-
-    // 样本连续记为前景次数
-    // the Number of Times Counted as Foreground Point Continuously
-    int **samples_ForeNum;
-
-    // 样本是否为背景内边缘?  0:  NO;  1:  YES
-    // Is the Sample Background's Inner Edge?
-    // 0 -- No;  1 -- Yes
-    bool **samples_BGInner;
-
-    // 样本在背景内边缘状况下，八邻域状态位
-    // the Samples' State Bits of 8 Neighbor Area (If Current Pixel Belongs to Background Inner Edge)
-    int **samples_InnerState;
-
-    // 样本闪烁等级
-    // Blink Level of the Samples
-    int **samples_BlinkLevel;
-
-    // 样本邻域梯度最大值
-    // the Max Value of Sample
-    int **samples_MaxInnerGrad;
+    //====================================================
+    //   像素状态平面，一次分配的连续内存，每个像素共 9 字节，像素 (i, j) 位于 [i * cols + j]；
+    //   各平面按实际取值范围选择整数宽度
+    //----------------------------------------------------
+    //   Pixel State Planes, one contiguous aligned buffer, 9 bytes per pixel in total,
+    // pixel (i, j) is at [i * cols + j]. Every plane uses the integer width of its real range.
+    //====================================================
+    // 样本集灰度平方和，不超过 num_samples * 255^2
+    // the Sum of Squared Gray Values of Sample Set, at most num_samples * 255^2
+    uint *samples_sqsum;
+
+    // 样本集灰度和，不超过 num_samples * 255，故 num_samples 不能超过 257，由构造函数检查
+    // the Sum of Gray Values of Sample Set, at most num_samples * 255, so num_samples must not exceed 257,
+    // checked by the constructor
+    ushort *samples_sum;
+
+    // 样本集的距离自适应阈值，由灰度和与平方和计算，样本替换时更新
+    // the Adaptive Threshold of Distance of Sample Set, calculated from Sum & Sum of Squares when a sample is replaced
+    uchar *samples_AdaThreshold;
+
+    // 样本连续记为前景次数，饱和于255（只与50比较）
+    // the Number of Times Counted as Foreground Point Continuously, saturated at 255 (only compared with 50)
+    uchar *samples_ForeNum;
+
+    // 样本闪烁等级，0 - 150
+    // Blink Level of the Samples, 0 - 150
+    uchar *samples_BlinkLevel;
+
+    // 分割模板的位压缩形式，每个像素 1 bit，前景为1；
+    // 上一帧的位压缩分割模板代替了逐像素存储的八邻域状态位
+    // Bit-packed Segment Model, 1 bit per pixel, 1 for Foreground;
+    // the Bit-packed Segment Model of Previous Frame replaces the per-pixel State Bits of 8 Neighbor Area
+    BitMask SegBits;
+    BitMask PrevSegBits;
+
+    // 相对上一帧改变状态的像素，位压缩形式
+    // Bit-packed Pixels which changed state since Previous Frame
+    BitMask ChangedBits;
+
+    // 分割模板的连通区域，用于填充前景空洞与移除前景斑点
+    // Connected Regions of Segment Model, used to fill Foreground Holes & remove Foreground Blobs
+    ConnectedRegions SegRegions;
 
     // 前景模型二值图像，表示分割出的前景与背景信息；
     // Foreground Model Binary Image
@@ -177,6 +357,38 @@ private:
     // 子采样概率
     // the probability of random sample
     int random_sample;
+
+    // 自适应阈值查找表：ada_limits[t - ADA_THRESHOLD_MIN] 为阈值不超过 t 时 N * sqsum - sum * sum 的最大值
+    // Lookup Table of Adaptive Threshold: ada_limits[t - ADA_THRESHOLD_MIN] is the max N * sqsum - sum * sum whose threshold is not larger than t
+    int ada_limits[ADA_THRESHOLD_MAX - ADA_THRESHOLD_MIN];
+
+    // 随机数生成器，跨帧保持状态，为每个条带生成独立的种子
+    // Random Number Generator, keeps its state across frames and seeds every band's own stream
+    RNG rng;
+
+    // 更新决策的随机数来源
+    // Random Source of the Update Decisions
+    int random_mode;
+
+    // 预先生成的随机数表
+    // Precomputed Random Number Tables
+    RandTable rand_table;
+
+    // 运行方式
+    // Pipeline Mode
+    int pipeline_mode;
+
+    // 几何分布参数 log(1 - 1 / random_sample)
+    // Parameter log(1 - 1 / random_sample) of the geometric distribution
+    double update_log_q;
+
+    // 并行处理的线程（行条带）个数
+    // Number of Threads (Row Bands) for parallel Run
+    int num_threads;
+
+    // 本帧的行条带
+    // Row Bands of this Frame
+    vector<ViBePlusBand> bands;
 };
 
 
@@ -0,0 +1,259 @@
+/*=================================================================
+ * Vectorized Kernels of ViBe+ Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include <cstdlib>
+#include "ViBePlusKernel.h"
+
+#if VIBEPLUS_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/*===================================================================
+ * 函数名：ViBePlusClassifyRowScalar
+ * 说明：逐像素计算匹配个数，对一行像素进行分类（标量版本）；
+ *    样本满足匹配条件：灰度距离小于自适应阈值，且颜色畸变小于 VIBEPLUS_COLOR_DIST；
+ *    颜色畸变 colordist^2 = |p|^2 - (p . s)^2 / |s|^2，两边同乘 |s|^2 后以 64 位整数比较；
+ * 参数：
+ *   const unsigned char *gray:  当前行灰度值
+ *   const unsigned char *bgr:  当前行 BGR 交错像素，灰度模式为 NULL
+ *   const unsigned char *samples:  灰度样本平面中对应当前行的位置
+ *   const unsigned char *samples_bgr:  BGR 通道样本平面中对应当前行的位置
+ *   const int *samples_norm2:  BGR 样本模平方平面中对应当前行的位置
+ *   size_t plane_size:  每个样本平面的元素个数
+ *   int width:  像素个数
+ *   int num_samples:  每个像素点的样本个数
+ *   int num_min_matches:  #min指数
+ *   const unsigned char *ada_threshold:  当前行的自适应阈值
+ *   unsigned char *seg:  输出分割模板的一行，前景为255，背景为0
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ViBePlusClassifyRowScalar
+ *
+ * Summary:
+ *   Classify one row of pixels by counting matched samples pixel by pixel (Scalar Version).
+ *   A sample matches when the gray distance is less than the Adaptive Threshold and the
+ * Color Distortion is less than VIBEPLUS_COLOR_DIST. The Color Distortion
+ * colordist^2 = |p|^2 - (p . s)^2 / |s|^2 is compared in 64-bit integers after multiplying
+ * both sides by |s|^2.
+ *
+ * Arguments:
+ *   const unsigned char *gray - gray values of current row
+ *   const unsigned char *bgr - interleaved BGR pixels of current row, NULL in gray mode
+ *   const unsigned char *samples - current row's position in the gray sample planes
+ *   const unsigned char *samples_bgr - current row's position in the BGR channel sample planes
+ *   const int *samples_norm2 - current row's position in the squared BGR sample norm planes
+ *   size_t plane_size - elements of one sample plane
+ *   int width - number of pixels
+ *   int num_samples - Number of pixel's samples
+ *   int num_min_matches - Match Number of make pixel as Background
+ *   const unsigned char *ada_threshold - Adaptive Thresholds of current row
+ *   unsigned char *seg - output row of Segment Model, 255 for foreground, 0 for background
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlusClassifyRowScalar(const unsigned char *gray, const unsigned char *bgr,
+                               const unsigned char *samples, const unsigned char *samples_bgr, const int *samples_norm2,
+                               size_t plane_size, int width, int num_samples, int num_min_matches,
+                               const unsigned char *ada_threshold, unsigned char *seg)
+{
+    for(int j = 0; j < width; j++)
+    {
+        int B = 0, G = 0, R = 0;
+        long long norm2 = 0;
+        if(bgr)
+        {
+            B = bgr[3 * j]; G = bgr[3 * j + 1]; R = bgr[3 * j + 2];
+            norm2 = B * B + G * G + R * R;
+        }
+
+        int k, matches;
+        for(k = 0, matches = 0; matches < num_min_matches && k < num_samples; k++)
+        {
+            bool colormatch = true;
+            if(bgr)
+            {
+                const unsigned char *sam = samples_bgr + 3 * k * plane_size + j;
+                long long sam_norm2 = samples_norm2[k * plane_size + j];
+                long long dot = sam[0] * B + sam[plane_size] * G + sam[2 * plane_size] * R;
+
+                // 黑色样本（模为0）的颜色畸变视为0
+                // A black sample (zero norm) has no Color Distortion
+                colormatch = sam_norm2 == 0 ||
+                             norm2 * sam_norm2 - dot * dot < VIBEPLUS_COLOR_DIST * VIBEPLUS_COLOR_DIST * sam_norm2;
+            }
+
+            if(abs(samples[k * plane_size + j] - gray[j]) < ada_threshold[j] && colormatch)
+                matches++;
+        }
+        seg[j] = matches >= num_min_matches ? 0 : 255;
+    }
+}
+
+/*===================================================================
+ * 函数名：ViBePlusClassifyRow
+ * 说明：向量化计算一行像素的匹配个数，并输出分割模板的一行；
+ *    SSE2 每次处理 8 个像素，剩余像素使用标量版本；
+ *    颜色畸变以拉格朗日恒等式 |p|^2 |s|^2 - (p . s)^2 = |p x s|^2 计算，叉积各分量以 madd 求得，
+ *    分量绝对值超过 sqrt(20^2 * 3 * 255^2) 时必然不匹配，故截断到该值后平方和不会溢出 32 位整数；
+ *    全部像素都已满足 #min 指数时提前结束样本遍历，输出与标量版本逐位一致；
+ * 参数：
+ *   参数与 ViBePlusClassifyRowScalar 相同
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ViBePlusClassifyRow
+ *
+ * Summary:
+ *   Count matched samples for a whole row with SIMD instructions, and write the Segment
+ * Model row.
+ *   SSE2 handles 8 pixels at a time, the remaining pixels are handled by the scalar version.
+ *   The Color Distortion uses Lagrange's identity |p|^2 |s|^2 - (p . s)^2 = |p x s|^2, whose
+ * cross product components come from madd. A component larger than
+ * sqrt(20^2 * 3 * 255^2) can never match, so clamping to it keeps the sum of squares in
+ * 32-bit integers.
+ *   The sample loop stops early once every lane has reached num_min_matches, so the output
+ * is bit-exact with the scalar version.
+ *
+ * Arguments:
+ *   the same as ViBePlusClassifyRowScalar
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBePlusClassifyRow(const unsigned char *gray, const unsigned char *bgr,
+                         const unsigned char *samples, const unsigned char *samples_bgr, const int *samples_norm2,
+                         size_t plane_size, int width, int num_samples, int num_min_matches,
+                         const unsigned char *ada_threshold, unsigned char *seg)
+{
+    int j = 0;
+
+#if VIBEPLUS_SIMD_SSE2
+    if(num_min_matches > 0 && num_min_matches <= 32767)
+    {
+        // 叉积分量的截断值：ceil(sqrt(20^2 * 3 * 255^2))
+        // Clamp of cross product components: ceil(sqrt(20^2 * 3 * 255^2))
+        const __m128i cross_max = _mm_set1_epi16(8834);
+        const __m128i cross_min = _mm_set1_epi16(-8834);
+        const __m128i vmin = _mm_set1_epi16((short)(num_min_matches - 1));
+        const __m128i zero = _mm_setzero_si128();
+
+        for(; j <= width - 8; j += 8)
+        {
+            __m128i g = _mm_loadl_epi64((const __m128i *)(gray + j));
+
+            // |sample - pixel| < threshold  <=>  |sample - pixel| <= threshold - 1
+            __m128i thr = _mm_subs_epu8(_mm_loadl_epi64((const __m128i *)(ada_threshold + j)), _mm_set1_epi8(1));
+
+            // 当前像素的通道值两两交错：(G, R)、(R, B)、(B, G)，与样本的 (s_R, -s_G)、(s_B, -s_R)、(s_G, -s_B) 做 madd 得到叉积分量
+            // Channels of current pixels interleaved in pairs (G, R), (R, B), (B, G); madd with the sample's
+            // (s_R, -s_G), (s_B, -s_R), (s_G, -s_B) gives the cross product components
+            __m128i gr_lo = zero, gr_hi = zero, rb_lo = zero, rb_hi = zero, bg_lo = zero, bg_hi = zero;
+            if(bgr)
+            {
+                short pb[8], pg[8], pr[8];
+                for(int m = 0; m < 8; m++)
+                {
+                    pb[m] = bgr[3 * (j + m)];
+                    pg[m] = bgr[3 * (j + m) + 1];
+                    pr[m] = bgr[3 * (j + m) + 2];
+                }
+                __m128i B = _mm_loadu_si128((const __m128i *)pb);
+                __m128i G = _mm_loadu_si128((const __m128i *)pg);
+                __m128i R = _mm_loadu_si128((const __m128i *)pr);
+                gr_lo = _mm_unpacklo_epi16(G, R); gr_hi = _mm_unpackhi_epi16(G, R);
+                rb_lo = _mm_unpacklo_epi16(R, B); rb_hi = _mm_unpackhi_epi16(R, B);
+                bg_lo = _mm_unpacklo_epi16(B, G); bg_hi = _mm_unpackhi_epi16(B, G);
+            }
+
+            __m128i cnt = zero, bg = zero;
+            for(int k = 0; k < num_samples; k++)
+            {
+                __m128i s = _mm_loadl_epi64((const __m128i *)(samples + k * plane_size + j));
+                __m128i d = _mm_or_si128(_mm_subs_epu8(s, g), _mm_subs_epu8(g, s));
+                __m128i m8 = _mm_cmpeq_epi8(_mm_subs_epu8(d, thr), zero);
+                __m128i m = _mm_unpacklo_epi8(m8, m8);
+
+                if(bgr)
+                {
+                    const unsigned char *sam = samples_bgr + 3 * k * plane_size + j;
+                    __m128i sb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)sam), zero);
+                    __m128i sg = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(sam + plane_size)), zero);
+                    __m128i sr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(sam + 2 * plane_size)), zero);
+                    __m128i nsb = _mm_sub_epi16(zero, sb), nsg = _mm_sub_epi16(zero, sg), nsr = _mm_sub_epi16(zero, sr);
+
+                    // 叉积分量：cx = G s_R - R s_G，cy = R s_B - B s_R，cz = B s_G - G s_B
+                    // Cross product components: cx = G s_R - R s_G, cy = R s_B - B s_R, cz = B s_G - G s_B
+                    __m128i cx = _mm_packs_epi32(_mm_madd_epi16(gr_lo, _mm_unpacklo_epi16(sr, nsg)),
+                                                 _mm_madd_epi16(gr_hi, _mm_unpackhi_epi16(sr, nsg)));
+                    __m128i cy = _mm_packs_epi32(_mm_madd_epi16(rb_lo, _mm_unpacklo_epi16(sb, nsr)),
+                                                 _mm_madd_epi16(rb_hi, _mm_unpackhi_epi16(sb, nsr)));
+                    __m128i cz = _mm_packs_epi32(_mm_madd_epi16(bg_lo, _mm_unpacklo_epi16(sg, nsb)),
+                                                 _mm_madd_epi16(bg_hi, _mm_unpackhi_epi16(sg, nsb)));
+                    cx = _mm_max_epi16(_mm_min_epi16(cx, cross_max), cross_min);
+                    cy = _mm_max_epi16(_mm_min_epi16(cy, cross_max), cross_min);
+                    cz = _mm_max_epi16(_mm_min_epi16(cz, cross_max), cross_min);
+
+                    // |p x s|^2 = cx^2 + cy^2 + cz^2
+                    __m128i xy_lo = _mm_unpacklo_epi16(cx, cy), xy_hi = _mm_unpackhi_epi16(cx, cy);
+                    __m128i z_lo = _mm_unpacklo_epi16(cz, zero), z_hi = _mm_unpackhi_epi16(cz, zero);
+                    __m128i cross_lo = _mm_add_epi32(_mm_madd_epi16(xy_lo, xy_lo), _mm_madd_epi16(z_lo, z_lo));
+                    __m128i cross_hi = _mm_add_epi32(_mm_madd_epi16(xy_hi, xy_hi), _mm_madd_epi16(z_hi, z_hi));
+
+                    // 20^2 |s|^2 = (256 + 128 + 16) |s|^2
+                    const int *norm2 = samples_norm2 + k * plane_size + j;
+                    __m128i n_lo = _mm_loadu_si128((const __m128i *)norm2);
+                    __m128i n_hi = _mm_loadu_si128((const __m128i *)(norm2 + 4));
+                    __m128i lim_lo = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(n_lo, 8), _mm_slli_epi32(n_lo, 7)), _mm_slli_epi32(n_lo, 4));
+                    __m128i lim_hi = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(n_hi, 8), _mm_slli_epi32(n_hi, 7)), _mm_slli_epi32(n_hi, 4));
+
+                    // 黑色样本（模为0）的颜色畸变视为0
+                    // A black sample (zero norm) has no Color Distortion
+                    __m128i c_lo = _mm_or_si128(_mm_cmplt_epi32(cross_lo, lim_lo), _mm_cmpeq_epi32(n_lo, zero));
+                    __m128i c_hi = _mm_or_si128(_mm_cmplt_epi32(cross_hi, lim_hi), _mm_cmpeq_epi32(n_hi, zero));
+                    m = _mm_and_si128(m, _mm_packs_epi32(c_lo, c_hi));
+                }
+
+                // 匹配的像素计数加1
+                // Count of matched pixels plus 1
+                cnt = _mm_sub_epi16(cnt, m);
+                if(k + 1 >= num_min_matches)
+                {
+                    bg = _mm_cmpgt_epi16(cnt, vmin);
+                    if(_mm_movemask_epi8(bg) == 0xFFFF)
+                        break;
+                }
+            }
+
+            __m128i fg = _mm_cmpeq_epi16(bg, zero);
+            _mm_storel_epi64((__m128i *)(seg + j), _mm_packs_epi16(fg, fg));
+        }
+    }
+#endif
+
+    if(bgr)
+        ViBePlusClassifyRowScalar(gray + j, bgr + 3 * j, samples + j, samples_bgr + j, samples_norm2 + j,
+                                  plane_size, width - j, num_samples, num_min_matches, ada_threshold + j, seg + j);
+    else
+        ViBePlusClassifyRowScalar(gray + j, NULL, samples + j, NULL, NULL,
+                                  plane_size, width - j, num_samples, num_min_matches, ada_threshold + j, seg + j);
+}
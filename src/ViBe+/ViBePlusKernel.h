@@ -0,0 +1,68 @@
+/*=================================================================
+ * Vectorized Kernels of ViBe+ Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef VIBEPLUSKERNEL_H
+#define VIBEPLUSKERNEL_H
+
+#include <cstddef>
+
+// 向量化指令集选择：SSE2 每次处理 8 个像素，否则使用标量代码
+// SIMD Instruction Set: SSE2 handles 8 pixels per iteration, otherwise the scalar code is used.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIBEPLUS_SIMD_SSE2 1
+#endif
+
+// 颜色畸变阈值
+// Threshold of Color Distortion
+#define VIBEPLUS_COLOR_DIST  20
+
+/*===================================================================
+ * 说明：样本库按样本平面存储，每个平面 plane_size 个元素，传入的指针均指向第 0 个平面中当前行的位置：
+ *    - samples:      num_samples 个灰度样本平面，第 k 个样本位于 samples[k * plane_size + j]
+ *    - samples_bgr:  3 * num_samples 个 BGR 通道样本平面，第 k 个样本的第 c 通道位于 samples_bgr[(3 * k + c) * plane_size + j]
+ *    - samples_norm2:  num_samples 个 BGR 样本模平方平面，第 k 个样本位于 samples_norm2[k * plane_size + j]
+ *------------------------------------------------------------------
+ * Summary:
+ *   The Sample Library is stored as sample planes of plane_size elements each, and every
+ * pointer passed in points to current row's position in plane 0:
+ *    - samples:      num_samples gray sample planes, sample k is samples[k * plane_size + j]
+ *    - samples_bgr:  3 * num_samples BGR channel sample planes, channel c of sample k is
+ *                    samples_bgr[(3 * k + c) * plane_size + j]
+ *    - samples_norm2:  num_samples planes of squared BGR sample norms, sample k is samples_norm2[k * plane_size + j]
+=====================================================================
+*/
+
+// 对一行像素进行前景/背景分类，输出分割模板的一行（前景为255，背景为0）；bgr 为 NULL 时以灰度模式运行
+// Classify one row of pixels and write the Segment Model row (255 for foreground, 0 for background);
+// runs in gray mode when bgr is NULL.
+void ViBePlusClassifyRow(const unsigned char *gray, const unsigned char *bgr,
+                         const unsigned char *samples, const unsigned char *samples_bgr, const int *samples_norm2,
+                         size_t plane_size, int width, int num_samples, int num_min_matches,
+                         const unsigned char *ada_threshold, unsigned char *seg);
+
+// 标量版本，与向量化版本输出逐位一致
+// Scalar Version, its output is bit-exact with the vectorized version.
+void ViBePlusClassifyRowScalar(const unsigned char *gray, const unsigned char *bgr,
+                               const unsigned char *samples, const unsigned char *samples_bgr, const int *samples_norm2,
+                               size_t plane_size, int width, int num_samples, int num_min_matches,
+                               const unsigned char *ada_threshold, unsigned char *seg);
+
+#endif // VIBEPLUSKERNEL_H
@@ -20,6 +20,29 @@
 // 振幅乘数因子
 #define AMP_MULTIFACTOR  0.5
 
+// 自适应阈值的范围
+// Range of Adaptive Threshold
+#define ADA_THRESHOLD_MIN  20
+#define ADA_THRESHOLD_MAX  40
+
+// ViBe+ 的运行方式：分三步依次遍历整帧，或按行流水线单次遍历
+// Pipeline Mode of ViBe+: three full-frame stages one after another, or one row-pipelined sweep
+#define PIPELINE_STAGED  0
+#define PIPELINE_FUSED   1
+
+// 并行条带的最小行数
+// the Minimum Rows of a parallel Row Band
+#define VIBEPLUS_MIN_BAND_ROWS 8
+
+// 更新模板中被填充的前景空洞区域的面积上限（轮廓面积，与 contourArea 相同）
+// Max Area (contour area, the same as contourArea) of the Foreground Hole Areas filled in Update Model
+#define UPDATE_HOLE_AREA  50
+
+// 分割模板中被填充的前景空洞区域的面积上限，与被移除的前景斑点区域的面积下限（轮廓面积）
+// Max Area of the Foreground Hole Areas filled, and Min Area of the Foreground Blob Areas kept in Segment Model (contour area)
+#define SEG_HOLE_AREA  20
+#define SEG_BLOB_AREA  10
+
 // 连续记为前景次数
 #define ID_FORENUM  20
 
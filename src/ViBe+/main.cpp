@@ -20,10 +20,12 @@
 */
 
 #include "ViBePlus.h"
+#include "Common/Morphology.h"
 
 int main(int argc, char* argv[])
 {
-    Mat frame, gray, SegModel, UpdateModel;
+    Mat frame, gray, SegModel, UpdateModel, SegMask;
+    RectMorphology morphology;
     VideoCapture capture;
     capture = VideoCapture("./Video/Camera Road 01.avi");
     if(!capture.isOpened())
@@ -72,8 +74,9 @@ int main(int argc, char* argv[])
 
         SegModel = vibeplus.getSegModel();
         UpdateModel = vibeplus.getUpdateModel();
-//			morphologyEx(SegModel, SegModel, MORPH_OPEN, Mat());
-        imshow("SegModel", SegModel);
+        // 3x3 开运算去除孤立噪点，输出到 SegMask，不改动 ViBe+ 内部的分割模板
+        morphology.open(SegModel, SegMask, Size(3, 3));
+        imshow("SegModel", SegMask);
         imshow("UpdateModel", UpdateModel);
         imshow("input", frame);
 
@@ -25,7 +25,7 @@
  * 构造函数：ViBe
  * 说明：初始化ViBe算法部分参数；
  * 参数：
- *   int num_sam:  每个像素点的样本个数
+ *   int num_sam:  每个像素点的样本个数，(0, RAND_TABLE_MAX_SAMPLES]
  *   int min_match:  #min指数
  *   int r:  Sqthere半径
  *   int rand_sam:  子采样概率
@@ -36,7 +36,7 @@
  *   Init several arguments of ViBe Algorithm.
  *
  * Arguments:
- *   int num_sam - Number of pixel's samples
+ *   int num_sam - Number of pixel's samples, (0, RAND_TABLE_MAX_SAMPLES]
  *   int min_match - Match Number of make pixel as Background
  *   int r - Radius of pixel value
  *   int rand_sam - the probability of random sample
@@ -44,13 +44,26 @@
 */
 ViBe::ViBe(int num_sam, int min_match, int r, int rand_sam)
 {
+    // 样本编号在随机数表中以 uchar 存储
+    // Sample IDs are stored as uchar in the Random Number Tables
+    CV_Assert(num_sam > 0 && num_sam <= RAND_TABLE_MAX_SAMPLES);
+
     num_samples = num_sam;
     num_min_matches = min_match;
     radius = r;
     random_sample = rand_sam;
+    classify_row = ViBeSelectClassifyRow(num_samples, num_min_matches);
     int c_off[9] = {-1, 0, 1, -1, 1, -1, 0, 1, 0};
     for(int i = 0; i < 9; i++){
         c_xoff[i] = c_yoff[i] = c_off[i];
+    }
+
+    samples = NULL;
+    samples_ForeNum = NULL;
+    plane_size = 0;
+    rows = cols = 0;
+    num_threads = 0;
+    random_mode = RANDOM_MODE_RNG;
 }
 
 /*===================================================================
@@ -83,6 +96,8 @@ ViBe::~ViBe(void)
  *   Assign space for sample library.
  *   Read the first frame of video query as background model, then select pixel's
  * neighbourhood pixels randomly and fill the sample library.
+ *   The sample library is one allocation; it is only reallocated when the image
+ * size changes.
  *
  * Arguments:
  *   Mat img - source image
@@ -93,26 +108,29 @@ ViBe::~ViBe(void)
 */
 void ViBe::init(Mat img)
 {
-    // 动态分配三维数组，samples[][][num_samples]存储前景被连续检测的次数
-    // Dynamic Assign 3-D Array.
-    // sample[img.rows][img.cols][num_samples] is a 3-D Array which includes all pixels' samples.
-    samples = new unsigned char **[img.rows];
-    for (int i = 0; i < img.rows; i++)
-	{
-        samples[i] = new uchar *[img.cols];
-        for (int j = 0; j < img.cols; j++)
-		{
-            // 数组中，在num_samples之外多增的一个值，用于统计该像素点连续成为前景的次数；
-            // the '+ 1' in 'num_samples + 1', it's used to count times of this pixel regarded as foreground pixel.
-            samples[i][j] =new uchar [num_samples + 1];
-            for (int k = 0; k < num_samples + 1; k++)
-			{
-                // 创建样本库时，所有样本全部初始化为0
-                // All Samples init as 0 When Creating Sample Library.
-                samples[i][j][k] = 0;
-			}
-		}
-	}
+    // 图像尺寸改变时，重新分配样本库
+    // Reassign Sample Library when Image Size Changes
+    if(samples == NULL || img.rows != rows || img.cols != cols)
+    {
+        deleteSamples();
+
+        rows = img.rows;
+        cols = img.cols;
+        plane_size = ((size_t)rows * cols + 63) & ~(size_t)63;
+
+        // 在num_samples个样本平面之外多增的一个平面，用于统计该像素点连续成为前景的次数；
+        // the '+ 1' in 'num_samples + 1', it's used to count times of this pixel regarded as foreground pixel.
+        samples = (uchar *)fastMalloc(plane_size * (num_samples + 1));
+        samples_ForeNum = samples + plane_size * num_samples;
+
+        // 随机数表的长度与图像宽度有关，需要重新生成
+        // Length of Random Number Tables depends on image width, so they need to be generated again
+        rand_table = RandTable();
+    }
+
+    // 创建样本库时，所有样本全部初始化为0
+    // All Samples init as 0 When Creating Sample Library.
+    memset(samples, 0, plane_size * (num_samples + 1));
 
     FGModel = Mat::zeros(img.size(),CV_8UC1);
 }
@@ -140,13 +158,13 @@ void ViBe::init(Mat img)
 */
 void ViBe::ProcessFirstFrame(Mat img)
 {
-	RNG rng;
 	int row, col;
 
     for(int i = 0; i < img.rows; i++)
 	{
         for(int j = 0; j < img.cols; j++)
 		{
+            uchar *sample = samples + (size_t)i * cols + j;
             for(int k = 0 ; k < num_samples; k++)
 			{
                 // 随机选择num_samples个邻域像素点，构建背景模型
@@ -164,15 +182,52 @@ void ViBe::ProcessFirstFrame(Mat img)
 
                 // 为样本库赋随机值
                 // Set random pixel's Value for Sample Library
-                samples[i][j][k]=img.at<uchar>(row, col);
+                sample[k * plane_size] = img.at<uchar>(row, col);
 			}
 		}
 	}
 }
 
+/*===================================================================
+ * 类名：ViBeBandInvoker
+ * 说明：在 OpenCV 线程池中并行处理 ViBe 的行条带；
+ *------------------------------------------------------------------
+ * Class: ViBeBandInvoker
+ *
+ * Summary:
+ *   Process Row Bands of ViBe in parallel on OpenCV's thread pool.
+=====================================================================
+*/
+class ViBeBandInvoker : public ParallelLoopBody
+{
+public:
+    ViBeBandInvoker(ViBe *v, const Mat &image, int n)
+        : vibe(v), img(image), nbands(n)
+    {
+    }
+
+    void operator()(const Range &range) const
+    {
+        for(int b = range.start; b < range.end; b++)
+        {
+            int row_begin = (int)((int64)img.rows * b / nbands);
+            int row_end = (int)((int64)img.rows * (b + 1) / nbands);
+            vibe->RunBand(img, row_begin, row_end, vibe->band_rngs[b], vibe->band_deferred[b]);
+        }
+    }
+
+private:
+    ViBe *vibe;
+    Mat img;
+    int nbands;
+};
+
 /*===================================================================
  * 函数名：Run
  * 说明：运行 ViBe 算法，提取前景区域并更新背景模型样本库；
+ *    图像被划分为若干行条带，在 OpenCV 线程池中并行处理，每个条带使用独立种子的随机数生成器；
+ *    跨越条带边界的邻域样本更新先存入各条带的队列，全部条带处理完成后再写入样本库；
+ *    RANDOM_MODE_TABLE 模式下，更新决策从预先生成的随机数表中以随机的偏移读取，不再调用 RNG；
  * 参数：
  *   Mat img:  源图像
  * 返回值：void
@@ -181,6 +236,12 @@ void ViBe::ProcessFirstFrame(Mat img)
  *
  * Summary:
  *   Run the ViBe Algorithm: Extract Foreground Areas & Update Background Model Sample Library.
+ *   The image is split into row bands which run in parallel on OpenCV's thread pool, and
+ * every band draws from its own independently seeded Random Number Generator.
+ *   Neighbour sample updates crossing a band border are queued per band, and written into
+ * the sample library after all bands have finished.
+ *   In RANDOM_MODE_TABLE, the update decisions are read from precomputed random number
+ * tables at a random offset instead of calling RNG.
  *
  * Arguments:
  *   Mat img - source image
@@ -191,133 +252,224 @@ void ViBe::ProcessFirstFrame(Mat img)
 */
 void ViBe::Run(Mat img)
 {
-    RNG rng;
-    int k = 0, dist = 0, matches = 0;
-    for(int i = 0; i < img.rows; i++)
-	{
-        for(int j = 0; j < img.cols; j++)
+    // 条带个数，每个条带至少 VIBE_MIN_BAND_ROWS 行
+    // Number of Bands, every band has VIBE_MIN_BAND_ROWS rows at least
+    int nbands = num_threads > 0 ? num_threads : getNumThreads();
+    nbands = max(1, min(nbands, img.rows / VIBE_MIN_BAND_ROWS));
+
+    // 由跨帧的随机数生成器为每个条带生成种子，使每帧的随机更新模式都不相同
+    // Seed every band from the frame-persistent generator, so the random update pattern changes every frame
+    if(random_mode == RANDOM_MODE_TABLE && rand_table.empty())
+        rand_table.init(num_samples, random_sample, cols, ((uint64)rng.next() << 32) | rng.next());
+
+    band_rngs.resize(nbands);
+    band_deferred.resize(nbands);
+    for(int b = 0; b < nbands; b++)
+    {
+        uint64 seed = ((uint64)rng.next() << 32) | rng.next();
+        band_rngs[b] = RNG(seed);
+        band_deferred[b].clear();
+    }
+
+    parallel_for_(Range(0, nbands), ViBeBandInvoker(this, img, nbands));
+
+    // 写入跨越条带边界的邻域样本更新
+    // Write the Neighbour Sample Updates crossing Band Borders
+    for(int b = 0; b < nbands; b++)
+    {
+        const vector<ViBeDeferredWrite> &deferred = band_deferred[b];
+        for(size_t n = 0; n < deferred.size(); n++)
+            samples[deferred[n].offset] = deferred[n].value;
+    }
+}
+
+/*===================================================================
+ * 函数名：RunBand
+ * 说明：对 [row_begin, row_end) 行条带运行 ViBe 算法；
+ *    分类与更新分为两遍：第一遍由向量化核函数无分支地完成分类；
+ *    第二遍按几何分布的间隔直接跳到下一个更新像素，只在这些位置检查背景模板，
+ *    更新的计算量与更新次数成正比，而与像素个数无关；
+ * 参数：
+ *   const Mat &img:  源图像
+ *   int row_begin:  条带起始行
+ *   int row_end:  条带结束行（不包含）
+ *   RNG &band_rng:  条带的随机数生成器
+ *   vector<ViBeDeferredWrite> &deferred:  跨越条带边界的邻域样本更新队列
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: RunBand
+ *
+ * Summary:
+ *   Run the ViBe Algorithm on Row Band [row_begin, row_end).
+ *   Classification and update are two separate passes: the first pass classifies the
+ * band without branches by the vectorized kernel; the second pass jumps straight to the
+ * next updating pixel by a geometrically distributed gap and checks the background mask
+ * only there, so the update cost is proportional to the number of updates rather than the
+ * number of pixels.
+ *
+ * Arguments:
+ *   const Mat &img - source image
+ *   int row_begin - first row of the band
+ *   int row_end - end row of the band (exclusive)
+ *   RNG &band_rng - Random Number Generator of the band
+ *   vector<ViBeDeferredWrite> &deferred - Queue of Neighbour Sample Updates crossing the band border
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBe::RunBand(const Mat &img, int row_begin, int row_end, RNG &band_rng, vector<ViBeDeferredWrite> &deferred)
+{
+    //========================================
+    //        一、前景提取   |   Step 1 : Extract Foreground Areas
+    //========================================
+    /*===================================================================
+     * 说明：计算当前行像素值与样本库的匹配情况，逐个样本平面线性遍历，
+     *    当前像素值与样本库中值之差小于阈值范围RADIUS的个数不小于#min指数，则为背景；
+     *    向量化核函数直接输出前景模型的一行，背景像素的前景统计次数置0，前景像素的前景统计次数+1；
+     *    常用的样本个数与 #min 指数使用编译期特化的 ViBeEngine，样本遍历完全展开；
+     *------------------------------------------------------------------
+     * Summary:
+     *   Count how many samples in library can match to current row's pixel values,
+     * walking every sample plane linearly. A pixel is background when the Number of
+     * samples whose value subtract current pixel's value is less than RADIUS reaches
+     * num_min_matches.
+     *   The vectorized kernel writes the Foreground Model row directly, sets the count of
+     * foreground statistic as 0 for background pixels and plus 1 for foreground pixels.
+     *   Common sample counts and match numbers use the compile-time specialized ViBeEngine,
+     * whose sample loop is fully unrolled.
+    =====================================================================
+    */
+    for(int i = row_begin; i < row_end; i++)
+    {
+        classify_row(img.ptr<uchar>(i), samples + (size_t)i * cols, plane_size, cols,
+                     num_samples, num_min_matches, radius,
+                     FGModel.ptr<uchar>(i), samples_ForeNum + (size_t)i * cols);
+    }
+
+    //========================================
+    //        二、更新连续前景点   |   Step 2 : Update Long-time Foreground Pixels
+    //========================================
+    for(int i = row_begin; i < row_end; i++)
+    {
+        const uchar *pix = img.ptr<uchar>(i);
+        const uchar *fore_num = samples_ForeNum + (size_t)i * cols;
+        uchar *sample = samples + (size_t)i * cols;
+
+        // 使用随机数表时，每行以随机偏移读取随机数表
+        // When using Random Number Tables, every row reads the tables at a random offset
+        const RandEntry *rand_row = rand_table.empty() ? NULL : rand_table.row(band_rng.next());
+
+        for(int j = 0; j < cols; j++)
         {
-            //========================================
-            //        前景提取   |   Extract Foreground Areas
-            //========================================
-            /*===================================================================
-             * 说明：计算当前像素值与样本库的匹配情况；
-             * 参数：
-             *   int matches: 当前像素值与样本库中值之差小于阈值范围RADIUS的个数；
-             *   int count: 遍历样本库的缓存变量；
-             *------------------------------------------------------------------
-             * Summary:
-             *   Count how many samples in library can match to current pixel value.
-             *
-             * Argumen:
-             *   int matches - the Number of samples whose value subtract current pixel's value
-             *          is less than RADIUS.
-             *   int count - the temp variance for going through sample library.
-            =====================================================================
-            */
-            for(k = 0, matches = 0; matches < num_min_matches && k < num_samples; k++)
+            // 如果某个像素点连续50次被检测为前景，则认为一块静止区域被误判为运动，将其更新为背景点
+            // if this pixel is regarded as foreground for more than 50 times, then we regard this static area as dynamic area by mistake, and Run this pixel as background one.
+            if(fore_num[j] > 50)
             {
-                dist = abs(samples[i][j][k] - img.at<uchar>(i, j));
-                if (dist < radius)
-                    matches++;
+                int random = rand_row ? rand_row[j].sample_fore : band_rng.uniform(0, num_samples);
+                sample[random * plane_size + j] = pix[j];
             }
-            /*===================================================================
-             * 说明：
-             *      当前像素值与样本库中值匹配次数较高，则认为是背景像素点；
-             *      此时更新前景统计次数、更新前景模型、更新该像素模型样本值、更新该像素点邻域像素点的模型样本值
-             *------------------------------------------------------------------
-             * Summary:
-             *   the Match Times of current pixel value and samples in library is large enough to
-             * regard current pixel as a Background pixel.
-             *   Then it needs to be done:
-             *   - Run the times of Foreground Statistic
-             *   - Run Foreground Model
-             *   - Run model sample library of this pixel probably
-             *   - Run model sample library of this pixel's neighborhood pixel probably
-            =====================================================================
-            */
-            if (matches >= num_min_matches)
-            {
-                // 已经认为是背景像素，故该像素的前景统计次数置0
-                // This pixel has regard as a background pixel, so the count of this pixel's foreground statistic set as 0
-                samples[i][j][num_samples]=0;
+        }
+    }
 
-                // 该像素点被的前景模型像素值置0
-                // Set Foreground Model's pixel as 0
-                FGModel.at<uchar>(i, j) = 0;
-            }
-            /*===================================================================
-             * 说明：
-             *      当前像素值与样本库中值匹配次数较低，则认为是前景像素点；
-             *      此时需要更新前景统计次数、判断更新前景模型；
-             *------------------------------------------------------------------
-             * Summary:
-             *   the Match Times of current pixel value and samples in library is small enough to
-             * regard current pixel as a Foreground pixel.
-             *   Then it needs to be done:
-             *   - Run the times of Foreground Statistic
-             *   - Judge and Run Foreground Model
-            =====================================================================
-            */
-            else
-            {
-                // 已经认为是前景像素，故该像素的前景统计次数+1
-                // This pixel has regard as a foreground pixel, so the count of this pixel's foreground statistic plus 1
-                samples[i][j][num_samples]++;
-
-                // 该像素点被的前景模型像素值置255
-                // Set Foreground Model's pixel as 255
-                FGModel.at<uchar>(i, j) = 255;
-
-                // 如果某个像素点连续50次被检测为前景，则认为一块静止区域被误判为运动，将其更新为背景点
-                // if this pixel is regarded as foreground for more than 50 times, then we regard this static area as dynamic area by mistake, and Run this pixel as background one.
-                if(samples[i][j][num_samples] > 50)
-                {
-                    int random = rng.uniform(0, num_samples);
-                    samples[i][j][random]=img.at<uchar>(i, j);
-                }
-            }
+    //================================================================
+    //        三、更新模型样本库    |    Step 3 : Update Background Model Sample Library
+    //================================================================
+    const double log_q = RandTable::geometricLogQ(random_sample);
+    const int64 band_begin = (int64)row_begin * cols, band_end = (int64)row_end * cols;
+    const uchar *fg = FGModel.data;
+    unsigned cursor = band_rng.next();
+    const RandEntry *e;
+    int64 pos;
 
-            //================================================================
-            //        更新模型样本库    |    Update Background Model Sample Library
-            //================================================================
-            if (matches >= num_min_matches)
-            {
-                // 已经认为该像素是背景像素，那么它有 1 / φ 的概率去更新自己的模型样本值
-                // This pixel is already regarded as Background Pixel, then it has possibility of 1/φ to Run its model sample's value.
-                int random = rng.uniform(0, random_sample);
-                if (random == 0)
-                {
-                    random = rng.uniform(0, num_samples);
-                    samples[i][j][random]=img.at<uchar>(i, j);
-                }
-
-                // 同时也有 1 / φ 的概率去更新它的邻居点的模型样本值
-                // At the same time, it has possibility of 1/φ to Run its neighborhood point's sample value.
-                random = rng.uniform(0, random_sample);
-                if (random == 0)
-                {
-                    int row, col;
-                    random = rng.uniform(0, 9); row = i + c_yoff[random];
-                    random = rng.uniform(0, 9); col = j + c_xoff[random];
-
-                    // 防止选取的像素点越界
-                    // Protect Pixel from Crossing the border
-                    if (row < 0) row = 0;
-                    if (row >= img.rows)  row = img.rows - 1;
-                    if (col < 0) col = 0;
-                    if (col >= img.cols) col = img.cols - 1;
-
-                    // 为样本库赋随机值
-                    // Set random pixel's Value for Sample Library
-                    random = rng.uniform(0, num_samples);
-                    samples[row][col][random]=img.at<uchar>(i, j);
-                }
-            }
+    // 背景像素有 1 / φ 的概率去更新自己的模型样本值
+    // A Background Pixel has possibility of 1/φ to Run its model sample's value.
+    for(pos = band_begin - 1 + rand_table.drawGap(band_rng, log_q, cursor, e); pos < band_end;
+        pos += rand_table.drawGap(band_rng, log_q, cursor, e))
+    {
+        if(fg[pos] != 0)
+            continue;
+
+        int i = (int)(pos / cols), j = (int)(pos - (int64)i * cols);
+        int random = e ? e->sample_self : band_rng.uniform(0, num_samples);
+        samples[random * plane_size + pos] = img.ptr<uchar>(i)[j];
+    }
+
+    // 同时也有 1 / φ 的概率去更新它的邻居点的模型样本值
+    // At the same time, it has possibility of 1/φ to Run its neighborhood point's sample value.
+    for(pos = band_begin - 1 + rand_table.drawGap(band_rng, log_q, cursor, e); pos < band_end;
+        pos += rand_table.drawGap(band_rng, log_q, cursor, e))
+    {
+        if(fg[pos] != 0)
+            continue;
+
+        int i = (int)(pos / cols), j = (int)(pos - (int64)i * cols);
+        int row, col, random;
+        random = e ? e->neighbor_y : band_rng.uniform(0, 9); row = i + c_yoff[random];
+        random = e ? e->neighbor_x : band_rng.uniform(0, 9); col = j + c_xoff[random];
+
+        // 防止选取的像素点越界
+        // Protect Pixel from Crossing the border
+        if (row < 0) row = 0;
+        if (row >= img.rows)  row = img.rows - 1;
+        if (col < 0) col = 0;
+        if (col >= img.cols) col = img.cols - 1;
+
+        // 为样本库赋随机值，邻居点位于其他条带时延迟写入
+        // Set random pixel's Value for Sample Library, deferred if the neighbour belongs to another band
+        random = e ? e->sample_neighbor : band_rng.uniform(0, num_samples);
+        size_t offset = random * plane_size + (size_t)row * cols + col;
+        uchar value = img.ptr<uchar>(i)[j];
+        if (row < row_begin || row >= row_end)
+        {
+            ViBeDeferredWrite w = {offset, value};
+            deferred.push_back(w);
         }
+        else
+            samples[offset] = value;
     }
 }
 
+/*===================================================================
+ * 函数名：init / ProcessFirstFrame / Run
+ * 说明：由调用者持有的帧缓冲区初始化、处理第一帧与运行 ViBe 算法；
+ *    GRAY / NV12 / I420 格式直接按行跨度读取亮度平面，不拷贝、不做颜色转换；
+ *    BGR 格式转换为灰度图后处理；
+ * 参数：
+ *   const FrameView &frame:  帧视图
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: init / ProcessFirstFrame / Run
+ *
+ * Summary:
+ *   Init, Process First Frame & Run the ViBe Algorithm from a caller-owned frame buffer.
+ *   GRAY / NV12 / I420 read the luma plane directly by its stride, without copying or
+ * colour conversion. BGR is converted to a gray image first.
+ *
+ * Arguments:
+ *   const FrameView &frame - Frame View
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBe::init(const FrameView &frame)
+{
+    // 初始化只需要图像尺寸
+    // Only the image size is needed to init
+    init(FrameViewMat(frame));
+}
+
+void ViBe::ProcessFirstFrame(const FrameView &frame)
+{
+    ProcessFirstFrame(FrameViewGray(frame, gray_buf));
+}
+
+void ViBe::Run(const FrameView &frame)
+{
+    Run(FrameViewGray(frame, gray_buf));
+}
+
 /*===================================================================
  * 函数名：getFGModel
  * 说明：获取前景模型二值图像；
@@ -353,5 +505,89 @@ Mat ViBe::getFGModel()
 */
 void ViBe::deleteSamples()
 {
-    delete samples;
+    if(samples != NULL)
+        fastFree(samples);
+    samples = NULL;
+    samples_ForeNum = NULL;
+}
+
+/*===================================================================
+ * 函数名：setNumThreads
+ * 说明：设置并行处理的线程（行条带）个数；
+ * 参数：
+ *   int n:  线程个数，0 表示使用 OpenCV 线程池的线程个数
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setNumThreads
+ *
+ * Summary:
+ *   Set Number of Threads (Row Bands) for parallel Run.
+ *
+ * Arguments:
+ *   int n - Number of Threads, 0 means the thread number of OpenCV's thread pool
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBe::setNumThreads(int n)
+{
+    num_threads = max(n, 0);
+}
+
+/*===================================================================
+ * 函数名：setSeed
+ * 说明：设置随机数种子；
+ * 参数：
+ *   uint64 seed:  随机数种子
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setSeed
+ *
+ * Summary:
+ *   Set Seed of Random Number Generator.
+ *
+ * Arguments:
+ *   uint64 seed - Seed of Random Number Generator
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBe::setSeed(uint64 seed)
+{
+    rng = RNG(seed);
+}
+
+/*===================================================================
+ * 函数名：setRandomMode
+ * 说明：设置更新决策的随机数来源；
+ * 参数：
+ *   int mode:  随机数来源
+ *      - RANDOM_MODE_RNG:     逐次调用 RNG
+ *      - RANDOM_MODE_TABLE:   读取预先生成的随机数表
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: setRandomMode
+ *
+ * Summary:
+ *   Set Random Source of the Update Decisions.
+ *
+ * Arguments:
+ *   int mode - Random Source
+ *      - RANDOM_MODE_RNG:     call RNG one by one
+ *      - RANDOM_MODE_TABLE:   read the precomputed random number tables
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBe::setRandomMode(int mode)
+{
+    random_mode = mode;
+
+    // 随机数表为空时使用 RNG
+    // RNG is used when Random Number Tables are empty
+    if(random_mode != RANDOM_MODE_TABLE)
+        rand_table = RandTable();
 }
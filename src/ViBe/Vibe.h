@@ -19,9 +19,16 @@
 ===================================================================
 */
 
+#ifndef VIBE_H
+#define VIBE_H
+
 #include <iostream>
 #include <cstdio>
+#include <vector>
 #include "opencv2/opencv.hpp"
+#include "Common/RandTable.h"
+#include "Common/FrameView.h"
+#include "VibeKernel.h"
 
 using namespace cv;
 using namespace std;
@@ -42,6 +49,23 @@ using namespace std;
 // the Default the probability of random sample
 #define DEFAULT_RANDOM_SAMPLE 16
 
+// 并行条带的最小行数
+// the Minimum Rows of a parallel Row Band
+#define VIBE_MIN_BAND_ROWS 8
+
+// 跨越条带边界的邻域样本更新，在所有条带处理完成后再写入
+// Neighbour Sample Update crossing a Band Border, it is written after all bands finished.
+struct ViBeDeferredWrite
+{
+    // 样本在样本库中的偏移
+    // Offset of the Sample in Sample Library
+    size_t offset;
+
+    // 新样本值
+    // New Sample Value
+    uchar value;
+};
+
 class ViBe
 {
 public:
@@ -63,6 +87,12 @@ public:
     // Run the ViBe Algorithm: Extract Foreground Areas & Update Background Model Sample Library.
     void Run(Mat img);
 
+    // 由调用者持有的帧缓冲区初始化、处理第一帧与运行 ViBe 算法，GRAY / NV12 / I420 直接读取亮度平面，不拷贝
+    // Init, Process First Frame & Run ViBe from a caller-owned frame buffer; GRAY / NV12 / I420 read the luma plane directly without copying.
+    void init(const FrameView &frame);
+    void ProcessFirstFrame(const FrameView &frame);
+    void Run(const FrameView &frame);
+
     // 获取前景模型二值图像
     // get Foreground Model Binary Image.
     Mat getFGModel();
@@ -71,6 +101,18 @@ public:
     // Delete Sample Library.
     void deleteSamples();
 
+    // 设置并行处理的线程（行条带）个数，0 表示使用 OpenCV 线程池的线程个数
+    // Set Number of Threads (Row Bands) for parallel Run, 0 means the thread number of OpenCV's thread pool.
+    void setNumThreads(int n);
+
+    // 设置随机数种子
+    // Set Seed of Random Number Generator
+    void setSeed(uint64 seed);
+
+    // 设置更新决策的随机数来源：RANDOM_MODE_RNG 或 RANDOM_MODE_TABLE
+    // Set Random Source of the Update Decisions: RANDOM_MODE_RNG or RANDOM_MODE_TABLE
+    void setRandomMode(int mode);
+
     // x的邻居点
     // x's neighborhood points
     int c_xoff[9];
@@ -80,14 +122,39 @@ public:
     int c_yoff[9];
 
 private:
-    // 样本库
-    // Sample Library, size = img.rows * img.cols *  DEFAULT_NUM_SAMPLES
-    unsigned char ***samples;
+    friend class ViBeBandInvoker;
+
+    // 处理 [row_begin, row_end) 行条带，跨越条带边界的邻域样本更新存入 deferred
+    // Process Row Band [row_begin, row_end), Neighbour Sample Updates crossing the Band Border are stored in deferred.
+    void RunBand(const Mat &img, int row_begin, int row_end, RNG &band_rng, vector<ViBeDeferredWrite> &deferred);
+
+    // 样本库，一次分配的连续内存，按样本平面存储：
+    //     num_samples 个 rows * cols 的样本平面，之后是一个前景计数平面；
+    // Sample Library, one contiguous aligned buffer in sample-plane-major layout:
+    //     num_samples planes of rows * cols bytes, followed by the foreground count plane.
+    // Sample k of pixel (i, j) is samples[k * plane_size + i * cols + j].
+    uchar *samples;
+
+    // 前景计数平面，指向样本库中最后一个平面
+    // Foreground Count Plane, points to the last plane of the Sample Library
+    uchar *samples_ForeNum;
+
+    // 每个平面的字节数（按 64 字节对齐）
+    // Bytes of each plane (rounded up to 64 bytes)
+    size_t plane_size;
+
+    // 样本库对应的图像尺寸
+    // Image Size of Sample Library
+    int rows, cols;
 
     // 前景模型二值图像
     // Foreground Model Binary Image
     Mat FGModel;
 
+    // BGR 帧视图转换得到的灰度图
+    // Gray Image converted from BGR Frame Views
+    Mat gray_buf;
+
     // 每个像素点的样本个数
     // Number of pixel's samples
     int num_samples;
@@ -103,5 +170,32 @@ private:
     // 子采样概率
     // the probability of random sample
     int random_sample;
+
+    // 分类核函数，按样本个数与 #min 指数选择编译期特化的 ViBeEngine
+    // Classification Kernel, the compile-time specialized ViBeEngine selected by the Number of Samples and the Match Number
+    ViBeClassifyRowFunc classify_row;
+
+    // 并行处理的线程（行条带）个数
+    // Number of Threads (Row Bands) for parallel Run
+    int num_threads;
+
+    // 随机数生成器，跨帧保持状态，为每个条带生成独立的种子
+    // Random Number Generator, keeps its state across frames and seeds every band's own stream
+    RNG rng;
+
+    // 每个条带的随机数生成器与延迟写入队列
+    // Random Number Generator and Deferred Write Queue of every band
+    vector<RNG> band_rngs;
+    vector<vector<ViBeDeferredWrite> > band_deferred;
+
+    // 更新决策的随机数来源
+    // Random Source of the Update Decisions
+    int random_mode;
+
+    // 预先生成的随机数表
+    // Precomputed Random Number Tables
+    RandTable rand_table;
 };
 
+#endif // VIBE_H
+
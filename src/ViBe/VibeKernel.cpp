@@ -0,0 +1,369 @@
+/*=================================================================
+ * Vectorized Kernels of ViBe Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#include <cstdlib>
+#include "VibeKernel.h"
+
+#if VIBE_SIMD_AVX2
+#include <immintrin.h>
+#elif VIBE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/*===================================================================
+ * 函数名：ViBeClassifyRowScalar
+ * 说明：逐像素计算匹配个数，对一行像素进行分类（标量版本）；
+ * 参数：
+ *   const unsigned char *pix:  当前行像素
+ *   const unsigned char *samples:  第 0 个样本平面中对应当前行的位置
+ *   size_t plane_size:  样本平面的字节数
+ *   int width:  像素个数
+ *   int num_samples:  每个像素点的样本个数
+ *   int num_min_matches:  #min指数
+ *   int radius:  Sqthere半径
+ *   unsigned char *fg:  输出前景模型的一行，前景为255，背景为0
+ *   unsigned char *fore_num:  前景计数的一行，前景点加1，背景点置0
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ViBeClassifyRowScalar
+ *
+ * Summary:
+ *   Classify one row of pixels by counting matched samples pixel by pixel (Scalar Version).
+ *
+ * Arguments:
+ *   const unsigned char *pix - pixels of current row
+ *   const unsigned char *samples - current row's position in sample plane 0
+ *   size_t plane_size - bytes of one sample plane
+ *   int width - number of pixels
+ *   int num_samples - Number of pixel's samples
+ *   int num_min_matches - Match Number of make pixel as Background
+ *   int radius - Radius of pixel value
+ *   unsigned char *fg - output row of Foreground Model, 255 for foreground, 0 for background
+ *   unsigned char *fore_num - row of Foreground Counts, plus 1 for foreground, set as 0 for background
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBeClassifyRowScalar(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                           int width, int num_samples, int num_min_matches, int radius,
+                           unsigned char *fg, unsigned char *fore_num)
+{
+    for(int j = 0; j < width; j++)
+    {
+        int k, matches;
+        for(k = 0, matches = 0; matches < num_min_matches && k < num_samples; k++)
+        {
+            if(abs(samples[k * plane_size + j] - pix[j]) < radius)
+                matches++;
+        }
+        fg[j] = matches >= num_min_matches ? 0 : 255;
+        fore_num[j] = (unsigned char)((fore_num[j] + 1) & fg[j]);
+    }
+}
+
+/*===================================================================
+ * 函数名：ViBeClassifyRow
+ * 说明：向量化计算一行像素与全部样本平面的匹配个数，并直接输出前景模型的一行；
+ *    AVX2 每次处理 32 个像素，SSE2 每次处理 16 个像素，剩余像素使用标量版本；
+ *    全部像素都已满足 #min 指数时提前结束样本遍历，输出与标量版本逐位一致；
+ *    前景计数以 (fore_num + 1) & fg 无分支地更新；
+ * 参数：
+ *   参数与 ViBeClassifyRowScalar 相同
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ViBeClassifyRow
+ *
+ * Summary:
+ *   Count |sample_k - pixel| < radius over all sample planes for a whole row with SIMD
+ * instructions, and write the Foreground Model row directly.
+ *   AVX2 handles 32 pixels and SSE2 handles 16 pixels at a time, the remaining pixels
+ * are handled by the scalar version. The sample loop stops early once every lane has
+ * reached num_min_matches, so the output is bit-exact with the scalar version.
+ *   The Foreground Counts are updated without branches as (fore_num + 1) & fg.
+ *
+ * Arguments:
+ *   the same as ViBeClassifyRowScalar
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+void ViBeClassifyRow(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                     int width, int num_samples, int num_min_matches, int radius,
+                     unsigned char *fg, unsigned char *fore_num)
+{
+    int j = 0;
+
+    // 匹配个数以 uchar 饱和累加，因此 #min 指数须在 1 - 255 之间
+    // Match Counts are accumulated as saturated uchar, so num_min_matches must be in 1 - 255
+    if(radius > 0 && num_min_matches > 0 && num_min_matches <= 255)
+    {
+        // |sample - pixel| < radius  <=>  |sample - pixel| <= radius - 1
+        const char thr = (char)(radius > 256 ? 255 : radius - 1);
+        const char min_matches = (char)num_min_matches;
+
+#if VIBE_SIMD_AVX2
+        const __m256i vthr256 = _mm256_set1_epi8(thr);
+        const __m256i vmin256 = _mm256_set1_epi8(min_matches);
+        const __m256i one256 = _mm256_set1_epi8(1);
+        const __m256i zero256 = _mm256_setzero_si256();
+        for(; j <= width - 32; j += 32)
+        {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(pix + j));
+            __m256i cnt = zero256, bg = zero256;
+            for(int k = 0; k < num_samples; k++)
+            {
+                __m256i s = _mm256_loadu_si256((const __m256i *)(samples + k * plane_size + j));
+                __m256i d = _mm256_or_si256(_mm256_subs_epu8(s, p), _mm256_subs_epu8(p, s));
+                __m256i m = _mm256_cmpeq_epi8(_mm256_subs_epu8(d, vthr256), zero256);
+                cnt = _mm256_adds_epu8(cnt, _mm256_and_si256(m, one256));
+                if(k + 1 >= num_min_matches)
+                {
+                    bg = _mm256_cmpeq_epi8(_mm256_max_epu8(cnt, vmin256), cnt);
+                    if(_mm256_movemask_epi8(bg) == -1)
+                        break;
+                }
+            }
+            __m256i fgmask = _mm256_cmpeq_epi8(bg, zero256);
+            __m256i fore = _mm256_loadu_si256((const __m256i *)(fore_num + j));
+            _mm256_storeu_si256((__m256i *)(fg + j), fgmask);
+            _mm256_storeu_si256((__m256i *)(fore_num + j), _mm256_and_si256(_mm256_add_epi8(fore, one256), fgmask));
+        }
+#endif
+
+#if VIBE_SIMD_SSE2
+        const __m128i vthr = _mm_set1_epi8(thr);
+        const __m128i vmin = _mm_set1_epi8(min_matches);
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i zero = _mm_setzero_si128();
+        for(; j <= width - 16; j += 16)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(pix + j));
+            __m128i cnt = zero, bg = zero;
+            for(int k = 0; k < num_samples; k++)
+            {
+                __m128i s = _mm_loadu_si128((const __m128i *)(samples + k * plane_size + j));
+                __m128i d = _mm_or_si128(_mm_subs_epu8(s, p), _mm_subs_epu8(p, s));
+                __m128i m = _mm_cmpeq_epi8(_mm_subs_epu8(d, vthr), zero);
+                cnt = _mm_adds_epu8(cnt, _mm_and_si128(m, one));
+                if(k + 1 >= num_min_matches)
+                {
+                    bg = _mm_cmpeq_epi8(_mm_max_epu8(cnt, vmin), cnt);
+                    if(_mm_movemask_epi8(bg) == 0xFFFF)
+                        break;
+                }
+            }
+            __m128i fgmask = _mm_cmpeq_epi8(bg, zero);
+            __m128i fore = _mm_loadu_si128((const __m128i *)(fore_num + j));
+            _mm_storeu_si128((__m128i *)(fg + j), fgmask);
+            _mm_storeu_si128((__m128i *)(fore_num + j), _mm_and_si128(_mm_add_epi8(fore, one), fgmask));
+        }
+#endif
+    }
+
+    ViBeClassifyRowScalar(pix + j, samples + j, plane_size, width - j,
+                          num_samples, num_min_matches, radius, fg + j, fore_num + j);
+}
+
+/*===================================================================
+ * 类名：ViBeSse2Step / ViBeAvx2Step
+ * 说明：ViBeEngine 在编译期展开的第 K 个样本平面的匹配步骤；
+ *    第 MinMatches 个样本及之后每 4 个样本检查一次，全部像素都已满足 #min 指数时提前结束；
+ *------------------------------------------------------------------
+ * Class: ViBeSse2Step / ViBeAvx2Step
+ *
+ * Summary:
+ *   Matching step of sample plane K, unrolled at compile time for ViBeEngine.
+ *   At sample MinMatches and every 4 samples after it, stop early once every lane has
+ * reached MinMatches.
+=====================================================================
+*/
+#if VIBE_SIMD_SSE2
+template<int K, int NumSamples, int MinMatches>
+struct ViBeSse2Step
+{
+    static inline void Run(const unsigned char *samples, size_t plane_size, __m128i p,
+                           __m128i vthr, __m128i vmin, __m128i one, __m128i &cnt)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i *)(samples + K * plane_size));
+        const __m128i d = _mm_or_si128(_mm_subs_epu8(s, p), _mm_subs_epu8(p, s));
+        const __m128i m = _mm_cmpeq_epi8(_mm_subs_epu8(d, vthr), _mm_setzero_si128());
+        cnt = _mm_adds_epu8(cnt, _mm_and_si128(m, one));
+        if(K + 1 >= MinMatches && (K + 1 - MinMatches) % 4 == 0 && K + 1 < NumSamples)
+        {
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(cnt, vmin), cnt)) == 0xFFFF)
+                return;
+        }
+        ViBeSse2Step<K + 1, NumSamples, MinMatches>::Run(samples, plane_size, p, vthr, vmin, one, cnt);
+    }
+};
+
+template<int NumSamples, int MinMatches>
+struct ViBeSse2Step<NumSamples, NumSamples, MinMatches>
+{
+    static inline void Run(const unsigned char *, size_t, __m128i, __m128i, __m128i, __m128i, __m128i &)
+    {
+    }
+};
+#endif
+
+#if VIBE_SIMD_AVX2
+template<int K, int NumSamples, int MinMatches>
+struct ViBeAvx2Step
+{
+    static inline void Run(const unsigned char *samples, size_t plane_size, __m256i p,
+                           __m256i vthr, __m256i vmin, __m256i one, __m256i &cnt)
+    {
+        const __m256i s = _mm256_loadu_si256((const __m256i *)(samples + K * plane_size));
+        const __m256i d = _mm256_or_si256(_mm256_subs_epu8(s, p), _mm256_subs_epu8(p, s));
+        const __m256i m = _mm256_cmpeq_epi8(_mm256_subs_epu8(d, vthr), _mm256_setzero_si256());
+        cnt = _mm256_adds_epu8(cnt, _mm256_and_si256(m, one));
+        if(K + 1 >= MinMatches && (K + 1 - MinMatches) % 4 == 0 && K + 1 < NumSamples)
+        {
+            if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(cnt, vmin), cnt)) == -1)
+                return;
+        }
+        ViBeAvx2Step<K + 1, NumSamples, MinMatches>::Run(samples, plane_size, p, vthr, vmin, one, cnt);
+    }
+};
+
+template<int NumSamples, int MinMatches>
+struct ViBeAvx2Step<NumSamples, NumSamples, MinMatches>
+{
+    static inline void Run(const unsigned char *, size_t, __m256i, __m256i, __m256i, __m256i, __m256i &)
+    {
+    }
+};
+#endif
+
+/*===================================================================
+ * 函数名：ViBeEngine::ClassifyRow
+ * 说明：编译期特化的分类核函数，输出与 ViBeClassifyRow 逐位一致；
+ *    样本个数与 #min 指数为常量，样本遍历完全展开，匹配个数保存在寄存器中；
+ * 参数：
+ *   参数与 ViBeClassifyRowScalar 相同
+ * 返回值：void
+ *------------------------------------------------------------------
+ * Function: ViBeEngine::ClassifyRow
+ *
+ * Summary:
+ *   Compile-time specialized Classification Kernel, its output is bit-exact with ViBeClassifyRow.
+ *   The Number of Samples and the Match Number are constants, so the sample loop is fully
+ * unrolled and the match counts stay in registers.
+ *
+ * Arguments:
+ *   the same as ViBeClassifyRowScalar
+ *
+ * Returns:
+ *   void
+=====================================================================
+*/
+template<int NumSamples, int MinMatches>
+void ViBeEngine<NumSamples, MinMatches>::ClassifyRow(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                                                     int width, int, int, int radius,
+                                                     unsigned char *fg, unsigned char *fore_num)
+{
+    int j = 0;
+
+    if(radius > 0)
+    {
+        // |sample - pixel| < radius  <=>  |sample - pixel| <= radius - 1
+        const char thr = (char)(radius > 256 ? 255 : radius - 1);
+
+#if VIBE_SIMD_AVX2
+        const __m256i vthr256 = _mm256_set1_epi8(thr);
+        const __m256i vmin256 = _mm256_set1_epi8((char)MinMatches);
+        const __m256i one256 = _mm256_set1_epi8(1);
+        for(; j <= width - 32; j += 32)
+        {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(pix + j));
+            __m256i cnt = _mm256_setzero_si256();
+            ViBeAvx2Step<0, NumSamples, MinMatches>::Run(samples + j, plane_size, p, vthr256, vmin256, one256, cnt);
+            __m256i bg = _mm256_cmpeq_epi8(_mm256_max_epu8(cnt, vmin256), cnt);
+            __m256i fgmask = _mm256_cmpeq_epi8(bg, _mm256_setzero_si256());
+            __m256i fore = _mm256_loadu_si256((const __m256i *)(fore_num + j));
+            _mm256_storeu_si256((__m256i *)(fg + j), fgmask);
+            _mm256_storeu_si256((__m256i *)(fore_num + j), _mm256_and_si256(_mm256_add_epi8(fore, one256), fgmask));
+        }
+#endif
+
+#if VIBE_SIMD_SSE2
+        const __m128i vthr = _mm_set1_epi8(thr);
+        const __m128i vmin = _mm_set1_epi8((char)MinMatches);
+        const __m128i one = _mm_set1_epi8(1);
+        for(; j <= width - 16; j += 16)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(pix + j));
+            __m128i cnt = _mm_setzero_si128();
+            ViBeSse2Step<0, NumSamples, MinMatches>::Run(samples + j, plane_size, p, vthr, vmin, one, cnt);
+            __m128i bg = _mm_cmpeq_epi8(_mm_max_epu8(cnt, vmin), cnt);
+            __m128i fgmask = _mm_cmpeq_epi8(bg, _mm_setzero_si128());
+            __m128i fore = _mm_loadu_si128((const __m128i *)(fore_num + j));
+            _mm_storeu_si128((__m128i *)(fg + j), fgmask);
+            _mm_storeu_si128((__m128i *)(fore_num + j), _mm_and_si128(_mm_add_epi8(fore, one), fgmask));
+        }
+#endif
+    }
+
+    ViBeClassifyRowScalar(pix + j, samples + j, plane_size, width - j,
+                          NumSamples, MinMatches, radius, fg + j, fore_num + j);
+}
+
+// 常用配置的显式实例化
+// Explicit Instantiations of the common configurations
+template class ViBeEngine<20, 2>;
+template class ViBeEngine<16, 2>;
+template class ViBeEngine<8, 1>;
+
+/*===================================================================
+ * 函数名：ViBeSelectClassifyRow
+ * 说明：按样本个数与 #min 指数选择特化的分类核函数；
+ * 参数：
+ *   int num_samples:  每个像素点的样本个数
+ *   int num_min_matches:  #min指数
+ * 返回值：ViBeClassifyRowFunc
+ *   对应的 ViBeEngine 特化，没有对应特化时返回通用版本 ViBeClassifyRow
+ *------------------------------------------------------------------
+ * Function: ViBeSelectClassifyRow
+ *
+ * Summary:
+ *   Select the specialized Classification Kernel by the Number of Samples and the Match Number.
+ *
+ * Arguments:
+ *   int num_samples - Number of pixel's samples
+ *   int num_min_matches - Match Number of make pixel as Background
+ *
+ * Returns:
+ *   ViBeClassifyRowFunc - the matching ViBeEngine specialization, or the generic
+ * ViBeClassifyRow when there is none.
+=====================================================================
+*/
+ViBeClassifyRowFunc ViBeSelectClassifyRow(int num_samples, int num_min_matches)
+{
+    if(num_samples == 20 && num_min_matches == 2)
+        return &ViBeEngine<20, 2>::ClassifyRow;
+    if(num_samples == 16 && num_min_matches == 2)
+        return &ViBeEngine<16, 2>::ClassifyRow;
+    if(num_samples == 8 && num_min_matches == 1)
+        return &ViBeEngine<8, 1>::ClassifyRow;
+    return &ViBeClassifyRow;
+}
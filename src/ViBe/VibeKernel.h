@@ -0,0 +1,88 @@
+/*=================================================================
+ * Vectorized Kernels of ViBe Algorithm.
+ *
+ * Copyright (C) 2017 Chandler Geng. All rights reserved.
+ *
+ *     This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ *     You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 59
+ * Temple Place, Suite 330, Boston, MA 02111-1307 USA
+===================================================================
+*/
+
+#ifndef VIBEKERNEL_H
+#define VIBEKERNEL_H
+
+#include <cstddef>
+
+// 向量化指令集选择：AVX2 每次处理 32 个像素，SSE2 每次处理 16 个像素，否则使用标量代码
+// SIMD Instruction Set: AVX2 handles 32 pixels per instruction, SSE2 handles 16 pixels,
+// otherwise the scalar code is used.
+#if defined(__AVX2__)
+#define VIBE_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIBE_SIMD_SSE2 1
+#endif
+
+// 对一行像素进行前景/背景分类，直接输出前景模型的一行，并无分支地更新前景计数
+// Classify one row of pixels, write the Foreground Model row directly and update the
+// Foreground Counts without branches.
+void ViBeClassifyRow(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                     int width, int num_samples, int num_min_matches, int radius,
+                     unsigned char *fg, unsigned char *fore_num);
+
+// 标量版本，与向量化版本输出逐位一致
+// Scalar Version, its output is bit-exact with the vectorized version.
+void ViBeClassifyRowScalar(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                           int width, int num_samples, int num_min_matches, int radius,
+                           unsigned char *fg, unsigned char *fore_num);
+
+// 分类核函数的函数指针类型
+// Function Pointer Type of the Classification Kernels
+typedef void (*ViBeClassifyRowFunc)(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                                    int width, int num_samples, int num_min_matches, int radius,
+                                    unsigned char *fg, unsigned char *fore_num);
+
+/*===================================================================
+ * 类名：ViBeEngine
+ * 说明：以样本个数与 #min 指数为模板参数的 ViBe 分类引擎；
+ *    样本遍历在编译期完全展开，只在第 MinMatches 个样本及之后每 4 个样本检查一次提前结束；
+ *    已实例化的配置：20/2、16/2、8/1，其他配置由 ViBeSelectClassifyRow 选择通用版本；
+ *------------------------------------------------------------------
+ * Class: ViBeEngine
+ *
+ * Summary:
+ *   ViBe Classification Engine templated on the Number of Samples and the Match Number.
+ *   The sample loop is fully unrolled at compile time, and the early exit is only checked
+ * at sample MinMatches and every 4 samples after it.
+ *   Instantiated configurations: 20/2, 16/2, 8/1; ViBeSelectClassifyRow falls back to the
+ * generic version for other configurations.
+=====================================================================
+*/
+template<int NumSamples, int MinMatches>
+class ViBeEngine
+{
+public:
+    // 对一行像素进行分类，num_samples 与 num_min_matches 须与模板参数相同
+    // Classify one row of pixels, num_samples and num_min_matches must equal the template arguments.
+    static void ClassifyRow(const unsigned char *pix, const unsigned char *samples, size_t plane_size,
+                            int width, int num_samples, int num_min_matches, int radius,
+                            unsigned char *fg, unsigned char *fore_num);
+};
+
+// 按样本个数与 #min 指数选择特化的分类核函数，没有对应特化时返回通用版本 ViBeClassifyRow
+// Select the specialized Classification Kernel by the Number of Samples and the Match Number,
+// returns the generic ViBeClassifyRow when there is no matching specialization.
+ViBeClassifyRowFunc ViBeSelectClassifyRow(int num_samples, int num_min_matches);
+
+#endif // VIBEKERNEL_H
@@ -20,10 +20,12 @@
 */
 
 #include "Vibe.h"
+#include "Common/Morphology.h"
 
 int main(int argc, char* argv[])
 {
-    Mat frame, gray, FGModel;
+    Mat frame, gray, FGModel, FGMask;
+    RectMorphology morphology;
     VideoCapture capture;
     capture = VideoCapture("./Video/Camera Road 01.avi");
     if(!capture.isOpened())
@@ -79,8 +81,9 @@ int main(int argc, char* argv[])
             cout << "Time of Update ViBe Background: " << time << "ms" <<endl<<endl;
 
             FGModel = vibe.getFGModel();
-//			morphologyEx(FGModel, FGModel, MORPH_OPEN, Mat());
-            imshow("FGModel", FGModel);
+            // 3x3 开运算去除孤立噪点，输出到 FGMask，不改动 ViBe 内部的前景模板
+            morphology.open(FGModel, FGMask, Size(3, 3));
+            imshow("FGModel", FGMask);
         }
 
         imshow("input", frame);